@@ -40,10 +40,16 @@ DISTFILES += \
     LICENSE
 
 SOURCES +=  \
+    algorithms/orientation.cpp \
     algorithms/planar_point_location.cpp \
+    algorithms/point_locator.cpp \
+    data_structures/dag_grid.cpp \
+    data_structures/loose_quadtree.cpp \
+    data_structures/mapped_trapezoidalmap.cpp \
+    data_structures/segment_bvh.cpp \
     data_structures/segment_intersection_checker.cpp \
     data_structures/trapezoidalmap_dataset.cpp \
-    drawables/drawable_trapezoid.cpp \
+    data_structures/trapezoidalmap_faces.cpp \
     drawables/drawable_trapezoidalmap.cpp \
     drawables/drawable_trapezoidalmap_dataset.cpp \
     main.cpp \
@@ -54,19 +60,30 @@ FORMS += \
     managers/trapezoidalmapmanager.ui
 
 HEADERS += \
+    algorithms/orientation.h \
     algorithms/planar_point_location.h \
+    algorithms/point_locator.h \
+    data_structures/chunked_array.h \
+    data_structures/chunked_array.tpp \
+    data_structures/concurrent_dag.h \
+    data_structures/concurrent_dag.tpp \
     data_structures/dag.h \
     data_structures/dag.tpp \
+    data_structures/dag_grid.h \
     data_structures/dag_node.h \
     data_structures/dag_node.tpp \
+    data_structures/frozen_dag.h \
+    data_structures/frozen_dag.tpp \
+    data_structures/loose_quadtree.h \
+    data_structures/mapped_trapezoidalmap.h \
+    data_structures/segment_bvh.h \
     data_structures/segment_intersection_checker.h \
     data_structures/trapezoid.h \
     data_structures/trapezoid.tpp \
     data_structures/trapezoidalmap.h \
     data_structures/trapezoidalmap.tpp \
     data_structures/trapezoidalmap_dataset.h \
-    drawables/drawable_trapezoid.h \
-    drawables/drawable_trapezoid.tpp \
+    data_structures/trapezoidalmap_faces.h \
     drawables/drawable_trapezoidalmap.h \
     drawables/drawable_trapezoidalmap.tpp \
     drawables/drawable_trapezoidalmap_dataset.h \
@@ -0,0 +1,118 @@
+#include "orientation.h"
+
+namespace gasprj {
+
+namespace gasprjint {
+
+/* Internal functions declaration */
+
+void twoSum(double a, double b, double &x, double &y);
+void twoProduct(double a, double b, double &x, double &y);
+void split(double a, double &aHi, double &aLo);
+int growExpansion(const double *e, int eLength, double b, double *h);
+
+/**
+ * @brief Splitter of the Dekker product, 2^27 + 1
+ */
+constexpr double SPLITTER = 134217729.0;
+
+/**
+ * @brief Get the exact orientation of the triangle (a, b, c)
+ * @param[in] ax,ay The coordinates of the point a
+ * @param[in] bx,by The coordinates of the point b
+ * @param[in] cx,cy The coordinates of the point c
+ * @return 1 if the triangle is counterclockwise, -1 if it is clockwise, 0 if the points are collinear
+ *
+ * The determinant is expanded in the six products ax*by - ax*cy - cx*by - ay*bx + ay*cx + cy*bx, each one computed
+ * exactly as the sum of two doubles, and the twelve terms are summed exactly in a floating-point expansion (a sum of
+ * non-overlapping doubles of increasing magnitude). The sign of an expansion is the sign of its largest component.
+ */
+int orientationExact(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    const double factors[6][2] = {{ax, by}, {-ax, cy}, {-cx, by}, {-ay, bx}, {ay, cx}, {cy, bx}};
+
+    double expansion[13], grown[13];
+    int length = 0;
+    for (const double (&factor)[2] : factors) {
+        double product, error;
+        twoProduct(factor[0], factor[1], product, error);
+        length = growExpansion(expansion, length, error, grown);
+        length = growExpansion(grown, length, product, expansion);
+    }
+
+    for (int i = length-1; i >= 0; --i) {
+        if (expansion[i] > 0) return 1;
+        if (expansion[i] < 0) return -1;
+    }
+    return 0;
+}
+
+
+
+/* Internal functions implementation */
+
+/**
+ * @brief Sum two doubles exactly
+ * @param[in] a,b The addends
+ * @param[out] x The rounded sum
+ * @param[out] y The rounding error, such that a + b = x + y
+ */
+void twoSum(double a, double b, double &x, double &y)
+{
+    x = a + b;
+    double bVirtual = x - a;
+    double aVirtual = x - bVirtual;
+    y = (a - aVirtual) + (b - bVirtual);
+}
+
+/**
+ * @brief Multiply two doubles exactly
+ * @param[in] a,b The factors
+ * @param[out] x The rounded product
+ * @param[out] y The rounding error, such that a * b = x + y
+ */
+void twoProduct(double a, double b, double &x, double &y)
+{
+    x = a * b;
+    double aHi, aLo, bHi, bLo;
+    split(a, aHi, aLo);
+    split(b, bHi, bLo);
+    y = aLo * bLo - (((x - aHi * bHi) - aLo * bHi) - aHi * bLo);
+}
+
+/**
+ * @brief Split a double in two halves of 26 significant bits
+ * @param[in] a The double
+ * @param[out] aHi,aLo The halves, such that a = aHi + aLo
+ */
+void split(double a, double &aHi, double &aLo)
+{
+    double c = SPLITTER * a;
+    aHi = c - (c - a);
+    aLo = a - aHi;
+}
+
+/**
+ * @brief Add a double to an expansion
+ * @param[in] e The expansion
+ * @param[in] eLength The number of components of the expansion
+ * @param[in] b The double
+ * @param[out] h The resulting expansion, with at most eLength + 1 components (zero components are removed)
+ * @return The number of components of the resulting expansion
+ */
+int growExpansion(const double *e, int eLength, double b, double *h)
+{
+    int hLength = 0;
+    double q = b;
+    for (int i = 0; i < eLength; ++i) {
+        double hComponent;
+        twoSum(q, e[i], q, hComponent);
+        if (hComponent != 0) h[hLength++] = hComponent;
+    }
+    if (q != 0 || hLength == 0) h[hLength++] = q;
+    return hLength;
+}
+
+} // End namespace gasprjint
+
+} // End namespace gasprj
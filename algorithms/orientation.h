@@ -0,0 +1,61 @@
+#ifndef ORIENTATION_H
+#define ORIENTATION_H
+
+#include <cmath>
+
+#include <cg3/geometry/point2.h>
+
+namespace gasprj {
+
+namespace gasprjint {
+
+/**
+ * @brief Relative error bound of the floating-point evaluation of the orientation determinant: (3 + 16u)u, with u the
+ * unit roundoff 2^-53 (Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates")
+ */
+constexpr double ORIENTATION_ERROR_BOUND = (3.0 + 16.0*1.1102230246251565e-16) * 1.1102230246251565e-16;
+
+int orientationExact(double ax, double ay, double bx, double by, double cx, double cy);
+
+} // End namespace gasprjint
+
+/**
+ * @brief Get the orientation of the triangle (a, b, c), exactly evaluated
+ * @param[in] ax,ay The coordinates of the point a
+ * @param[in] bx,by The coordinates of the point b
+ * @param[in] cx,cy The coordinates of the point c
+ * @return 1 if c lies to the left of the line through a and b oriented from a to b (counterclockwise triangle), -1 if
+ * it lies to the right (clockwise triangle), 0 if the three points are collinear
+ *
+ * The determinant is evaluated in floating-point and its sign is returned if its magnitude is larger than the error
+ * bound; otherwise, which happens only for (almost) collinear points, the determinant is evaluated exactly.
+ */
+inline int orientation(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    double detLeft = (ax - cx) * (by - cy);
+    double detRight = (ay - cy) * (bx - cx);
+    double det = detLeft - detRight;
+
+    // The sum of the magnitudes of the products bounds the rounding error, with no branch on their signs
+    double errorBound = gasprjint::ORIENTATION_ERROR_BOUND * (std::fabs(detLeft) + std::fabs(detRight));
+    if (std::fabs(det) > errorBound || errorBound == 0) return (det > 0) - (det < 0);
+
+    return gasprjint::orientationExact(ax, ay, bx, by, cx, cy);
+}
+
+/**
+ * @brief Get the orientation of the triangle (a, b, c), exactly evaluated
+ * @param[in] a The point a
+ * @param[in] b The point b
+ * @param[in] c The point c
+ * @return 1 if c lies to the left of the line through a and b oriented from a to b, -1 if it lies to the right, 0 if
+ * the three points are collinear
+ */
+inline int orientation(const cg3::Point2d &a, const cg3::Point2d &b, const cg3::Point2d &c)
+{
+    return orientation(a.x(), a.y(), b.x(), b.y(), c.x(), c.y());
+}
+
+} // End namespace gasprj
+
+#endif // ORIENTATION_H
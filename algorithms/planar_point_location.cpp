@@ -1,27 +1,152 @@
 #include "planar_point_location.h"
 
 #include<algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include <cg3/geometry/utils2.h>
 
+#include "algorithms/orientation.h"
+
 namespace gasprj {
 
 namespace gasprjint {
 
 /* Internal functions declaration */
 
+void insertSegment(const cg3::Segment2d &segment, TrapezoidalMap &trapMap, DAG &dag,
+                   std::vector<size_t> *idOverwrittenNodes);
 void updateOneCrossedTrapezoid(const cg3::Segment2d &segment, size_t idCrossedTrap, TrapezoidalMap &trapMap, DAG &dag);
 void updateMoreCrossedTrapezoids(const cg3::Segment2d &segment, const std::vector<size_t> &crossedTraps,
                                  TrapezoidalMap &trapMap, DAG &dag);
 void crossedTrapezoids(const cg3::Segment2d &segment, const TrapezoidalMap &trapMap, const DAG &dag,
                        std::vector<size_t> &crossedTraps);
-size_t queryToBuildTrapezoidalMap(const cg3::Segment2d &segment, const TrapezoidalMap trapMap, const DAG &dag);
+size_t queryToBuildTrapezoidalMap(const cg3::Segment2d &segment, const TrapezoidalMap &trapMap, const DAG &dag,
+                                  bool above = false);
+size_t queryTrapezoidalMapFromNode(const cg3::Point2d &point, size_t idStartNode, const TrapezoidalMap &trapMap,
+                                   const DAG &dag);
+void sideTrapezoids(const cg3::Segment2d &segment, size_t idEndpointR, bool above, const TrapezoidalMap &trapMap,
+                    const DAG &dag, std::vector<size_t> &sideTraps);
+void mergeSideTrapezoids(size_t idEndpointL, size_t idEndpointR, const std::vector<size_t> &trapsA,
+                         const std::vector<size_t> &trapsB, TrapezoidalMap &trapMap, DAG &dag);
+size_t addWallTree(size_t first, size_t last, const std::vector<size_t> &idWallPoints,
+                   const std::vector<size_t> &idLeaves, size_t idNode, DAG &dag);
+void removeTrapezoid(size_t idTrapezoid, TrapezoidalMap &trapMap, DAG &dag);
+void liveSegments(const TrapezoidalMap &trapMap, std::vector<bool> &isLive, std::vector<cg3::Segment2d> &segments);
 bool doesOverlapL(const cg3::Segment2d &segment, size_t idTrapezoid, const TrapezoidalMap &trapMap);
 bool doesOverlapR(const cg3::Segment2d &segment, size_t idTrapezoid, const TrapezoidalMap &trapMap);
 bool hasEndpointTL(size_t idTrapezoid, const TrapezoidalMap &trapMap);
 bool hasEndpointBL(size_t idTrapezoid, const TrapezoidalMap &trapMap);
 bool hasEndpointTR(size_t idTrapezoid, const TrapezoidalMap &trapMap);
 bool hasEndpointBR(size_t idTrapezoid, const TrapezoidalMap &trapMap);
+size_t walkAdjacency(const cg3::Point2d &point, size_t idTrapezoidT, size_t idTrapezoidB, const TrapezoidalMap &trapMap);
+int positionWithRespectToSegment(const cg3::Point2d &point, size_t idSegment, const TrapezoidalMapDataset &trapMapData);
+template<class Visitor>
+void walkSegment(const cg3::Segment2d &segment, const TrapezoidalMap &trapMap, const DAG &dag, Visitor &visit);
+bool crossingPoint(const cg3::Segment2d &segment, size_t idSegment, bool upward, const TrapezoidalMapDataset &trapMapData,
+                   cg3::Point2d &crossing);
+size_t queryTrapezoidalMapAcross(const cg3::Point2d &point, size_t idSegment, bool above, const TrapezoidalMap &trapMap,
+                                 const DAG &dag);
+size_t rectanglePredecessor(size_t idTrapezoid, const cg3::BoundingBox2 &rectangle, const TrapezoidalMap &trapMap);
+size_t rectangleWedge(size_t idTrapezoid, const cg3::BoundingBox2 &rectangle, const TrapezoidalMap &trapMap,
+                      const DAG &dag);
+template<class Query>
+void queryTrapezoidalMapBatch(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                              unsigned int nThreads, const Query &query);
+template<class Query>
+void queryTrapezoidalMapRange(const cg3::Point2d *points, size_t first, size_t last, size_t *idTrapezoids,
+                              const Query &query);
+void queryTrapezoidalMapRange(const cg3::Point2d *points, size_t first, size_t last, size_t *idTrapezoids,
+                              const FrozenDAG &dag);
+void classifyInterleavedQueries(const double *px, const double *py, const double *ax, const double *ay,
+                                const double *bx, const double *by,
+                                uint32_t &xLeft, uint32_t &yLeft, uint32_t &yUncertain);
+template<class Query>
+void queryTrapezoidalMapSorted(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                               const cg3::BoundingBox2 *boundingBox, unsigned int nThreads, const Query &query);
+uint64_t hilbertIndex(const cg3::Point2d &point, const cg3::BoundingBox2 &boundingBox);
+
+/**
+ * @brief The trapezoids and the DAG of a vertical slab of the bounding box, built by the parallel builder
+ *
+ * The IDs of the trapezoids (adjacencies) and of the nodes (children and DAG leaves) are local to the slab, the IDs of
+ * the points and of the segments are the ones of the dataset.
+ */
+struct SlabMap {
+    size_t idPointL, idPointR;               // Points of the left and right walls (NO_ID for the bounding box sides)
+    std::vector<cg3::Segment2d> segments;    // Segments crossing the slab
+    std::vector<Trapezoid> trapezoids;       // Trapezoids overlapping the slab, clipped to the walls
+    std::vector<DAG::Node> nodes;            // DAG nodes reached by the points of the slab (the root first)
+    std::vector<size_t> idsWallL, idsWallR;  // Trapezoids with a side on the left and on the right wall
+};
+
+void buildSlabMap(SlabMap &slab, TrapezoidalMapDataset &trapMapData, const cg3::BoundingBox2 &boundingBox,
+                  unsigned int seed);
+size_t addSlabTree(size_t firstSlab, size_t lastSlab, const std::vector<SlabMap> &slabs,
+                   const std::vector<size_t> &idRootNodes, std::vector<DAG::Node> &treeNodes);
+void stitchSlabWall(size_t idWallPoint, const std::vector<size_t> &idsTrapL, const std::vector<size_t> &idsTrapR,
+                    std::vector<Trapezoid> &trapezoids, const TrapezoidalMapDataset &trapMapData,
+                    const cg3::BoundingBox2 &boundingBox);
+void mergeSlabWall(size_t idWallPoint, const std::vector<size_t> &idsTrapL, std::vector<Trapezoid> &trapezoids,
+                   std::vector<size_t> &idsMergedTrap, const TrapezoidalMapDataset &trapMapData);
+int pointSegmentPosition(size_t idPoint, size_t idSegment, const TrapezoidalMapDataset &trapMapData);
+double wallY(size_t idSegment, size_t idWallPoint, double yBoundingBox, const TrapezoidalMapDataset &trapMapData);
+bool hasEndpoint(size_t idSegment, size_t idPoint, const TrapezoidalMapDataset &trapMapData);
+
+/**
+ * @brief Number of DAG nodes reserved for every segment by the bulk builder
+ *
+ * The expected size of the DAG is linear in the number of segments: with a random insertion order every segment adds
+ * less than 8 nodes on average.
+ */
+constexpr size_t RESERVED_NODES_PER_SEGMENT = 8;
+
+/**
+ * @brief Minimum number of query points assigned to a thread by the batch query
+ */
+constexpr size_t MIN_POINTS_PER_THREAD = 4096;
+
+/**
+ * @brief Number of queries advanced in lockstep through the frozen DAG by the batch query (a multiple of 4)
+ */
+constexpr size_t INTERLEAVED_QUERIES = 16;
+
+/**
+ * @brief Minimum number of nodes of a frozen DAG queried in lockstep by the batch query
+ *
+ * The nodes of a smaller DAG stay in the cache, so there is no latency to hide and the single queries are faster.
+ */
+constexpr size_t MIN_INTERLEAVED_NODES = size_t(1) << 17;
+
+/**
+ * @brief Number of steps of the interleaved queries after which the batch query checks if the lanes have converged
+ */
+constexpr size_t CONVERGENCE_WINDOW = 256;
+
+/**
+ * @brief Number of bits of each coordinate of the cells of the Hilbert curve
+ */
+constexpr unsigned int HILBERT_ORDER = 16;
+
+/**
+ * @brief Size under which the first round of the biased randomized insertion order is not sorted
+ */
+constexpr size_t MIN_SORTED_ROUND = 64;
+
+/**
+ * @brief Minimum number of segments assigned to a slab by the parallel builder
+ */
+constexpr size_t MIN_SEGMENTS_PER_SLAB = 4096;
 
 } // End namespace gasprjint
 
@@ -46,20 +171,927 @@ void initTrapezoidalMap(TrapezoidalMap &trapMap, DAG &dag)
     boundingBoxTrap.setIdDagLeaf(0);
     DAG::Node boundingBoxNode = DAG::Node(DAG::Node::Type::Leaf, 0, DAG::Node::NO_ID, DAG::Node::NO_ID);
 
-    trapMap.addTrapezoid(boundingBoxTrap);
-    dag.addNode(boundingBoxNode);
+    trapMap.addTrapezoid(boundingBoxTrap);
+    dag.addNode(boundingBoxNode);
+}
+
+/**
+ * @brief Add a segment to the trapezoidal map and DAG data structures
+ * @param[in] segment The new segment
+ * @param[in,out] trapMap The trapezoidal map data structure
+ * @param[in,out] dag The DAG query data structure
+ *
+ * Perform the incremental step of the trapezoidal map and DAG bulding algorithm, updating these data structures with
+ * the new trapezoids defined by the new segment.
+ */
+void addSegmentToTrapezoidalMap(const cg3::Segment2d &segment, TrapezoidalMap &trapMap, DAG &dag)
+{
+    gasprjint::insertSegment(segment, trapMap, dag, nullptr);
+}
+
+/**
+ * @brief Add a segment to the trapezoidal map and DAG data structures, publishing the new DAG to the concurrent queries
+ * @param[in] segment The new segment
+ * @param[in,out] trapMap The trapezoidal map data structure
+ * @param[in,out] dag The DAG query data structure
+ * @param[in,out] concurrentDag The concurrent copy of the DAG, published at the end of the incremental step
+ *
+ * Same as the incremental step on the DAG alone, then the new nodes and the new versions of the overwritten leaves are
+ * published in the concurrent DAG, while other threads keep querying it. Only one thread can insert the segments.
+ */
+void addSegmentToTrapezoidalMap(const cg3::Segment2d &segment, TrapezoidalMap &trapMap, DAG &dag,
+                                ConcurrentDAG &concurrentDag)
+{
+    std::vector<size_t> idOverwrittenNodes;
+    gasprjint::insertSegment(segment, trapMap, dag, &idOverwrittenNodes);
+    concurrentDag.publish(dag, trapMap, idOverwrittenNodes);
+}
+
+/**
+ * @brief Remove a segment from the trapezoidal map and DAG data structures
+ * @param[in] segment The segment to remove (currently in the trapezoidal map)
+ * @param[in,out] trapMap The trapezoidal map data structure
+ * @param[in,out] dag The DAG query data structure
+ *
+ * Perform the inverse of the incremental step: the trapezoids above and below the segment are merged across it, and
+ * the trapezoids on the other side of the vertical extensions of its endpoints are merged too, if no other segment has
+ * them as endpoints. The merged trapezoids reuse the IDs of the old ones, and the IDs left over are freed by moving the
+ * last trapezoids of the map in their place, so the IDs stay contiguous.
+ *
+ * The leaves of the old trapezoids are turned in place into X-nodes of the points whose vertical extensions cross
+ * them, leading to the leaves of the merged trapezoids: the nodes of the removed segment and of its endpoints are
+ * left in the DAG (they still answer the queries correctly) until compactTrapezoidalMap() rebuilds the data structures.
+ * The segment and its endpoints stay in the dataset too, which has no removal: the new segments still cannot cross
+ * them, and the segment can be added again to the trapezoidal map. Takes time linear in the number of trapezoids
+ * adjacent to the segment, plus a query of the DAG.
+ */
+void removeSegmentFromTrapezoidalMap(const cg3::Segment2d &segment, TrapezoidalMap &trapMap, DAG &dag)
+{
+    // Trapezoidal map dataset (could be const, but the 'find' method is not declared const unfortunately)
+    TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+
+    // Order the segment and its endpoints
+    cg3::Segment2d orderedSegment;
+    if (segment.p1().x() > segment.p2().x()) {
+        orderedSegment = cg3::Segment2d(segment.p2(), segment.p1());
+    }
+    else {
+        orderedSegment = segment;
+    }
+    assert(orderedSegment.p1().x() < orderedSegment.p2().x());
+
+    // Find the IDs of the segment and its endpoints
+    bool found;
+    size_t idSegment = trapMapData.findSegment(orderedSegment, found); assert(found);
+    size_t idEndpointL = trapMapData.findPoint(orderedSegment.p1(), found); assert(found);
+    size_t idEndpointR = trapMapData.findPoint(orderedSegment.p2(), found); assert(found);
+    (void) idSegment;
+
+    // Find the trapezoids above and below the segment, from left to right
+    std::vector<size_t> trapsA, trapsB;
+    gasprjint::sideTrapezoids(orderedSegment, idEndpointR, true, trapMap, dag, trapsA);
+    gasprjint::sideTrapezoids(orderedSegment, idEndpointR, false, trapMap, dag, trapsB);
+    assert(trapMap.getTrapezoid(trapsA.front()).getIdSegmentB() == idSegment);
+    assert(trapMap.getTrapezoid(trapsB.front()).getIdSegmentT() == idSegment);
+
+    // Merge them, updating the DAG
+    gasprjint::mergeSideTrapezoids(idEndpointL, idEndpointR, trapsA, trapsB, trapMap, dag);
+}
+
+/**
+ * @brief Add a set of segments to the trapezoidal map and DAG data structures, in a random order
+ * @param[in] segments The new segments (already in the trapezoidal map dataset)
+ * @param[in,out] trapMap The trapezoidal map data structure
+ * @param[in,out] dag The DAG query data structure
+ * @param[in] seed The seed of the random permutation of the segments
+ * @param[in] spatialSort True to sort the segments of every round of the insertion along a space-filling curve
+ * @return The depth of the DAG after the insertion of all the segments
+ *
+ * The segments are inserted through the incremental step following a random permutation, so the expected construction
+ * time is O(n log n) and the expected query depth is O(log n), whatever the order of the input. The space for the new
+ * trapezoids (at most 3 for every segment) and DAG nodes is reserved before the insertions.
+ *
+ * With the spatial sort, the permutation is a biased randomized insertion order (Amenta, Choi, Rote): the random
+ * permutation is split in rounds of doubling size, and the segments of every round are sorted along the Hilbert curve
+ * of their midpoints. Every round is still a random sample, so the expected bounds hold, while consecutive insertions
+ * visit nearby trapezoids and DAG nodes.
+ */
+size_t buildTrapezoidalMap(const std::vector<cg3::Segment2d> &segments, TrapezoidalMap &trapMap, DAG &dag,
+                           unsigned int seed, bool spatialSort)
+{
+    // Randomly permute the insertion order
+    std::vector<size_t> order(segments.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::mt19937 rng(seed);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    // Sort the rounds along the Hilbert curve: the last round takes half of the segments, the previous one a quarter...
+    if (spatialSort) {
+        std::vector<uint64_t> keys(segments.size());
+        for (size_t i = 0; i < segments.size(); ++i)
+            keys[i] = gasprjint::hilbertIndex((segments[i].p1() + segments[i].p2()) / 2, trapMap.getBoundingBox());
+        for (size_t last = order.size(); last > gasprjint::MIN_SORTED_ROUND; last /= 2) {
+            std::sort(order.begin() + last/2, order.begin() + last,
+                      [&keys](size_t id1, size_t id2) { return keys[id1] < keys[id2]; });
+        }
+    }
+
+    // Reserve the space for the new trapezoids and DAG nodes
+    trapMap.reserve(trapMap.size() + 3*segments.size());
+    dag.reserve(dag.size() + gasprjint::RESERVED_NODES_PER_SEGMENT*segments.size());
+
+    // Perform the incremental steps
+    for (size_t id : order)
+        addSegmentToTrapezoidalMap(segments[id], trapMap, dag);
+
+    return dag.depth();
+}
+
+/**
+ * @brief Rebuild the trapezoidal map and DAG data structures if the DAG has become too deep
+ * @param[in,out] trapMap The trapezoidal map data structure
+ * @param[in,out] dag The DAG query data structure
+ * @param[in] maxDepthFactor The maximum allowed depth of the DAG, as a multiple of log2(n+1), n number of segments
+ * @param[in] seed The seed of the random permutation of the segments, used if the data structures are rebuilt
+ * @return True if the data structures have been rebuilt, false otherwise
+ *
+ * After many incremental steps with an unlucky (or adversarial) order of the segments, the depth of the DAG can exceed
+ * the expected O(log n). In this case all the segments of the trapezoidal map are inserted again from scratch,
+ * following a new random permutation. Computing the depth takes linear time in the size of the DAG, so this check
+ * should not follow every incremental step (e.g. only when the number of segments doubles).
+ *
+ * The rebuild clears the DAG and increments its generation: the IDs of the nodes and of the trapezoids change, so a
+ * DAGGrid must be updated, a FrozenDAG frozen again (see FrozenDAG::isValid()) and a ConcurrentDAG reset, while a
+ * PointLocator forgets its previous query by itself.
+ */
+bool rebuildDegradedTrapezoidalMap(TrapezoidalMap &trapMap, DAG &dag, double maxDepthFactor, unsigned int seed)
+{
+    std::vector<bool> isLiveSegment;
+    std::vector<cg3::Segment2d> segments;
+    gasprjint::liveSegments(trapMap, isLiveSegment, segments);
+
+    // Check the depth of the DAG
+    if (dag.depth() <= maxDepthFactor * std::log2(static_cast<double>(segments.size()+1)))
+        return false;
+
+    // Rebuild the data structures from scratch
+    trapMap.clear();
+    dag.clear();
+    initTrapezoidalMap(trapMap, dag);
+    buildTrapezoidalMap(segments, trapMap, dag, seed, true);
+
+    return true;
+}
+
+/**
+ * @brief Rebuild the trapezoidal map and DAG data structures if too many DAG nodes refer to removed segments
+ * @param[in,out] trapMap The trapezoidal map data structure
+ * @param[in,out] dag The DAG query data structure
+ * @param[in] maxDeadFraction The maximum allowed fraction of retired nodes in the DAG
+ * @param[in] seed The seed of the random permutation of the segments, used if the data structures are rebuilt
+ * @return True if the data structures have been rebuilt, false otherwise
+ *
+ * The removal of a segment leaves in the DAG its Y-nodes and the X-nodes of its endpoints, and turns the leaves of the
+ * merged trapezoids into internal nodes: the queries stay correct, but the DAG grows and deepens with every removal.
+ * The retired nodes are the Y-nodes of the segments no longer in the trapezoidal map, the X-nodes of the points no
+ * longer bounding a trapezoid and the X-nodes with the same child on both sides. When they exceed the given fraction
+ * of the DAG, the segments still in the trapezoidal map are inserted again from scratch, following a new random
+ * permutation. Takes linear time in the size of the data structures, so this check should follow a batch of removals
+ * (e.g. when the number of removed segments reaches a fraction of the remaining ones).
+ *
+ * The rebuild clears the DAG and increments its generation: the IDs of the nodes and of the trapezoids change, so a
+ * DAGGrid must be updated, a FrozenDAG frozen again (see FrozenDAG::isValid()) and a ConcurrentDAG reset, while a
+ * PointLocator forgets its previous query by itself.
+ */
+bool compactTrapezoidalMap(TrapezoidalMap &trapMap, DAG &dag, double maxDeadFraction, unsigned int seed)
+{
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+    std::vector<bool> isLiveSegment;
+    std::vector<cg3::Segment2d> segments;
+    gasprjint::liveSegments(trapMap, isLiveSegment, segments);
+
+    // Points bounding a trapezoid
+    std::vector<bool> isLivePoint(trapMapData.getPoints().size(), false);
+    for (size_t id = 0; id < trapMap.size(); ++id) {
+        const Trapezoid &trap = trapMap.getTrapezoid(id);
+        if (trap.getIdPointL() != Trapezoid::NO_ID) isLivePoint[trap.getIdPointL()] = true;
+        if (trap.getIdPointR() != Trapezoid::NO_ID) isLivePoint[trap.getIdPointR()] = true;
+    }
+
+    // Count the retired nodes
+    size_t nDeadNodes = 0;
+    for (const DAG::Node &node : dag.getNodes()) {
+        switch (node.getType()) {
+            case DAG::Node::Type::XNode:
+                if (!isLivePoint[node.getIdInfo()] || node.getIdNodeL() == node.getIdNodeR()) ++nDeadNodes;
+                break;
+            case DAG::Node::Type::YNode:
+                if (!isLiveSegment[node.getIdInfo()]) ++nDeadNodes;
+                break;
+            case DAG::Node::Type::Leaf:
+                break;
+        }
+    }
+    if (nDeadNodes <= maxDeadFraction * dag.size())
+        return false;
+
+    // Rebuild the data structures from scratch
+    trapMap.clear();
+    dag.clear();
+    initTrapezoidalMap(trapMap, dag);
+    buildTrapezoidalMap(segments, trapMap, dag, seed, true);
+
+    return true;
+}
+
+/**
+ * @brief Build the trapezoidal map and DAG data structures of a set of segments from scratch, on multiple threads
+ * @param[in] segments The segments (already in the trapezoidal map dataset)
+ * @param[out] trapMap The trapezoidal map data structure, cleared before the construction
+ * @param[out] dag The DAG query data structure, cleared before the construction
+ * @param[in] seed The seed of the random permutations of the segments
+ * @param[in] nThreads The maximum number of threads to use (0 to use all the available hardware threads)
+ * @return The depth of the DAG after the construction
+ *
+ * The bounding box is split in vertical slabs by walls through the x-quantiles of the endpoints of the segments, one
+ * slab for every thread. Every thread builds the trapezoidal map and DAG of the segments crossing its slab, through
+ * the randomized incremental construction, and keeps only the trapezoids overlapping the slab, clipped to its walls,
+ * and the DAG nodes reached by the points of the slab. The slabs are then stitched under a balanced tree of X-nodes
+ * of the wall points, and the trapezoids on the two sides of every wall are made adjacent. Away from the wall point,
+ * the wall is not a vertical extension: the two trapezoids split by it are merged, and the DAG leaf of the right one is
+ * replaced by the leaf of the merged trapezoid. The result is the same trapezoidal map built by buildTrapezoidalMap(),
+ * so the incremental steps can follow. Small sets of segments are built by the calling thread with
+ * buildTrapezoidalMap().
+ */
+size_t buildTrapezoidalMapParallel(const std::vector<cg3::Segment2d> &segments, TrapezoidalMap &trapMap, DAG &dag,
+                                   unsigned int seed, unsigned int nThreads)
+{
+    TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+    trapMap.clear();
+    dag.clear();
+
+    // Define the number of slabs
+    if (nThreads == 0) nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t nSlabs = std::min(static_cast<size_t>(nThreads), segments.size() / gasprjint::MIN_SEGMENTS_PER_SLAB);
+
+    // Few segments: no need to start other threads
+    if (nSlabs <= 1) {
+        initTrapezoidalMap(trapMap, dag);
+        return buildTrapezoidalMap(segments, trapMap, dag, seed, true);
+    }
+
+    // Walls through the x-quantiles of the endpoints (the x-coordinates of the points are distinct)
+    std::vector<cg3::Point2d> endpoints;
+    endpoints.reserve(2*segments.size());
+    for (const cg3::Segment2d &segment : segments)
+        endpoints.push_back(segment.p1()), endpoints.push_back(segment.p2());
+    auto compareX = [](const cg3::Point2d &p1, const cg3::Point2d &p2) { return p1.x() < p2.x(); };
+    std::vector<size_t> idWallPoints;
+    std::vector<double> wallXs;
+    for (size_t i = 1, first = 0; i < nSlabs; ++i) {
+        size_t quantile = i*endpoints.size() / nSlabs;
+        std::nth_element(endpoints.begin() + first, endpoints.begin() + quantile, endpoints.end(), compareX);
+        first = quantile;
+        if (!wallXs.empty() && wallXs.back() == endpoints[quantile].x()) continue;
+        bool found;
+        idWallPoints.push_back(trapMapData.findPoint(endpoints[quantile], found)); assert(found);
+        wallXs.push_back(endpoints[quantile].x());
+    }
+    std::vector<cg3::Point2d>().swap(endpoints);
+
+    // Assign the segments to the slabs they cross: the slab of a wall starts at its x-coordinate
+    std::vector<gasprjint::SlabMap> slabs(wallXs.size()+1);
+    for (size_t i = 0; i < slabs.size(); ++i) {
+        slabs[i].idPointL = i > 0 ? idWallPoints[i-1] : Trapezoid::NO_ID;
+        slabs[i].idPointR = i < wallXs.size() ? idWallPoints[i] : Trapezoid::NO_ID;
+    }
+    for (const cg3::Segment2d &segment : segments) {
+        double x1 = std::min(segment.p1().x(), segment.p2().x()), x2 = std::max(segment.p1().x(), segment.p2().x());
+        size_t firstSlab = std::upper_bound(wallXs.begin(), wallXs.end(), x1) - wallXs.begin();
+        size_t lastSlab = std::lower_bound(wallXs.begin(), wallXs.end(), x2) - wallXs.begin();
+        for (size_t i = firstSlab; i <= lastSlab; ++i)
+            slabs[i].segments.push_back(segment);
+    }
+
+    // Build every slab on its own thread, the calling thread takes care of the last one
+    std::mt19937 rng(seed);
+    std::vector<unsigned int> seeds(slabs.size());
+    for (unsigned int &slabSeed : seeds) slabSeed = rng();
+    std::vector<std::thread> threads;
+    threads.reserve(slabs.size()-1);
+    for (size_t i = 0; i < slabs.size()-1; ++i)
+        threads.emplace_back([&slabs, &trapMapData, &trapMap, &seeds, i]() {
+            gasprjint::buildSlabMap(slabs[i], trapMapData, trapMap.getBoundingBox(), seeds[i]);
+        });
+    gasprjint::buildSlabMap(slabs.back(), trapMapData, trapMap.getBoundingBox(), seeds.back());
+    for (std::thread &thread : threads)
+        thread.join();
+
+    // IDs of the first trapezoid and node of every slab, after the tree of X-nodes of the walls
+    std::vector<size_t> idFirstTraps(slabs.size()), idFirstNodes(slabs.size());
+    size_t nTrapezoids = 0, nNodes = slabs.size()-1;
+    for (size_t i = 0; i < slabs.size(); ++i) {
+        idFirstTraps[i] = nTrapezoids, nTrapezoids += slabs[i].trapezoids.size();
+        idFirstNodes[i] = nNodes, nNodes += slabs[i].nodes.size();
+    }
+
+    // Stitch the DAGs of the slabs under the tree of X-nodes
+    std::vector<DAG::Node> nodes;
+    nodes.reserve(nNodes);
+    gasprjint::addSlabTree(0, slabs.size(), slabs, idFirstNodes, nodes);
+    for (size_t i = 0; i < slabs.size(); ++i) {
+        for (DAG::Node node : slabs[i].nodes) {
+            if (node.getType() == DAG::Node::Type::Leaf)
+                node.setIdInfo(node.getIdInfo() + idFirstTraps[i]);
+            else
+                node.setIdNodeL(node.getIdNodeL() + idFirstNodes[i]), node.setIdNodeR(node.getIdNodeR() + idFirstNodes[i]);
+            nodes.push_back(node);
+        }
+        std::vector<DAG::Node>().swap(slabs[i].nodes);
+    }
+
+    // Stitch the trapezoidal maps of the slabs, then make adjacent the trapezoids on the two sides of every wall
+    std::vector<Trapezoid> trapezoids;
+    trapezoids.reserve(nTrapezoids);
+    for (size_t i = 0; i < slabs.size(); ++i) {
+        size_t offset = idFirstTraps[i];
+        auto shift = [offset](size_t id) { return id == Trapezoid::NO_ID ? Trapezoid::NO_ID : id + offset; };
+        for (Trapezoid trap : slabs[i].trapezoids) {
+            trap.setIdAdjacencyTL(shift(trap.getIdAdjacencyTL())), trap.setIdAdjacencyTR(shift(trap.getIdAdjacencyTR()));
+            trap.setIdAdjacencyBL(shift(trap.getIdAdjacencyBL())), trap.setIdAdjacencyBR(shift(trap.getIdAdjacencyBR()));
+            trap.setIdDagLeaf(trap.getIdDagLeaf() + idFirstNodes[i]);
+            trapezoids.push_back(trap);
+        }
+        std::vector<Trapezoid>().swap(slabs[i].trapezoids);
+        for (size_t &id : slabs[i].idsWallL) id += offset;
+        for (size_t &id : slabs[i].idsWallR) id += offset;
+    }
+    for (size_t i = 0; i+1 < slabs.size(); ++i)
+        gasprjint::stitchSlabWall(slabs[i].idPointR, slabs[i].idsWallR, slabs[i+1].idsWallL, trapezoids, trapMapData,
+                                  trapMap.getBoundingBox());
+
+    // Merge the trapezoids split by the walls, from left to right (a merged trapezoid can span several slabs)
+    std::vector<size_t> idsMergedTrap(trapezoids.size(), Trapezoid::NO_ID);
+    for (size_t i = 0; i+1 < slabs.size(); ++i) {
+        for (size_t &id : slabs[i].idsWallR)
+            if (idsMergedTrap[id] != Trapezoid::NO_ID) id = idsMergedTrap[id];
+        gasprjint::mergeSlabWall(slabs[i].idPointR, slabs[i].idsWallR, trapezoids, idsMergedTrap, trapMapData);
+    }
+
+    // New IDs of the trapezoids left by the merges and of the nodes other than their DAG leaves (DAG::Node::NO_ID has
+    // no definition out of the class, so the vector is filled with a copy)
+    const size_t noIdNode = DAG::Node::NO_ID;
+    std::vector<size_t> newIdsTrap(trapezoids.size(), Trapezoid::NO_ID), newIdsNode(nodes.size(), noIdNode);
+    nTrapezoids = nNodes = 0;
+    for (size_t id = 0; id < trapezoids.size(); ++id)
+        if (idsMergedTrap[id] == Trapezoid::NO_ID) newIdsTrap[id] = nTrapezoids++;
+    for (size_t id = 0; id < nodes.size(); ++id)
+        if (nodes[id].getType() != DAG::Node::Type::Leaf || newIdsTrap[nodes[id].getIdInfo()] != Trapezoid::NO_ID)
+            newIdsNode[id] = nNodes++;
+    for (size_t id = 0; id < trapezoids.size(); ++id)
+        if (idsMergedTrap[id] != Trapezoid::NO_ID)
+            newIdsNode[trapezoids[id].getIdDagLeaf()] = newIdsNode[trapezoids[idsMergedTrap[id]].getIdDagLeaf()];
+
+    // Move the nodes and the trapezoids to the DAG and to the trapezoidal map
+    auto newIdTrap = [&newIdsTrap](size_t id) { return id != Trapezoid::NO_ID ? newIdsTrap[id] : Trapezoid::NO_ID; };
+    dag.reserve(nNodes);
+    for (size_t id = 0; id < nodes.size(); ++id) {
+        DAG::Node &node = nodes[id];
+        if (node.getType() == DAG::Node::Type::Leaf) {
+            if (newIdsTrap[node.getIdInfo()] == Trapezoid::NO_ID) continue;
+            node.setIdInfo(newIdsTrap[node.getIdInfo()]);
+        }
+        else {
+            node.setIdNodeL(newIdsNode[node.getIdNodeL()]), node.setIdNodeR(newIdsNode[node.getIdNodeR()]);
+        }
+        dag.addNode(node);
+    }
+    std::vector<DAG::Node>().swap(nodes);
+    trapMap.reserve(nTrapezoids);
+    for (size_t id = 0; id < trapezoids.size(); ++id) {
+        if (newIdsTrap[id] == Trapezoid::NO_ID) continue;
+        Trapezoid &trap = trapezoids[id];
+        trap.setIdAdjacencyTL(newIdTrap(trap.getIdAdjacencyTL())), trap.setIdAdjacencyTR(newIdTrap(trap.getIdAdjacencyTR()));
+        trap.setIdAdjacencyBL(newIdTrap(trap.getIdAdjacencyBL())), trap.setIdAdjacencyBR(newIdTrap(trap.getIdAdjacencyBR()));
+        trap.setIdDagLeaf(newIdsNode[trap.getIdDagLeaf()]);
+        trapMap.addTrapezoid(trap);
+    }
+
+    return dag.depth();
+}
+
+/* Query */
+
+/**
+ * @brief Find the trapezoid containing the query point using the DAG: performs the query point location
+ * @param[in] point The query point
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @return The ID of the trapezoid containing the query point
+ */
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const TrapezoidalMap &trapMap, const DAG &dag)
+{
+    return gasprjint::queryTrapezoidalMapFromNode(point, 0, trapMap, dag);
+}
+
+/**
+ * @brief Find the trapezoids containing a batch of query points, spreading the queries over multiple threads
+ * @param[in] points The array of query points
+ * @param[in] nPoints The number of query points
+ * @param[out] idTrapezoids An array of (at least) nPoints elements, filled with the IDs of the trapezoids containing
+ * the corresponding query points
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[in] nThreads The maximum number of threads to use (0 to use all the available hardware threads)
+ * @param[in] spatialSort True to answer the queries in the order of the Hilbert curve, so that consecutive queries
+ * share the nodes of the DAG in the cache
+ */
+void queryTrapezoidalMap(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                         const TrapezoidalMap &trapMap, const DAG &dag, unsigned int nThreads, bool spatialSort)
+{
+    auto query = [&trapMap, &dag](const cg3::Point2d &point) { return queryTrapezoidalMap(point, trapMap, dag); };
+    if (spatialSort)
+        gasprjint::queryTrapezoidalMapSorted(points, nPoints, idTrapezoids, &trapMap.getBoundingBox(), nThreads, query);
+    else
+        gasprjint::queryTrapezoidalMapBatch(points, nPoints, idTrapezoids, nThreads, query);
+}
+
+/**
+ * @brief Find the trapezoid containing the query point using the DAG, starting from the node of the grid index
+ * @param[in] point The query point
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[in] grid The grid index over the DAG
+ * @return The ID of the trapezoid containing the query point
+ *
+ * If the grid is stale (the DAG has been cleared or its nodes renumbered after the last update of the grid), the
+ * query starts from the root.
+ */
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const TrapezoidalMap &trapMap, const DAG &dag,
+                           const DAGGrid &grid)
+{
+    size_t idStartNode = grid.isValid(dag) ? grid.getIdStartNode(point) : 0;
+    return gasprjint::queryTrapezoidalMapFromNode(point, idStartNode, trapMap, dag);
+}
+
+/**
+ * @brief Find the trapezoids containing a batch of query points using the DAG and its grid index, spreading the
+ * queries over multiple threads
+ * @param[in] points The array of query points
+ * @param[in] nPoints The number of query points
+ * @param[out] idTrapezoids An array of (at least) nPoints elements, filled with the IDs of the trapezoids containing
+ * the corresponding query points
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[in] grid The grid index over the DAG
+ * @param[in] nThreads The maximum number of threads to use (0 to use all the available hardware threads)
+ * @param[in] spatialSort True to answer the queries in the order of the Hilbert curve, so that consecutive queries
+ * share the nodes of the DAG in the cache
+ */
+void queryTrapezoidalMap(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                         const TrapezoidalMap &trapMap, const DAG &dag, const DAGGrid &grid, unsigned int nThreads,
+                         bool spatialSort)
+{
+    auto query = [&trapMap, &dag, &grid](const cg3::Point2d &point) {
+        return queryTrapezoidalMap(point, trapMap, dag, grid);
+    };
+    if (spatialSort)
+        gasprjint::queryTrapezoidalMapSorted(points, nPoints, idTrapezoids, &trapMap.getBoundingBox(), nThreads, query);
+    else
+        gasprjint::queryTrapezoidalMapBatch(points, nPoints, idTrapezoids, nThreads, query);
+}
+
+/**
+ * @brief Find the trapezoid containing the query point using a frozen DAG: performs the query point location
+ * @param[in] point The query point
+ * @param[in] dag The frozen DAG query data structure
+ * @return The ID of the trapezoid containing the query point
+ *
+ * Same as the query on the DAG, but every comparison only reads the data stored in the frozen DAG, without accessing
+ * the trapezoidal map dataset.
+ */
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const FrozenDAG &dag)
+{
+    const FrozenDAG::Node *dagNode = &dag.getRoot();
+    // Scroll the DAG until a leaf is reached
+    while(!dagNode->isLeaf()) {
+        // Point-Endpoint comparison
+        if (dagNode->getType() == DAG::Node::Type::XNode) {
+            // Query point to the left of the segment endpoint, or either to the right or in the same vertical
+            // extension of the endpoint (treated as being at the right)
+            dagNode = &dag.getNode(point.x() < dagNode->getX() ? dagNode->getIdNodeL() : dagNode->getIdNodeR());
+        }
+        // Point-Segment comparison
+        else {
+            const FrozenDAG::OrderedSegment &segment = dag.getSegment(dagNode->getIdInfo());
+            assert(segment.p1 != point);
+            // Query point above or below the segment
+            dagNode = &dag.getNode(orientation(segment.p1, segment.p2, point) > 0 ?
+                                   dagNode->getIdNodeL() : dagNode->getIdNodeR());
+        }
+    }
+
+    // Return the index of the trapezoid
+    return dagNode->getIdInfo();
+}
+
+/**
+ * @brief Find the trapezoids containing a batch of query points using a frozen DAG
+ * @param[in] points The array of query points
+ * @param[in] nPoints The number of query points
+ * @param[out] idTrapezoids An array of (at least) nPoints elements, filled with the IDs of the trapezoids containing
+ * the corresponding query points
+ * @param[in] dag The frozen DAG query data structure
+ * @param[in] nThreads The maximum number of threads to use (0 to use all the available hardware threads)
+ * @param[in] spatialSort True to answer the queries in the order of the Hilbert curve, so that consecutive queries
+ * share the nodes of the DAG in the cache
+ *
+ * Every thread advances a group of queries in lockstep through the DAG, hiding the latency of the node loads.
+ */
+void queryTrapezoidalMap(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                         const FrozenDAG &dag, unsigned int nThreads, bool spatialSort)
+{
+    if (spatialSort)
+        gasprjint::queryTrapezoidalMapSorted(points, nPoints, idTrapezoids, nullptr, nThreads, dag);
+    else
+        gasprjint::queryTrapezoidalMapBatch(points, nPoints, idTrapezoids, nThreads, dag);
+}
+
+/**
+ * @brief Find the trapezoid containing the query point using a concurrent DAG, while segments can be inserted
+ * @param[in] point The query point
+ * @param[in] dag The concurrent DAG query data structure
+ * @return The ID of the trapezoid containing the query point, in the version of the DAG walked by the query
+ *
+ * Same as the query on the frozen DAG, reading every node once: the query never waits for the concurrent insertions.
+ */
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const ConcurrentDAG &dag)
+{
+    ConcurrentDAG::Leaf leaf;
+    return queryTrapezoidalMap(point, dag, leaf);
+}
+
+/**
+ * @brief Find the trapezoid containing the query point using a concurrent DAG, while segments can be inserted
+ * @param[in] point The query point
+ * @param[in] dag The concurrent DAG query data structure
+ * @param[out] leaf The copy of the trapezoid containing the query point (segments and points), as published with the
+ * leaf reached by the query
+ * @return The ID of the trapezoid containing the query point, in the version of the DAG walked by the query
+ *
+ * The trapezoid can be reused by a concurrent insertion, so its segments and points are read from the copy.
+ */
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const ConcurrentDAG &dag, ConcurrentDAG::Leaf &leaf)
+{
+    FrozenDAG::Node dagNode = dag.getRoot();
+    // Scroll the DAG until a leaf is reached
+    while(!dagNode.isLeaf()) {
+        // Point-Endpoint comparison
+        if (dagNode.getType() == DAG::Node::Type::XNode) {
+            // Query point to the left of the segment endpoint, or either to the right or in the same vertical
+            // extension of the endpoint (treated as being at the right)
+            dagNode = dag.getNode(point.x() < dagNode.getX() ? dagNode.getIdNodeL() : dagNode.getIdNodeR());
+        }
+        // Point-Segment comparison
+        else {
+            const FrozenDAG::OrderedSegment &segment = dag.getSegment(dagNode.getIdInfo());
+            assert(segment.p1 != point);
+            // Query point above or below the segment
+            dagNode = dag.getNode(orientation(segment.p1, segment.p2, point) > 0 ?
+                                  dagNode.getIdNodeL() : dagNode.getIdNodeR());
+        }
+    }
+
+    // Return the index of the trapezoid
+    leaf = dag.getLeaf(dagNode.getIdInfo());
+    return leaf.idTrapezoid;
+}
+
+/**
+ * @brief Find the trapezoids containing a batch of query points using a concurrent DAG, while segments can be inserted
+ * @param[in] points The array of query points
+ * @param[in] nPoints The number of query points
+ * @param[out] idTrapezoids An array of (at least) nPoints elements, filled with the IDs of the trapezoids containing
+ * the corresponding query points
+ * @param[in] dag The concurrent DAG query data structure
+ * @param[in] nThreads The maximum number of threads to use (0 to use all the available hardware threads)
+ */
+void queryTrapezoidalMap(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                         const ConcurrentDAG &dag, unsigned int nThreads)
+{
+    auto query = [&dag](const cg3::Point2d &point) { return queryTrapezoidalMap(point, dag); };
+    gasprjint::queryTrapezoidalMapBatch(points, nPoints, idTrapezoids, nThreads, query);
+}
+
+/**
+ * @brief Find the trapezoid containing the query point using a memory-mapped trapezoidal map and DAG
+ * @param[in] point The query point
+ * @param[in] mappedMap The memory-mapped trapezoidal map and DAG
+ * @return The ID of the trapezoid containing the query point
+ *
+ * Same as the query on the DAG, reading the nodes, points and segments in place from the mapped file.
+ */
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const MappedTrapezoidalMap &mappedMap)
+{
+    const DAG::Node *dagNode = &mappedMap.getRoot();
+    // Scroll the DAG until a leaf is reached
+    while(dagNode->getType() != DAG::Node::Type::Leaf) {
+        // Point-Endpoint comparison
+        if (dagNode->getType() == DAG::Node::Type::XNode) {
+            // Query point to the left of the segment endpoint, or either to the right or in the same vertical
+            // extension of the endpoint (treated as being at the right)
+            dagNode = &mappedMap.getNode(point.x() < mappedMap.getPoint(dagNode->getIdInfo()).x ?
+                                         dagNode->getIdNodeL() : dagNode->getIdNodeR());
+        }
+        // Point-Segment comparison
+        else {
+            const MappedTrapezoidalMap::Segment &segment = mappedMap.getSegment(dagNode->getIdInfo());
+            const MappedTrapezoidalMap::Point &p1 = mappedMap.getPoint(segment.idPointL);
+            const MappedTrapezoidalMap::Point &p2 = mappedMap.getPoint(segment.idPointR);
+            // Query point above or below the segment
+            dagNode = &mappedMap.getNode(orientation(p1.x, p1.y, p2.x, p2.y, point.x(), point.y()) > 0 ?
+                                         dagNode->getIdNodeL() : dagNode->getIdNodeR());
+        }
+    }
+
+    // Return the index of the trapezoid
+    return dagNode->getIdInfo();
+}
+
+/**
+ * @brief Find the trapezoids containing a batch of query points using a memory-mapped trapezoidal map and DAG
+ * @param[in] points The array of query points
+ * @param[in] nPoints The number of query points
+ * @param[out] idTrapezoids An array of (at least) nPoints elements, filled with the IDs of the trapezoids containing
+ * the corresponding query points
+ * @param[in] mappedMap The memory-mapped trapezoidal map and DAG
+ * @param[in] nThreads The maximum number of threads to use (0 to use all the available hardware threads)
+ * @param[in] spatialSort True to answer the queries in the order of the Hilbert curve, so that consecutive queries
+ * share the nodes of the DAG in the cache
+ */
+void queryTrapezoidalMap(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                         const MappedTrapezoidalMap &mappedMap, unsigned int nThreads, bool spatialSort)
+{
+    auto query = [&mappedMap](const cg3::Point2d &point) { return queryTrapezoidalMap(point, mappedMap); };
+    if (spatialSort)
+        gasprjint::queryTrapezoidalMapSorted(points, nPoints, idTrapezoids, nullptr, nThreads, query);
+    else
+        gasprjint::queryTrapezoidalMapBatch(points, nPoints, idTrapezoids, nThreads, query);
+}
+
+/**
+ * @brief Find the trapezoid containing the query point walking on the trapezoidal map from a hint trapezoid
+ * @param[in] point The query point
+ * @param[in] idTrapezoid The ID of the trapezoid where the walk starts (e.g. the result of the previous query)
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] maxSteps The maximum number of adjacencies crossed by the walk
+ * @return The ID of the trapezoid containing the query point (the same one found by the DAG), or Trapezoid::NO_ID if
+ * it is not reached within maxSteps steps
+ *
+ * The walk checks if the current trapezoid contains the query point and otherwise moves to one of its left or right
+ * adjacent trapezoids: towards the query point if it lies beyond the left or right point, around the nearest endpoint
+ * of the top or bottom segment if it lies above or below them. A trapezoid contains the point under the same
+ * conventions of the DAG queries: a point on the vertical extension of the left point, or on the top segment, is
+ * inside.
+ */
+size_t walkTrapezoidalMap(const cg3::Point2d &point, size_t idTrapezoid, const TrapezoidalMap &trapMap,
+                          unsigned int maxSteps)
+{
+    // Trapezoidal map dataset
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+
+    if (idTrapezoid >= trapMap.size()) return Trapezoid::NO_ID;
+
+    for (unsigned int step = 0; ; ++step) {
+        const Trapezoid &trap = trapMap.getTrapezoid(idTrapezoid);
+        size_t idNext;
+
+        // Query point to the left of the trapezoid
+        if (trap.getIdPointL() != Trapezoid::NO_ID && point.x() < trapMapData.getPoint(trap.getIdPointL()).x()) {
+            idNext = gasprjint::walkAdjacency(point, trap.getIdAdjacencyTL(), trap.getIdAdjacencyBL(), trapMap);
+        }
+        // Query point to the right of the trapezoid (or on the vertical extension of the right point)
+        else if (trap.getIdPointR() != Trapezoid::NO_ID && point.x() >= trapMapData.getPoint(trap.getIdPointR()).x()) {
+            idNext = gasprjint::walkAdjacency(point, trap.getIdAdjacencyTR(), trap.getIdAdjacencyBR(), trapMap);
+        }
+        // Query point above the top segment: go around its nearest endpoint
+        else if (trap.getIdSegmentT() != Trapezoid::NO_ID &&
+                 gasprjint::positionWithRespectToSegment(point, trap.getIdSegmentT(), trapMapData) > 0) {
+            const TrapezoidalMapDataset::IndexedSegment2d &segmentT = trapMapData.getIndexedSegment(trap.getIdSegmentT());
+            double xMin = std::min(trapMapData.getPoint(segmentT.first).x(), trapMapData.getPoint(segmentT.second).x());
+            double xMax = std::max(trapMapData.getPoint(segmentT.first).x(), trapMapData.getPoint(segmentT.second).x());
+            if (point.x() - xMin < xMax - point.x())
+                idNext = trap.getIdAdjacencyTL() != Trapezoid::NO_ID ? trap.getIdAdjacencyTL() : trap.getIdAdjacencyBL();
+            else
+                idNext = trap.getIdAdjacencyTR() != Trapezoid::NO_ID ? trap.getIdAdjacencyTR() : trap.getIdAdjacencyBR();
+        }
+        // Query point below (or on) the bottom segment: go around its nearest endpoint
+        else if (trap.getIdSegmentB() != Trapezoid::NO_ID &&
+                 gasprjint::positionWithRespectToSegment(point, trap.getIdSegmentB(), trapMapData) <= 0) {
+            const TrapezoidalMapDataset::IndexedSegment2d &segmentB = trapMapData.getIndexedSegment(trap.getIdSegmentB());
+            double xMin = std::min(trapMapData.getPoint(segmentB.first).x(), trapMapData.getPoint(segmentB.second).x());
+            double xMax = std::max(trapMapData.getPoint(segmentB.first).x(), trapMapData.getPoint(segmentB.second).x());
+            if (point.x() - xMin < xMax - point.x())
+                idNext = trap.getIdAdjacencyBL() != Trapezoid::NO_ID ? trap.getIdAdjacencyBL() : trap.getIdAdjacencyTL();
+            else
+                idNext = trap.getIdAdjacencyBR() != Trapezoid::NO_ID ? trap.getIdAdjacencyBR() : trap.getIdAdjacencyTR();
+        }
+        // Query point inside the trapezoid
+        else {
+            return idTrapezoid;
+        }
+
+        // Dead end or too long walk
+        if (idNext == Trapezoid::NO_ID || step == maxSteps) return Trapezoid::NO_ID;
+        idTrapezoid = idNext;
+    }
+}
+
+/**
+ * @brief Find the trapezoid containing the query point, walking from a hint trapezoid and falling back to the DAG
+ * @param[in] point The query point
+ * @param[in] idHint The ID of the trapezoid where the walk starts (e.g. the result of the previous query)
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[in] maxSteps The maximum number of adjacencies crossed by the walk before querying the DAG
+ * @return The ID of the trapezoid containing the query point
+ *
+ * For spatially coherent query streams, where consecutive points lie in the same or in a nearby trapezoid, the walk
+ * ends in a constant number of steps instead of the logarithmic depth of the DAG.
+ */
+size_t queryTrapezoidalMap(const cg3::Point2d &point, size_t idHint, const TrapezoidalMap &trapMap, const DAG &dag,
+                           unsigned int maxSteps)
+{
+    size_t idTrapezoid = walkTrapezoidalMap(point, idHint, trapMap, maxSteps);
+    return idTrapezoid != Trapezoid::NO_ID ? idTrapezoid : queryTrapezoidalMap(point, trapMap, dag);
+}
+
+/**
+ * @brief Find the label of the face containing the query point using the DAG
+ * @param[in] point The query point
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[in] faces The faces of the trapezoidal map, built after its last change
+ * @return The label of the face containing the query point, TrapezoidalMapFaces::NO_LABEL if it has not been labelled
+ *
+ * Same time of the query of the trapezoid: the face and its label are read from the trapezoid found.
+ */
+size_t queryTrapezoidalMapLabel(const cg3::Point2d &point, const TrapezoidalMap &trapMap, const DAG &dag,
+                                const TrapezoidalMapFaces &faces)
+{
+    return faces.getTrapezoidLabel(queryTrapezoidalMap(point, trapMap, dag));
+}
+
+/* Range queries */
+
+/**
+ * @brief Find the trapezoids crossed by a query segment, in order from its left endpoint
+ * @param[in] segment The query segment, lying in the bounding box (it can cross the segments of the trapezoidal map)
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[out] idTrapezoids An array of (at least) maxTrapezoids elements, filled with the IDs of the crossed trapezoids
+ * @param[in] maxTrapezoids The maximum number of trapezoids to report
+ * @return The number of trapezoids reported: if it is maxTrapezoids, the segment may cross further trapezoids
+ *
+ * The trapezoid of the left endpoint is found by the DAG, then the walk moves to the right adjacencies through the
+ * vertical extensions and crosses the segments of the map with a DAG query on the other side of the crossing, so the
+ * query takes O(log n + k + c log n) time, with k the reported trapezoids and c the crossed segments. A vertical
+ * segment is walked upwards. No memory is allocated.
+ */
+size_t queryCrossedTrapezoids(const cg3::Segment2d &segment, const TrapezoidalMap &trapMap, const DAG &dag,
+                              size_t *idTrapezoids, size_t maxTrapezoids)
+{
+    size_t nTrapezoids = 0;
+    auto visit = [idTrapezoids, maxTrapezoids, &nTrapezoids](size_t idTrapezoid, size_t idCrossedSegment) {
+        (void) idCrossedSegment;
+        if (nTrapezoids == maxTrapezoids) return false;
+        idTrapezoids[nTrapezoids++] = idTrapezoid;
+        return true;
+    };
+    gasprjint::walkSegment(segment, trapMap, dag, visit);
+    return nTrapezoids;
+}
+
+/**
+ * @brief Find the segments of the trapezoidal map crossed by a query segment, in order from its left endpoint
+ * @param[in] segment The query segment, lying in the bounding box
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[out] idSegments An array of (at least) maxSegments elements, filled with the IDs of the crossed segments
+ * @param[in] maxSegments The maximum number of segments to report
+ * @return The number of segments reported: if it is maxSegments, the query segment may cross further segments
+ *
+ * Same walk of queryCrossedTrapezoids(), reporting the segments crossed to move from a trapezoid to the next one.
+ */
+size_t queryCrossedSegments(const cg3::Segment2d &segment, const TrapezoidalMap &trapMap, const DAG &dag,
+                            size_t *idSegments, size_t maxSegments)
+{
+    size_t nSegments = 0;
+    auto visit = [idSegments, maxSegments, &nSegments](size_t idTrapezoid, size_t idCrossedSegment) {
+        (void) idTrapezoid;
+        if (idCrossedSegment == Trapezoid::NO_ID) return true;
+        if (nSegments == maxSegments) return false;
+        idSegments[nSegments++] = idCrossedSegment;
+        return true;
+    };
+    gasprjint::walkSegment(segment, trapMap, dag, visit);
+    return nSegments;
+}
+
+/**
+ * @brief Find the trapezoids intersecting an axis-aligned rectangle
+ * @param[in] rectangle The query rectangle (clipped to the bounding box)
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[out] idTrapezoids An array of (at least) maxTrapezoids elements, filled with the IDs of the trapezoids
+ * containing some point of the rectangle (under the conventions of the point location)
+ * @param[in] maxTrapezoids The maximum number of trapezoids to report
+ * @return The number of trapezoids reported: if it is maxTrapezoids, the rectangle may intersect further trapezoids
+ *
+ * Every trapezoid is reported once, from the leftmost point of its intersection with the rectangle. If the point lies
+ * on the left side of the rectangle, or where the top (bottom) segment of the trapezoid enters the bottom (top) side,
+ * the trapezoid is found by walking that side of the rectangle as a query segment. Otherwise the point lies on the
+ * left vertical extension of the trapezoid and the trapezoid is reported by its left adjacency containing the point,
+ * or it is the point where both segments of the trapezoid start and the trapezoid is reported by the one above them.
+ * The reported trapezoids are expanded in order, using the output array as the queue, so the query takes
+ * O(log n + k + c log n) time, with k the reported trapezoids and c the segments crossing the rectangle, and no memory
+ * is allocated.
+ */
+size_t queryRectangleTrapezoids(const cg3::BoundingBox2 &rectangle, const TrapezoidalMap &trapMap, const DAG &dag,
+                                size_t *idTrapezoids, size_t maxTrapezoids)
+{
+    const cg3::BoundingBox2 &boundingBox = trapMap.getBoundingBox();
+    double minX = std::max(rectangle.min().x(), boundingBox.min().x());
+    double minY = std::max(rectangle.min().y(), boundingBox.min().y());
+    double maxX = std::min(rectangle.max().x(), boundingBox.max().x());
+    double maxY = std::min(rectangle.max().y(), boundingBox.max().y());
+    if (minX > maxX || minY > maxY) return 0;
+    const cg3::BoundingBox2 clippedRectangle(cg3::Point2d(minX, minY), cg3::Point2d(maxX, maxY));
+
+    size_t nTrapezoids = 0;
+    auto report = [idTrapezoids, maxTrapezoids, &nTrapezoids](size_t idTrapezoid) {
+        if (nTrapezoids == maxTrapezoids) return false;
+        idTrapezoids[nTrapezoids++] = idTrapezoid;
+        return true;
+    };
+
+    // Trapezoids starting on the left side of the rectangle
+    auto visitL = [&report](size_t idTrapezoid, size_t idCrossedSegment) {
+        (void) idCrossedSegment;
+        return report(idTrapezoid);
+    };
+    gasprjint::walkSegment(cg3::Segment2d(cg3::Point2d(minX, minY), cg3::Point2d(minX, maxY)), trapMap, dag, visitL);
+
+    // Trapezoids entered through their top segment along the bottom side, and through their bottom segment along the
+    // top side
+    auto visitB = [&report, &trapMap](size_t idTrapezoid, size_t idCrossedSegment) {
+        if (idCrossedSegment == Trapezoid::NO_ID || idCrossedSegment != trapMap.getTrapezoid(idTrapezoid).getIdSegmentT())
+            return true;
+        return report(idTrapezoid);
+    };
+    if (nTrapezoids < maxTrapezoids)
+        gasprjint::walkSegment(cg3::Segment2d(cg3::Point2d(minX, minY), cg3::Point2d(maxX, minY)), trapMap, dag, visitB);
+    auto visitT = [&report, &trapMap](size_t idTrapezoid, size_t idCrossedSegment) {
+        if (idCrossedSegment == Trapezoid::NO_ID || idCrossedSegment != trapMap.getTrapezoid(idTrapezoid).getIdSegmentB())
+            return true;
+        return report(idTrapezoid);
+    };
+    if (nTrapezoids < maxTrapezoids)
+        gasprjint::walkSegment(cg3::Segment2d(cg3::Point2d(minX, maxY), cg3::Point2d(maxX, maxY)), trapMap, dag, visitT);
+
+    // Expand the reported trapezoids to the right adjacencies and to the trapezoids starting at their left point
+    for (size_t i = 0; i < nTrapezoids; ++i) {
+        const Trapezoid &trap = trapMap.getTrapezoid(idTrapezoids[i]);
+        size_t idTR = trap.getIdAdjacencyTR(), idBR = trap.getIdAdjacencyBR();
+        if (idTR != Trapezoid::NO_ID &&
+                gasprjint::rectanglePredecessor(idTR, clippedRectangle, trapMap) == idTrapezoids[i] && !report(idTR))
+            break;
+        if (idBR != Trapezoid::NO_ID && idBR != idTR &&
+                gasprjint::rectanglePredecessor(idBR, clippedRectangle, trapMap) == idTrapezoids[i] && !report(idBR))
+            break;
+        size_t idWedge = gasprjint::rectangleWedge(idTrapezoids[i], clippedRectangle, trapMap, dag);
+        if (idWedge != Trapezoid::NO_ID && !report(idWedge))
+            break;
+    }
+
+    return nTrapezoids;
 }
 
+
+
+namespace gasprjint {
+
+/* Internal functions implementation */
+
 /**
- * @brief Add a segment to the trapezoidal map and DAG data structures
+ * @brief Perform the incremental step of the trapezoidal map and DAG bulding algorithm
  * @param[in] segment The new segment
  * @param[in,out] trapMap The trapezoidal map data structure
  * @param[in,out] dag The DAG query data structure
- *
- * Perform the incremental step of the trapezoidal map and DAG bulding algorithm, updating these data structures with
- * the new trapezoids defined by the new segment.
+ * @param[out] idOverwrittenNodes If not null, filled with the IDs of the DAG leaves overwritten by the step
  */
-void addSegmentToTrapezoidalMap(const cg3::Segment2d &segment, TrapezoidalMap &trapMap, DAG &dag)
+void insertSegment(const cg3::Segment2d &segment, TrapezoidalMap &trapMap, DAG &dag,
+                   std::vector<size_t> *idOverwrittenNodes)
 {
     // Order the segment and its endpoints
     cg3::Segment2d orderedSegment;
@@ -73,9 +1105,14 @@ void addSegmentToTrapezoidalMap(const cg3::Segment2d &segment, TrapezoidalMap &t
 
     // Find the trapezoids crossed by the new segment
     std::vector<size_t> crossedTraps = std::vector<size_t>();
-    gasprjint::crossedTrapezoids(orderedSegment, trapMap, dag, crossedTraps);
+    crossedTrapezoids(orderedSegment, trapMap, dag, crossedTraps);
     assert(crossedTraps.size() > 0);
 
+    // Their leaves will be overwritten
+    if (idOverwrittenNodes != nullptr)
+        for (size_t idTrap : crossedTraps)
+            idOverwrittenNodes->push_back(trapMap.getTrapezoid(idTrap).getIdDagLeaf());
+
     /*
      * Update the trapezoidal map and the DAG, updating all the crossed trapezoids and their corresponding DAG leaves.
      * Behave differently wheter one or more than one trapezoid has been crossed by the new segment
@@ -83,97 +1120,13 @@ void addSegmentToTrapezoidalMap(const cg3::Segment2d &segment, TrapezoidalMap &t
 
     // New segment lying entirely in one trapezoid
     if (crossedTraps.size() == 1)
-        gasprjint::updateOneCrossedTrapezoid(orderedSegment, crossedTraps[0], trapMap, dag);
+        updateOneCrossedTrapezoid(orderedSegment, crossedTraps[0], trapMap, dag);
 
     // New segment crossing two or more trapezoids
     else
-        gasprjint::updateMoreCrossedTrapezoids(orderedSegment, crossedTraps, trapMap, dag);
-}
-
-/* Query */
-
-/**
- * @brief Find the trapezoid containing the query point using the DAG: performs the query point location
- * @param[in] point The query point
- * @param[in] trapMap The trapezoidal map data structure
- * @param[in] dag The DAG query data structure
- * @return The ID of the trapezoid containing the query point
- */
-size_t queryTrapezoidalMap(const cg3::Point2d &point, const TrapezoidalMap trapMap, const DAG &dag)
-{
-    // Trapezoidal map dataset
-    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
-
-    const DAG::Node *dagNode = &dag.getRoot();
-    // Scroll the DAG until a leaf is reached
-    while(dagNode->getType() != DAG::Node::Type::Leaf) {
-        // Check if the actual node is a X-node (endpoint) or a Y-node (segment)
-        switch(dagNode->getType()) {
-            // Point-Endpoint comparison
-            case DAG::Node::Type::XNode: {
-                const cg3::Point2d &endpoint = trapMapData.getPoint(dagNode->getIdInfo());
-                // Query point to the left of the segment endpoint
-                if (point.x() < endpoint.x()) {
-                    dagNode = &dag.getNode(dagNode->getIdNodeL());
-                }
-                // Query point either to the right or in the same vertical extension of the endpoint:
-                // in both cases we treat it as being at the right (for real or conceptually)
-                else {
-                    dagNode = &dag.getNode(dagNode->getIdNodeR());
-                }
-                break;
-            }
-            // Point-Segment comparison
-            case DAG::Node::Type::YNode: {
-                const cg3::Segment2d &segment = trapMapData.getSegment(dagNode->getIdInfo());
-                cg3::Segment2d orderedSegment;
-                if (segment.p1().x() > segment.p2().x()) orderedSegment = cg3::Segment2d(segment.p2(), segment.p1());
-                else orderedSegment = segment;
-
-                // Query point above the segment
-                if (cg3::isPointAtLeft(orderedSegment, point)) {
-                    assert(orderedSegment.p1() != point);
-                    dagNode = &dag.getNode(dagNode->getIdNodeL());
-                }
-                #ifdef NDEBUG
-                // Query point below the segment
-                else {
-                    assert(orderedSegment.p1() != point);
-                    dagNode = &dag.getNode(dagNode->getIdNodeR());
-                }
-                #else
-                // Query point below the segment
-                else if (cg3::isPointAtRight(orderedSegment, point)) {
-                    assert(orderedSegment.p1() != point);
-                    dagNode = &dag.getNode(dagNode->getIdNodeR());
-                }
-                // Query point lying on the segment
-                else {
-                    assert(false);
-                }
-                #endif
-                break;
-            }
-            default: {
-                // Unreachable: should not reach this with a leaf
-                assert(false);
-            }
-        }
-    }
-
-    // At this point the node must be a leaf
-    assert(dagNode->getType() == DAG::Node::Type::Leaf);
-
-    // Return the index of the trapezoid
-    return dagNode->getIdInfo();
+        updateMoreCrossedTrapezoids(orderedSegment, crossedTraps, trapMap, dag);
 }
 
-
-
-namespace gasprjint {
-
-/* Internal functions implementation */
-
 /**
  * @brief Update the trapezoidal map and DAG data strucures when the new segment crosses one trapezoid
  * @param[in] segment The new segment
@@ -433,7 +1386,7 @@ void updateMoreCrossedTrapezoids(const cg3::Segment2d &segment,  const std::vect
 
     // Check the position of the segment with respect of the right point of the previous trapezoid
     assert(prevTrap.getIdPointR() != Trapezoid::NO_ID);
-    segmentCrossBelow = cg3::isPointAtLeft(segment, trapMapData.getPoint(prevTrap.getIdPointR()));
+    segmentCrossBelow = orientation(segment.p1(), segment.p2(), trapMapData.getPoint(prevTrap.getIdPointR())) > 0;
 
     // Cross all the center trapezoids
     for (size_t i = 1; i < crossedTraps.size()-1; ++i) {
@@ -522,7 +1475,7 @@ void updateMoreCrossedTrapezoids(const cg3::Segment2d &segment,  const std::vect
         prevTrap = crossedTrap;
         // Check the position of the segment with respect to the right point of the previous trapezoid
         assert(prevTrap.getIdPointR() != Trapezoid::NO_ID);
-        segmentCrossBelow = cg3::isPointAtLeft(segment, trapMapData.getPoint(prevTrap.getIdPointR()));
+        segmentCrossBelow = orientation(segment.p1(), segment.p2(), trapMapData.getPoint(prevTrap.getIdPointR())) > 0;
     }
 
 
@@ -667,8 +1620,10 @@ void crossedTrapezoids(const cg3::Segment2d &segment, const TrapezoidalMap &trap
 
     // Search for all the crossed trapezoids and save their IDs in the vector
     while(segment.p2().x() > trapezoidPointR.x()) {
+        int position = orientation(segment.p1(), segment.p2(), trapezoidPointR);
+
         // If the right point of the trapezoid lies above the segment, move to the bottom-right adjacency
-        if (cg3::isPointAtLeft(segment, trapezoidPointR)) {
+        if (position > 0) {
             idTrap = trapMap.getTrapezoid(idTrap).getIdAdjacencyBR();
         }
         #ifdef NDEBUG
@@ -678,7 +1633,7 @@ void crossedTrapezoids(const cg3::Segment2d &segment, const TrapezoidalMap &trap
         }
         #else
         // If the right point of the trapezoid lies below the segment, move to the top-right adjacency
-        else if (cg3::isPointAtRight(segment, trapezoidPointR)) {
+        else if (position < 0) {
             idTrap = trapMap.getTrapezoid(idTrap).getIdAdjacencyTR();
         }
         // Point lies on a segment
@@ -691,37 +1646,431 @@ void crossedTrapezoids(const cg3::Segment2d &segment, const TrapezoidalMap &trap
         idPointR = trapMap.getTrapezoid(idTrap).getIdPointR();
         trapezoidPointR = (idPointR == Trapezoid::NO_ID) ? trapMap.getBoundingBox().max() : trapMapData.getPoint(idPointR);
 
-        // Store the trapezoid
-        crossedTraps.push_back(idTrap);
+        // Store the trapezoid
+        crossedTraps.push_back(idTrap);
+    }
+}
+
+/**
+ * @brief Find the trapezoid containing the left endpoint of the segment
+ * @param[in] segment The query segment
+ * @param[in] dag The DAG query data structure
+ * @param[in] above The side taken at the Y-nodes of the segment itself (when it is, or has been, in the map)
+ * @return The ID of the trapezoid containing the left left endpoint of the segment
+ *
+ * This version of the query function is called by the building functions to find the correct leftmost trapezoid
+ * traversed by the new segment. Comparisons with the new segment (and not just its left endpoint) could be made.
+ */
+size_t queryToBuildTrapezoidalMap(const cg3::Segment2d &segment, const TrapezoidalMap &trapMap, const DAG &dag,
+                                  bool above)
+{
+    assert(segment.p1().x() < segment.p2().x());
+
+    // Trapezoidal map dataset
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+
+    const DAG::Node *dagNode = &dag.getRoot();
+    // Scroll the DAG until a leaf is reached
+    while(dagNode->getType() != DAG::Node::Type::Leaf) {
+        // Check if the actual node is a x-node (endpoint) or a y-node (segment)
+        switch(dagNode->getType()) {
+            // Point-Endpoint comparison
+            case DAG::Node::Type::XNode: {
+                const cg3::Point2d &endpoint = trapMapData.getPoint(dagNode->getIdInfo());
+                // Query point to the left of the segment endpoint
+                if (segment.p1().x() < endpoint.x()) {
+                    dagNode = &dag.getNode(dagNode->getIdNodeL());
+                }
+                // Query point either to the right or in the same vertical extension of the endpoint:
+                // in both cases we treat it as being at the right (for real or conceptually)
+                else {
+                    dagNode = &dag.getNode(dagNode->getIdNodeR());
+                }
+                break;
+            }
+            // Point-Segment comparison
+            case DAG::Node::Type::YNode: {
+                const cg3::Segment2d &nodeSegment = trapMapData.getSegment(dagNode->getIdInfo());
+                cg3::Segment2d nodeOrderedSegment;
+                if (nodeSegment.p1().x() > nodeSegment.p2().x()) nodeOrderedSegment = cg3::Segment2d(nodeSegment.p2(), nodeSegment.p1());
+                else nodeOrderedSegment = nodeSegment;
+                int position = orientation(nodeOrderedSegment.p1(), nodeOrderedSegment.p2(), segment.p1());
+
+                // Query point above the segment
+                if (position > 0) {
+                    assert(nodeOrderedSegment.p1() != segment.p1());
+                    dagNode = &dag.getNode(dagNode->getIdNodeL());
+                }
+                // Query point below the segment
+                else if (position < 0) {
+                    assert(nodeOrderedSegment.p1() != segment.p1());
+                    dagNode = &dag.getNode(dagNode->getIdNodeR());
+                }
+                // Query point lying on the segment: this happens when the query point is also the
+                // left endpoint of the segment. Compare the slopes of the two segments to check
+                // where the query continues
+                else {
+                    assert(nodeOrderedSegment.p1() == segment.p1());
+                    position = orientation(nodeOrderedSegment.p1(), nodeOrderedSegment.p2(), segment.p2());
+                    // New segment slope is larger, continue above
+                    if (position > 0) {
+                        dagNode = &dag.getNode(dagNode->getIdNodeL());
+                    }
+                    // New segment slope is smaller, continue below
+                    else if (position < 0) {
+                        dagNode = &dag.getNode(dagNode->getIdNodeR());
+                    }
+                    // Same segment (overlapping segments are not in the dataset): continue on the requested side
+                    else {
+                        assert(nodeOrderedSegment.p2() == segment.p2());
+                        dagNode = &dag.getNode(above ? dagNode->getIdNodeL() : dagNode->getIdNodeR());
+                    }
+                }
+                break;
+            }
+            default: {
+                // Unreachable: should not reach this with a leaf
+                assert(false);
+            }
+        }
+    }
+
+    // At this point the node must be a leaf
+    assert(dagNode->getType() == DAG::Node::Type::Leaf);
+
+    // Return the index of the trapezoid
+    return dagNode->getIdInfo();
+}
+
+/**
+ * @brief Find the trapezoids lying on one side of a segment of the trapezoidal map
+ * @param[in] segment The segment, with the endpoints ordered by x-coordinate
+ * @param[in] idEndpointR The ID of the right endpoint of the segment
+ * @param[in] above True for the trapezoids above the segment, false for the ones below
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[out] sideTraps An empty vector to contain the IDs of the trapezoids, from left to right
+ *
+ * The trapezoids above the segment have it as bottom segment, and follow each other through the bottom-right
+ * adjacencies (the ones below through the top-right adjacencies) up to the vertical extension of the right endpoint.
+ */
+void sideTrapezoids(const cg3::Segment2d &segment, size_t idEndpointR, bool above, const TrapezoidalMap &trapMap,
+                    const DAG &dag, std::vector<size_t> &sideTraps)
+{
+    assert(sideTraps.size() == 0);
+
+    size_t idTrap = queryToBuildTrapezoidalMap(segment, trapMap, dag, above);
+    sideTraps.push_back(idTrap);
+    while (trapMap.getTrapezoid(idTrap).getIdPointR() != idEndpointR) {
+        idTrap = above ? trapMap.getTrapezoid(idTrap).getIdAdjacencyBR() : trapMap.getTrapezoid(idTrap).getIdAdjacencyTR();
+        assert(idTrap != Trapezoid::NO_ID);
+        sideTraps.push_back(idTrap);
+    }
+}
+
+/**
+ * @brief Merge the trapezoids above and below a removed segment, updating the trapezoidal map and DAG data structures
+ * @param[in] idEndpointL The ID of the left endpoint of the segment
+ * @param[in] idEndpointR The ID of the right endpoint of the segment
+ * @param[in] trapsA The IDs of the trapezoids above the segment, from left to right
+ * @param[in] trapsB The IDs of the trapezoids below the segment, from left to right
+ * @param[in,out] trapMap The trapezoidal map data structure
+ * @param[in,out] dag The DAG query data structure
+ *
+ * The vertical extensions of the points above the segment (the right points of the trapezoids above it) now reach the
+ * bottom segments of the trapezoids below, and the ones of the points below reach the top segments above: merging the
+ * walls of the two sides by x-coordinate gives the new trapezoids, each with the top segment of the trapezoid above and
+ * the bottom segment of the trapezoid below. The adjacencies across a wall are taken from the side the wall comes from
+ * (from both sides for a wall reaching both of them). An endpoint with no other segment
+ * has a single trapezoid on the other side of its vertical extension, merged into the first (or last) new trapezoid.
+ *
+ * Every reference to an old trapezoid is replaced by the first new trapezoid covering it, if the reference comes from
+ * the left, by the last one otherwise.
+ */
+void mergeSideTrapezoids(size_t idEndpointL, size_t idEndpointR, const std::vector<size_t> &trapsA,
+                         const std::vector<size_t> &trapsB, TrapezoidalMap &trapMap, DAG &dag)
+{
+    // Trapezoidal map dataset
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+
+    // Trapezoids on the other side of the vertical extensions of the endpoints, if they are merged
+    const Trapezoid &firstTrapA = trapMap.getTrapezoid(trapsA.front()), &firstTrapB = trapMap.getTrapezoid(trapsB.front());
+    const Trapezoid &lastTrapA = trapMap.getTrapezoid(trapsA.back()), &lastTrapB = trapMap.getTrapezoid(trapsB.back());
+    size_t idTrapL = firstTrapA.getIdAdjacencyTL() == firstTrapB.getIdAdjacencyBL() ?
+                firstTrapA.getIdAdjacencyTL() : Trapezoid::NO_ID;
+    size_t idTrapR = lastTrapA.getIdAdjacencyTR() == lastTrapB.getIdAdjacencyBR() ?
+                lastTrapA.getIdAdjacencyTR() : Trapezoid::NO_ID;
+
+    // Walls between the new trapezoids, and the trapezoids above and below covering each new one
+    std::vector<size_t> idWallPoints, sideA(1, 0), sideB(1, 0);
+    for (size_t i = 0, j = 0; i+1 < trapsA.size() || j+1 < trapsB.size(); ) {
+        size_t idPointA = i+1 < trapsA.size() ? trapMap.getTrapezoid(trapsA[i]).getIdPointR() : Trapezoid::NO_ID;
+        size_t idPointB = j+1 < trapsB.size() ? trapMap.getTrapezoid(trapsB[j]).getIdPointR() : Trapezoid::NO_ID;
+        double xA = idPointA != Trapezoid::NO_ID ?
+                    trapMapData.getPoint(idPointA).x() : std::numeric_limits<double>::infinity();
+        double xB = idPointB != Trapezoid::NO_ID ?
+                    trapMapData.getPoint(idPointB).x() : std::numeric_limits<double>::infinity();
+        idWallPoints.push_back(xA <= xB ? idPointA : idPointB);
+        if (xA <= xB) ++i;
+        if (xB <= xA) ++j;
+        sideA.push_back(i);
+        sideB.push_back(j);
+    }
+    size_t nNewTraps = sideA.size();
+
+    // Old trapezoids, with the first and the last new trapezoid covering each of them
+    std::vector<size_t> idOldTraps;
+    std::unordered_map<size_t, std::pair<size_t, size_t>> newRanges;
+    for (size_t k = 0; k < nNewTraps; ++k) {
+        for (size_t idOldTrap : {trapsA[sideA[k]], trapsB[sideB[k]]}) {
+            std::unordered_map<size_t, std::pair<size_t, size_t>>::iterator it = newRanges.find(idOldTrap);
+            if (it == newRanges.end()) {
+                newRanges.emplace(idOldTrap, std::make_pair(k, k));
+                idOldTraps.push_back(idOldTrap);
+            }
+            else {
+                it->second.second = k;
+            }
+        }
+    }
+    if (idTrapL != Trapezoid::NO_ID) {
+        newRanges.emplace(idTrapL, std::make_pair(size_t(0), size_t(0)));
+        idOldTraps.push_back(idTrapL);
+    }
+    if (idTrapR != Trapezoid::NO_ID) {
+        newRanges.emplace(idTrapR, std::make_pair(nNewTraps-1, nNewTraps-1));
+        idOldTraps.push_back(idTrapR);
+    }
+    assert(idOldTraps.size() > nNewTraps);
+
+    // The new trapezoids take the first IDs of the old ones
+    auto newIdL = [&](size_t id) {
+        std::unordered_map<size_t, std::pair<size_t, size_t>>::const_iterator it = newRanges.find(id);
+        return it != newRanges.end() ? idOldTraps[it->second.second] : id;
+    };
+    auto newIdR = [&](size_t id) {
+        std::unordered_map<size_t, std::pair<size_t, size_t>>::const_iterator it = newRanges.find(id);
+        return it != newRanges.end() ? idOldTraps[it->second.first] : id;
+    };
+
+    // Compute the new trapezoids
+    std::vector<Trapezoid> newTraps;
+    newTraps.reserve(nNewTraps);
+    for (size_t k = 0; k < nNewTraps; ++k) {
+        const Trapezoid &trapA = trapMap.getTrapezoid(trapsA[sideA[k]]);
+        const Trapezoid &trapB = trapMap.getTrapezoid(trapsB[sideB[k]]);
+        bool wallAL = k == 0 || sideA[k] != sideA[k-1], wallBL = k == 0 || sideB[k] != sideB[k-1];
+        bool wallAR = k == nNewTraps-1 || sideA[k] != sideA[k+1], wallBR = k == nNewTraps-1 || sideB[k] != sideB[k+1];
+        const Trapezoid &trapTL = wallAL ? trapA : trapB, &trapBL = wallBL ? trapB : trapA;
+        const Trapezoid &trapTR = wallAR ? trapA : trapB, &trapBR = wallBR ? trapB : trapA;
+        newTraps.push_back(Trapezoid(trapA.getIdSegmentT(), trapB.getIdSegmentB(),
+                                     k > 0 ? idWallPoints[k-1] : idEndpointL,
+                                     k < nNewTraps-1 ? idWallPoints[k] : idEndpointR,
+                                     newIdL(trapTL.getIdAdjacencyTL()), newIdR(trapTR.getIdAdjacencyTR()),
+                                     newIdL(trapBL.getIdAdjacencyBL()), newIdR(trapBR.getIdAdjacencyBR()),
+                                     DAG::Node::NO_ID));
+    }
+
+    // Merge the trapezoids on the other side of the endpoints with no other segment
+    if (idTrapL != Trapezoid::NO_ID) {
+        const Trapezoid &trapL = trapMap.getTrapezoid(idTrapL);
+        assert(trapL.getIdSegmentT() == newTraps.front().getIdSegmentT());
+        assert(trapL.getIdSegmentB() == newTraps.front().getIdSegmentB());
+        newTraps.front().setIdPointL(trapL.getIdPointL());
+        newTraps.front().setIdAdjacencyTL(newIdL(trapL.getIdAdjacencyTL()));
+        newTraps.front().setIdAdjacencyBL(newIdL(trapL.getIdAdjacencyBL()));
+    }
+    if (idTrapR != Trapezoid::NO_ID) {
+        const Trapezoid &trapR = trapMap.getTrapezoid(idTrapR);
+        assert(trapR.getIdSegmentT() == newTraps.back().getIdSegmentT());
+        assert(trapR.getIdSegmentB() == newTraps.back().getIdSegmentB());
+        newTraps.back().setIdPointR(trapR.getIdPointR());
+        newTraps.back().setIdAdjacencyTR(newIdR(trapR.getIdAdjacencyTR()));
+        newTraps.back().setIdAdjacencyBR(newIdR(trapR.getIdAdjacencyBR()));
+    }
+
+    // Update the references of the adjacent trapezoids
+    std::vector<size_t> idAdjacentTraps, idOldLeaves;
+    for (size_t idOldTrap : idOldTraps) {
+        const Trapezoid &oldTrap = trapMap.getTrapezoid(idOldTrap);
+        idOldLeaves.push_back(oldTrap.getIdDagLeaf());
+        for (size_t idAdjacentTrap : {oldTrap.getIdAdjacencyTL(), oldTrap.getIdAdjacencyTR(),
+                                      oldTrap.getIdAdjacencyBL(), oldTrap.getIdAdjacencyBR()})
+            if (idAdjacentTrap != Trapezoid::NO_ID && newRanges.find(idAdjacentTrap) == newRanges.end())
+                idAdjacentTraps.push_back(idAdjacentTrap);
+    }
+    std::sort(idAdjacentTraps.begin(), idAdjacentTraps.end());
+    idAdjacentTraps.erase(std::unique(idAdjacentTraps.begin(), idAdjacentTraps.end()), idAdjacentTraps.end());
+    for (size_t idAdjacentTrap : idAdjacentTraps) {
+        Trapezoid &adjacentTrap = trapMap.getTrapezoid(idAdjacentTrap);
+        adjacentTrap.setIdAdjacencyTL(newIdL(adjacentTrap.getIdAdjacencyTL()));
+        adjacentTrap.setIdAdjacencyTR(newIdR(adjacentTrap.getIdAdjacencyTR()));
+        adjacentTrap.setIdAdjacencyBL(newIdL(adjacentTrap.getIdAdjacencyBL()));
+        adjacentTrap.setIdAdjacencyBR(newIdR(adjacentTrap.getIdAdjacencyBR()));
+    }
+
+    // Leaves of the new trapezoids: the leaf of an old trapezoid covered by a single new one can be reused
+    const size_t noIdNode = DAG::Node::NO_ID;
+    std::vector<size_t> idNewLeaves(nNewTraps, noIdNode);
+    for (size_t i = 0; i < idOldTraps.size(); ++i) {
+        const std::pair<size_t, size_t> &range = newRanges[idOldTraps[i]];
+        if (range.first == range.second && idNewLeaves[range.first] == DAG::Node::NO_ID)
+            idNewLeaves[range.first] = idOldLeaves[i];
+    }
+    for (size_t k = 0; k < nNewTraps; ++k) {
+        if (idNewLeaves[k] == DAG::Node::NO_ID) {
+            DAG::Node leaf = DAG::Node(DAG::Node::Type::Leaf, idOldTraps[k], DAG::Node::NO_ID, DAG::Node::NO_ID);
+            idNewLeaves[k] = dag.size();
+            dag.addNode(leaf);
+        }
+    }
+
+    // The other leaves of the old trapezoids lead to the new leaves, through the walls crossing them (a leaf covered by
+    // a single new trapezoid becomes an X-node with the same child on both sides)
+    for (size_t i = 0; i < idOldTraps.size(); ++i) {
+        const std::pair<size_t, size_t> &range = newRanges[idOldTraps[i]];
+        if (idOldLeaves[i] == idNewLeaves[range.first]) {
+            DAG::Node leaf = DAG::Node(DAG::Node::Type::Leaf, idOldTraps[range.first], DAG::Node::NO_ID, DAG::Node::NO_ID);
+            dag.overwriteNode(leaf, idOldLeaves[i]);
+        }
+        else if (range.first == range.second) {
+            DAG::Node node = DAG::Node(DAG::Node::Type::XNode, idEndpointL,
+                                       idNewLeaves[range.first], idNewLeaves[range.first]);
+            dag.overwriteNode(node, idOldLeaves[i]);
+        }
+        else {
+            addWallTree(range.first, range.second, idWallPoints, idNewLeaves, idOldLeaves[i], dag);
+        }
+    }
+
+    // Store the new trapezoids
+    for (size_t k = 0; k < nNewTraps; ++k) {
+        newTraps[k].setIdDagLeaf(idNewLeaves[k]);
+        trapMap.overwriteTrapezoid(newTraps[k], idOldTraps[k]);
+    }
+
+    // Free the IDs left over, from the largest one
+    std::vector<size_t> idFreeTraps(idOldTraps.begin() + nNewTraps, idOldTraps.end());
+    std::sort(idFreeTraps.begin(), idFreeTraps.end(), std::greater<size_t>());
+    for (size_t idFreeTrap : idFreeTraps)
+        removeTrapezoid(idFreeTrap, trapMap, dag);
+}
+
+/**
+ * @brief Add a balanced tree of X-nodes separating a sequence of new trapezoids
+ * @param[in] first The first of the new trapezoids
+ * @param[in] last The last of the new trapezoids
+ * @param[in] idWallPoints The points of the walls between the new trapezoids (the k-th one follows the k-th trapezoid)
+ * @param[in] idLeaves The leaves of the new trapezoids
+ * @param[in] idNode The node to overwrite with the root of the tree, DAG::Node::NO_ID to add it
+ * @param[in,out] dag The DAG query data structure
+ * @return The ID of the root of the tree (the leaf of the trapezoid, for a single trapezoid)
+ */
+size_t addWallTree(size_t first, size_t last, const std::vector<size_t> &idWallPoints,
+                   const std::vector<size_t> &idLeaves, size_t idNode, DAG &dag)
+{
+    if (first == last) return idLeaves[first];
+
+    // Reserve the root, then build the two halves
+    size_t middle = (first + last) / 2;
+    DAG::Node node = DAG::Node(DAG::Node::Type::XNode, idWallPoints[middle], DAG::Node::NO_ID, DAG::Node::NO_ID);
+    if (idNode == DAG::Node::NO_ID) {
+        idNode = dag.size();
+        dag.addNode(node);
+    }
+    node.setIdNodeL(addWallTree(first, middle, idWallPoints, idLeaves, DAG::Node::NO_ID, dag));
+    node.setIdNodeR(addWallTree(middle+1, last, idWallPoints, idLeaves, DAG::Node::NO_ID, dag));
+    dag.overwriteNode(node, idNode);
+
+    return idNode;
+}
+
+/**
+ * @brief Remove a trapezoid no longer referenced, moving the last trapezoid of the map in its place
+ * @param[in] idTrapezoid The ID of the trapezoid
+ * @param[in,out] trapMap The trapezoidal map data structure
+ * @param[in,out] dag The DAG query data structure
+ *
+ * The adjacent trapezoids of the moved trapezoid and its leaf are updated with its new ID.
+ */
+void removeTrapezoid(size_t idTrapezoid, TrapezoidalMap &trapMap, DAG &dag)
+{
+    size_t idLast = trapMap.size()-1;
+    if (idTrapezoid != idLast) {
+        const Trapezoid trap = trapMap.getTrapezoid(idLast);
+        trapMap.overwriteTrapezoid(trap, idTrapezoid);
+
+        // Adjacent trapezoids on the left and on the right
+        for (size_t idAdjacentTrap : {trap.getIdAdjacencyTL(), trap.getIdAdjacencyBL()}) {
+            if (idAdjacentTrap == Trapezoid::NO_ID) continue;
+            Trapezoid &adjacentTrap = trapMap.getTrapezoid(idAdjacentTrap);
+            if (adjacentTrap.getIdAdjacencyTR() == idLast) adjacentTrap.setIdAdjacencyTR(idTrapezoid);
+            if (adjacentTrap.getIdAdjacencyBR() == idLast) adjacentTrap.setIdAdjacencyBR(idTrapezoid);
+        }
+        for (size_t idAdjacentTrap : {trap.getIdAdjacencyTR(), trap.getIdAdjacencyBR()}) {
+            if (idAdjacentTrap == Trapezoid::NO_ID) continue;
+            Trapezoid &adjacentTrap = trapMap.getTrapezoid(idAdjacentTrap);
+            if (adjacentTrap.getIdAdjacencyTL() == idLast) adjacentTrap.setIdAdjacencyTL(idTrapezoid);
+            if (adjacentTrap.getIdAdjacencyBL() == idLast) adjacentTrap.setIdAdjacencyBL(idTrapezoid);
+        }
+
+        // Leaf
+        DAG::Node leaf = dag.getNode(trap.getIdDagLeaf());
+        leaf.setIdInfo(idTrapezoid);
+        dag.overwriteNode(leaf, trap.getIdDagLeaf());
+    }
+    trapMap.removeLastTrapezoid();
+}
+
+/**
+ * @brief Find the segments of the dataset still in the trapezoidal map
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[out] isLive For every segment of the dataset, true if it bounds a trapezoid
+ * @param[out] segments The segments bounding a trapezoid, in the order of the dataset
+ *
+ * Every segment in the trapezoidal map is the bottom segment of at least one trapezoid, while the removed ones (and
+ * the ones never added) bound no trapezoid.
+ */
+void liveSegments(const TrapezoidalMap &trapMap, std::vector<bool> &isLive, std::vector<cg3::Segment2d> &segments)
+{
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+
+    isLive.assign(trapMapData.getIndexedSegments().size(), false);
+    for (size_t id = 0; id < trapMap.size(); ++id) {
+        const Trapezoid &trap = trapMap.getTrapezoid(id);
+        if (trap.getIdSegmentT() != Trapezoid::NO_ID) isLive[trap.getIdSegmentT()] = true;
+        if (trap.getIdSegmentB() != Trapezoid::NO_ID) isLive[trap.getIdSegmentB()] = true;
     }
+
+    segments.clear();
+    for (size_t id = 0; id < isLive.size(); ++id)
+        if (isLive[id]) segments.push_back(trapMapData.getSegment(id));
 }
 
 /**
- * @brief Find the trapezoid containing the left endpoint of the segment
- * @param[in] segment The query segment
+ * @brief Find the trapezoid containing the query point, descending the DAG from a given node
+ * @param[in] point The query point
+ * @param[in] idStartNode The ID of the node where the descent starts (the root, or a node reached by the point)
+ * @param[in] trapMap The trapezoidal map data structure
  * @param[in] dag The DAG query data structure
- * @return The ID of the trapezoid containing the left left endpoint of the segment
- *
- * This version of the query function is called by the building functions to find the correct leftmost trapezoid
- * traversed by the new segment. Comparisons with the new segment (and not just its left endpoint) could be made.
+ * @return The ID of the trapezoid containing the query point
  */
-size_t queryToBuildTrapezoidalMap(const cg3::Segment2d &segment, const TrapezoidalMap trapMap, const DAG &dag)
+size_t queryTrapezoidalMapFromNode(const cg3::Point2d &point, size_t idStartNode, const TrapezoidalMap &trapMap,
+                                   const DAG &dag)
 {
-    assert(segment.p1().x() < segment.p2().x());
-
     // Trapezoidal map dataset
     const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
 
-    const DAG::Node *dagNode = &dag.getRoot();
+    const DAG::Node *dagNode = &dag.getNode(idStartNode);
     // Scroll the DAG until a leaf is reached
     while(dagNode->getType() != DAG::Node::Type::Leaf) {
-        // Check if the actual node is a x-node (endpoint) or a y-node (segment)
+        // Check if the actual node is a X-node (endpoint) or a Y-node (segment)
         switch(dagNode->getType()) {
             // Point-Endpoint comparison
             case DAG::Node::Type::XNode: {
                 const cg3::Point2d &endpoint = trapMapData.getPoint(dagNode->getIdInfo());
                 // Query point to the left of the segment endpoint
-                if (segment.p1().x() < endpoint.x()) {
+                if (point.x() < endpoint.x()) {
                     dagNode = &dag.getNode(dagNode->getIdNodeL());
                 }
                 // Query point either to the right or in the same vertical extension of the endpoint:
@@ -733,46 +2082,34 @@ size_t queryToBuildTrapezoidalMap(const cg3::Segment2d &segment, const Trapezoid
             }
             // Point-Segment comparison
             case DAG::Node::Type::YNode: {
-                const cg3::Segment2d &nodeSegment = trapMapData.getSegment(dagNode->getIdInfo());
-                cg3::Segment2d nodeOrderedSegment;
-                if (nodeSegment.p1().x() > nodeSegment.p2().x()) nodeOrderedSegment = cg3::Segment2d(nodeSegment.p2(), nodeSegment.p1());
-                else nodeOrderedSegment = nodeSegment;
+                const cg3::Segment2d &segment = trapMapData.getSegment(dagNode->getIdInfo());
+                cg3::Segment2d orderedSegment;
+                if (segment.p1().x() > segment.p2().x()) orderedSegment = cg3::Segment2d(segment.p2(), segment.p1());
+                else orderedSegment = segment;
+                int position = orientation(orderedSegment.p1(), orderedSegment.p2(), point);
 
                 // Query point above the segment
-                if (cg3::isPointAtLeft(nodeOrderedSegment, segment.p1())) {
-                    assert(nodeOrderedSegment.p1() != segment.p1());
+                if (position > 0) {
+                    assert(orderedSegment.p1() != point);
                     dagNode = &dag.getNode(dagNode->getIdNodeL());
                 }
+                #ifdef NDEBUG
                 // Query point below the segment
-                else if (cg3::isPointAtRight(nodeOrderedSegment, segment.p1())) {
-                    assert(nodeOrderedSegment.p1() != segment.p1());
+                else {
+                    assert(orderedSegment.p1() != point);
                     dagNode = &dag.getNode(dagNode->getIdNodeR());
                 }
-                // Query point lying on the segment: this happens when the query point is also the
-                // left endpoint of the segment. Compare the slopes of the two segments to check
-                // where the query continues
+                #else
+                // Query point below the segment
+                else if (position < 0) {
+                    assert(orderedSegment.p1() != point);
+                    dagNode = &dag.getNode(dagNode->getIdNodeR());
+                }
+                // Query point lying on the segment
                 else {
-                    assert(nodeOrderedSegment.p1() == segment.p1());
-                    // New segment slope is larger, continue above
-                    if (cg3::isPointAtLeft(nodeOrderedSegment, segment.p2())) {
-                        dagNode = &dag.getNode(dagNode->getIdNodeL());
-                    }
-                    #ifdef NDEBUG
-                    // New segment slope is smaller, continue below
-                    else {
-                        dagNode = &dag.getNode(dagNode->getIdNodeR());
-                    }
-                    #else
-                    // New segment slope is smaller, continue below
-                    else if (cg3::isPointAtRight(nodeOrderedSegment, segment.p2())) {
-                        dagNode = &dag.getNode(dagNode->getIdNodeR());
-                    }
-                    else {
-                        // Overlapping segments
-                        assert(false);
-                    }
-                    #endif
+                    assert(false);
                 }
+                #endif
                 break;
             }
             default: {
@@ -789,6 +2126,620 @@ size_t queryToBuildTrapezoidalMap(const cg3::Segment2d &segment, const Trapezoid
     return dagNode->getIdInfo();
 }
 
+/**
+ * @brief Answer a batch of point location queries, spreading them over multiple threads
+ * @param[in] points The array of query points
+ * @param[in] nPoints The number of query points
+ * @param[out] idTrapezoids The array of the IDs of the trapezoids containing the query points
+ * @param[in] nThreads The maximum number of threads to use (0 to use all the available hardware threads)
+ * @param[in] query The single point location query
+ *
+ * The data structures are only read by the query, so the queries are split in contiguous blocks, each one answered by
+ * its own thread without any synchronization. Small batches are answered by fewer threads (or directly by the calling
+ * thread), since starting a thread costs more than a few thousands of queries.
+ */
+template<class Query>
+void queryTrapezoidalMapBatch(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                              unsigned int nThreads, const Query &query)
+{
+    // Define the number of threads to use
+    if (nThreads == 0) nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t nBlocks = std::min(static_cast<size_t>(nThreads), nPoints / MIN_POINTS_PER_THREAD);
+
+    // Small batch: no need to start other threads
+    if (nBlocks <= 1) {
+        queryTrapezoidalMapRange(points, 0, nPoints, idTrapezoids, query);
+        return;
+    }
+
+    // Assign a contiguous block of queries to every thread, the calling thread takes care of the last one
+    std::vector<std::thread> threads;
+    threads.reserve(nBlocks-1);
+    size_t blockSize = nPoints / nBlocks, first = 0;
+    for (size_t i = 0; i < nBlocks-1; ++i, first += blockSize)
+        threads.emplace_back([points, first, blockSize, idTrapezoids, &query]() {
+            queryTrapezoidalMapRange(points, first, first+blockSize, idTrapezoids, query);
+        });
+    queryTrapezoidalMapRange(points, first, nPoints, idTrapezoids, query);
+
+    // Wait for all the blocks to be answered
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+/**
+ * @brief Answer a batch of point location queries in the order of the Hilbert curve
+ * @param[in] points The array of query points
+ * @param[in] nPoints The number of query points
+ * @param[out] idTrapezoids The array of the IDs of the trapezoids containing the query points
+ * @param[in] boundingBox The extent of the curve (nullptr to take the bounding box of the query points)
+ * @param[in] nThreads The maximum number of threads to use (0 to use all the available hardware threads)
+ * @param[in] query The single point location query (or the data structure answering the range queries)
+ *
+ * The query points are sorted by their index along the curve, the sorted batch is answered and the results are
+ * scattered back to the positions of the corresponding points. Consecutive points of the sorted batch are close in
+ * the plane, so their queries visit the same DAG nodes.
+ */
+template<class Query>
+void queryTrapezoidalMapSorted(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                               const cg3::BoundingBox2 *boundingBox, unsigned int nThreads, const Query &query)
+{
+    // Extent of the curve
+    cg3::BoundingBox2 curveBox;
+    if (boundingBox != nullptr) {
+        curveBox = *boundingBox;
+    }
+    else if (nPoints > 0) {
+        curveBox = cg3::BoundingBox2(points[0], points[0]);
+        for (size_t i = 1; i < nPoints; ++i) {
+            curveBox.setMin(cg3::Point2d(std::min(curveBox.min().x(), points[i].x()),
+                                         std::min(curveBox.min().y(), points[i].y())));
+            curveBox.setMax(cg3::Point2d(std::max(curveBox.max().x(), points[i].x()),
+                                         std::max(curveBox.max().y(), points[i].y())));
+        }
+    }
+
+    // Sort the points by their index along the curve
+    std::vector<std::pair<uint64_t, size_t>> keys(nPoints);
+    for (size_t i = 0; i < nPoints; ++i)
+        keys[i] = std::make_pair(hilbertIndex(points[i], curveBox), i);
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<cg3::Point2d> sortedPoints;
+    sortedPoints.reserve(nPoints);
+    for (const std::pair<uint64_t, size_t> &key : keys)
+        sortedPoints.push_back(points[key.second]);
+
+    // Answer the sorted batch and scatter the results
+    std::vector<size_t> sortedIdTrapezoids(nPoints);
+    queryTrapezoidalMapBatch(sortedPoints.data(), nPoints, sortedIdTrapezoids.data(), nThreads, query);
+    for (size_t i = 0; i < nPoints; ++i)
+        idTrapezoids[keys[i].second] = sortedIdTrapezoids[i];
+}
+
+/**
+ * @brief Get the index of a point along the Hilbert curve filling a bounding box
+ * @param[in] point The point (clamped to the bounding box)
+ * @param[in] boundingBox The extent of the curve
+ * @return The index of the cell of the point, in a grid of 2^HILBERT_ORDER cells along each side of the box
+ */
+uint64_t hilbertIndex(const cg3::Point2d &point, const cg3::BoundingBox2 &boundingBox)
+{
+    const uint32_t side = uint32_t(1) << HILBERT_ORDER;
+
+    // Cell of the point
+    double width = boundingBox.max().x() - boundingBox.min().x();
+    double height = boundingBox.max().y() - boundingBox.min().y();
+    double u = width > 0 ? (point.x() - boundingBox.min().x()) / width : 0;
+    double v = height > 0 ? (point.y() - boundingBox.min().y()) / height : 0;
+    uint32_t x = static_cast<uint32_t>(std::min(std::max(u, 0.0), 1.0) * (side-1));
+    uint32_t y = static_cast<uint32_t>(std::min(std::max(v, 0.0), 1.0) * (side-1));
+
+    // Descend the quadrants, rotating the coordinates as the curve does
+    uint64_t index = 0;
+    for (uint32_t s = side/2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) ? 1 : 0, ry = (y & s) ? 1 : 0;
+        index += static_cast<uint64_t>(s) * s * ((3*rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) x = side-1 - x, y = side-1 - y;
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+/**
+ * @brief Find the trapezoids containing a contiguous range of query points
+ * @param[in] points The array of query points
+ * @param[in] first The index of the first query point of the range
+ * @param[in] last The index after the last query point of the range
+ * @param[out] idTrapezoids The array of the IDs of the trapezoids containing the query points
+ * @param[in] query The single point location query
+ */
+template<class Query>
+void queryTrapezoidalMapRange(const cg3::Point2d *points, size_t first, size_t last, size_t *idTrapezoids,
+                              const Query &query)
+{
+    for (size_t i = first; i < last; ++i)
+        idTrapezoids[i] = query(points[i]);
+}
+
+/**
+ * @brief Find the trapezoids containing a contiguous range of query points using a frozen DAG, advancing a group of
+ * queries in lockstep
+ * @param[in] points The array of query points
+ * @param[in] first The index of the first query point of the range
+ * @param[in] last The index after the last query point of the range
+ * @param[out] idTrapezoids The array of the IDs of the trapezoids containing the query points
+ * @param[in] dag The frozen DAG query data structure
+ *
+ * A single query is bound by the latency of the dependent loads of the nodes. Here INTERLEAVED_QUERIES independent
+ * queries (lanes) descend the DAG together: at every step each lane loads the operands of its node, the comparisons of
+ * all the lanes are evaluated together (with SIMD instructions when available) and each lane moves to the next node,
+ * which is prefetched so that the loads of the lanes overlap. A lane reaching a leaf takes the next query point. The
+ * uncertain orientation tests, whose sign is not decided by the floating-point filter, are evaluated exactly one by
+ * one, so the results are the same of the single query.
+ *
+ * The lanes only pay off when the loads miss the cache: a DAG smaller than MIN_INTERLEAVED_NODES is queried one point
+ * at a time. The same happens to the rest of the range when most of the lanes move to the node of the previous lane
+ * (as in a spatially sorted batch, whose consecutive queries follow the same path), since the nodes are already in the
+ * cache for the single queries.
+ */
+void queryTrapezoidalMapRange(const cg3::Point2d *points, size_t first, size_t last, size_t *idTrapezoids,
+                              const FrozenDAG &dag)
+{
+    constexpr size_t N_LANES = INTERLEAVED_QUERIES;
+
+    // Small DAG (a DAG with no segments is a single leaf): single queries
+    if (dag.size() < MIN_INTERLEAVED_NODES) {
+        for (size_t i = first; i < last; ++i)
+            idTrapezoids[i] = queryTrapezoidalMap(points[i], dag);
+        return;
+    }
+
+    // State and operands of the lanes (an inactive lane stays on the root with a dummy point)
+    const FrozenDAG::Node *lanes[N_LANES];
+    size_t idPoint[N_LANES];
+    uint32_t isActive = 0;
+    alignas(32) double px[N_LANES], py[N_LANES], ax[N_LANES], ay[N_LANES], bx[N_LANES], by[N_LANES];
+
+    size_t idNext = first;
+    for (size_t l = 0; l < N_LANES; ++l) {
+        lanes[l] = &dag.getRoot();
+        idPoint[l] = idNext < last ? idNext++ : last;
+        if (idPoint[l] < last) isActive |= uint32_t(1) << l;
+        px[l] = idPoint[l] < last ? points[idPoint[l]].x() : 0;
+        py[l] = idPoint[l] < last ? points[idPoint[l]].y() : 0;
+        ax[l] = ay[l] = bx[l] = by[l] = 0;
+    }
+
+    // Moves of the lanes in the current window, and how many of them reached the node of the previous lane
+    size_t nSteps = 0, nMoves = 0, nSharedMoves = 0;
+
+    while (isActive != 0) {
+        // Load the operands of the node of every lane: the X-nodes only set ax, the other operands are ignored
+        uint32_t isXNode = 0;
+        for (size_t l = 0; l < N_LANES; ++l) {
+            if (lanes[l]->getType() == DAG::Node::Type::XNode) {
+                isXNode |= uint32_t(1) << l;
+                ax[l] = lanes[l]->getX();
+            }
+            else {
+                const FrozenDAG::OrderedSegment &segment = dag.getSegment(lanes[l]->getIdInfo());
+                ax[l] = segment.p1.x(), ay[l] = segment.p1.y(), bx[l] = segment.p2.x(), by[l] = segment.p2.y();
+            }
+        }
+
+        // Evaluate the comparisons of all the lanes, deciding the uncertain orientations exactly
+        uint32_t xLeft, yLeft, yUncertain;
+        classifyInterleavedQueries(px, py, ax, ay, bx, by, xLeft, yLeft, yUncertain);
+        yUncertain &= ~isXNode & isActive;
+        for (size_t l = 0; yUncertain != 0; ++l, yUncertain >>= 1) {
+            if (yUncertain & 1) {
+                bool left = orientation(ax[l], ay[l], bx[l], by[l], px[l], py[l]) > 0;
+                yLeft = (yLeft & ~(uint32_t(1) << l)) | (uint32_t(left) << l);
+            }
+        }
+        uint32_t isLeft = (xLeft & isXNode) | (yLeft & ~isXNode);
+
+        // Move every lane to the next node and prefetch it; a lane reaching a leaf takes the next query point
+        for (size_t l = 0; l < N_LANES; ++l) {
+            if (!((isActive >> l) & 1)) continue;
+
+            lanes[l] = &dag.getNode(((isLeft >> l) & 1) ? lanes[l]->getIdNodeL() : lanes[l]->getIdNodeR());
+            ++nMoves;
+            if (l > 0 && lanes[l] == lanes[l-1]) ++nSharedMoves;
+            if (lanes[l]->isLeaf()) {
+                idTrapezoids[idPoint[l]] = lanes[l]->getIdInfo();
+                lanes[l] = &dag.getRoot();
+                if (idNext < last) {
+                    idPoint[l] = idNext++;
+                    px[l] = points[idPoint[l]].x(), py[l] = points[idPoint[l]].y();
+                }
+                else {
+                    isActive &= ~(uint32_t(1) << l);
+                }
+            }
+            #if defined(__SSE2__)
+            _mm_prefetch(reinterpret_cast<const char *>(lanes[l]), _MM_HINT_T0);
+            #endif
+        }
+
+        // Converged lanes: answer the queries in flight and the rest of the range with single queries
+        if (++nSteps == CONVERGENCE_WINDOW) {
+            if (2*nSharedMoves > nMoves) {
+                for (size_t l = 0; l < N_LANES; ++l)
+                    if ((isActive >> l) & 1)
+                        idTrapezoids[idPoint[l]] = queryTrapezoidalMap(points[idPoint[l]], dag);
+                for (size_t i = idNext; i < last; ++i)
+                    idTrapezoids[i] = queryTrapezoidalMap(points[i], dag);
+                return;
+            }
+            nSteps = nMoves = nSharedMoves = 0;
+        }
+    }
+}
+
+/**
+ * @brief Evaluate the comparisons of the interleaved queries
+ * @param[in] px,py The coordinates of the query points of the lanes
+ * @param[in] ax,ay The coordinates of the left endpoints of the segments of the lanes (ax is the x-coordinate of the
+ * point for the X-nodes)
+ * @param[in] bx,by The coordinates of the right endpoints of the segments of the lanes
+ * @param[out] xLeft The bit mask of the lanes whose query point lies to the left of ax
+ * @param[out] yLeft The bit mask of the lanes whose query point lies above the segment, if certain
+ * @param[out] yUncertain The bit mask of the lanes whose orientation is not decided by the floating-point filter
+ *
+ * The orientation is filtered as in orientation(), with the same operations, so that a certain sign is the exact one.
+ */
+void classifyInterleavedQueries(const double *px, const double *py, const double *ax, const double *ay,
+                                const double *bx, const double *by,
+                                uint32_t &xLeft, uint32_t &yLeft, uint32_t &yUncertain)
+{
+    xLeft = yLeft = yUncertain = 0;
+
+    #if defined(__AVX__)
+    const __m256d errorFactor = _mm256_set1_pd(ORIENTATION_ERROR_BOUND);
+    const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+    const __m256d zero = _mm256_setzero_pd();
+    for (size_t l = 0; l < INTERLEAVED_QUERIES; l += 4) {
+        __m256d vpx = _mm256_load_pd(px + l), vpy = _mm256_load_pd(py + l);
+        __m256d vax = _mm256_load_pd(ax + l), vay = _mm256_load_pd(ay + l);
+        __m256d vbx = _mm256_load_pd(bx + l), vby = _mm256_load_pd(by + l);
+
+        __m256d detLeft = _mm256_mul_pd(_mm256_sub_pd(vax, vpx), _mm256_sub_pd(vby, vpy));
+        __m256d detRight = _mm256_mul_pd(_mm256_sub_pd(vay, vpy), _mm256_sub_pd(vbx, vpx));
+        __m256d det = _mm256_sub_pd(detLeft, detRight);
+        __m256d errorBound = _mm256_mul_pd(errorFactor, _mm256_add_pd(_mm256_and_pd(detLeft, absMask),
+                                                                      _mm256_and_pd(detRight, absMask)));
+
+        xLeft |= static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(vpx, vax, _CMP_LT_OQ))) << l;
+        yLeft |= static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(det, errorBound, _CMP_GT_OQ))) << l;
+        __m256d uncertain = _mm256_and_pd(_mm256_cmp_pd(_mm256_and_pd(det, absMask), errorBound, _CMP_LE_OQ),
+                                          _mm256_cmp_pd(errorBound, zero, _CMP_GT_OQ));
+        yUncertain |= static_cast<uint32_t>(_mm256_movemask_pd(uncertain)) << l;
+    }
+    #elif defined(__SSE2__)
+    const __m128d errorFactor = _mm_set1_pd(ORIENTATION_ERROR_BOUND);
+    const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+    const __m128d zero = _mm_setzero_pd();
+    for (size_t l = 0; l < INTERLEAVED_QUERIES; l += 2) {
+        __m128d vpx = _mm_load_pd(px + l), vpy = _mm_load_pd(py + l);
+        __m128d vax = _mm_load_pd(ax + l), vay = _mm_load_pd(ay + l);
+        __m128d vbx = _mm_load_pd(bx + l), vby = _mm_load_pd(by + l);
+
+        __m128d detLeft = _mm_mul_pd(_mm_sub_pd(vax, vpx), _mm_sub_pd(vby, vpy));
+        __m128d detRight = _mm_mul_pd(_mm_sub_pd(vay, vpy), _mm_sub_pd(vbx, vpx));
+        __m128d det = _mm_sub_pd(detLeft, detRight);
+        __m128d errorBound = _mm_mul_pd(errorFactor, _mm_add_pd(_mm_and_pd(detLeft, absMask),
+                                                                _mm_and_pd(detRight, absMask)));
+
+        xLeft |= static_cast<uint32_t>(_mm_movemask_pd(_mm_cmplt_pd(vpx, vax))) << l;
+        yLeft |= static_cast<uint32_t>(_mm_movemask_pd(_mm_cmpgt_pd(det, errorBound))) << l;
+        __m128d uncertain = _mm_and_pd(_mm_cmple_pd(_mm_and_pd(det, absMask), errorBound),
+                                       _mm_cmpgt_pd(errorBound, zero));
+        yUncertain |= static_cast<uint32_t>(_mm_movemask_pd(uncertain)) << l;
+    }
+    #else
+    for (size_t l = 0; l < INTERLEAVED_QUERIES; ++l) {
+        double detLeft = (ax[l] - px[l]) * (by[l] - py[l]);
+        double detRight = (ay[l] - py[l]) * (bx[l] - px[l]);
+        double det = detLeft - detRight;
+        double errorBound = ORIENTATION_ERROR_BOUND * (std::fabs(detLeft) + std::fabs(detRight));
+
+        xLeft |= static_cast<uint32_t>(px[l] < ax[l]) << l;
+        yLeft |= static_cast<uint32_t>(det > errorBound) << l;
+        yUncertain |= static_cast<uint32_t>(std::fabs(det) <= errorBound && errorBound > 0) << l;
+    }
+    #endif
+}
+
+/**
+ * @brief Build the trapezoidal map and DAG of a slab, for the parallel builder
+ * @param[in,out] slab The slab, with its walls and segments: its trapezoids and nodes are computed
+ * @param[in] trapMapData The trapezoidal map dataset, only read
+ * @param[in] boundingBox The bounding box of the trapezoidal map
+ * @param[in] seed The seed of the random permutation of the segments
+ *
+ * The trapezoidal map of the segments crossing the slab is built over the whole bounding box. The trapezoids overlapping
+ * the slab are kept and clipped to the walls (taking the wall points as left or right points), while their adjacencies
+ * across the walls are left to the stitching. In the DAG, the X-nodes of the points outside the slab send all the
+ * points of the slab to the same side, so they are skipped: the nodes reached from the root are exactly the ones
+ * leading to the kept trapezoids, and they are numbered in breadth-first order.
+ */
+void buildSlabMap(SlabMap &slab, TrapezoidalMapDataset &trapMapData, const cg3::BoundingBox2 &boundingBox,
+                  unsigned int seed)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    double wallXL = slab.idPointL != Trapezoid::NO_ID ? trapMapData.getPoint(slab.idPointL).x() : -inf;
+    double wallXR = slab.idPointR != Trapezoid::NO_ID ? trapMapData.getPoint(slab.idPointR).x() : inf;
+
+    // Trapezoidal map and DAG of the segments crossing the slab
+    TrapezoidalMap trapMap(&trapMapData, boundingBox.min(), boundingBox.max());
+    DAG dag;
+    initTrapezoidalMap(trapMap, dag);
+    buildTrapezoidalMap(slab.segments, trapMap, dag, seed, true);
+    std::vector<cg3::Segment2d>().swap(slab.segments);
+
+    // New IDs of the trapezoids overlapping the slab
+    auto pointX = [&trapMapData](size_t idPoint, double xBoundingBox) {
+        return idPoint != Trapezoid::NO_ID ? trapMapData.getPoint(idPoint).x() : xBoundingBox;
+    };
+    std::vector<size_t> newIdsTrap(trapMap.size(), Trapezoid::NO_ID);
+    size_t nTrapezoids = 0;
+    for (size_t id = 0; id < trapMap.size(); ++id) {
+        const Trapezoid &trap = trapMap.getTrapezoid(id);
+        if (pointX(trap.getIdPointL(), -inf) < wallXR && pointX(trap.getIdPointR(), inf) > wallXL)
+            newIdsTrap[id] = nTrapezoids++;
+    }
+
+    // New IDs of the nodes reached by the points of the slab, skipping the X-nodes of the points outside the slab
+    auto skip = [&](size_t idNode) {
+        const DAG::Node *node = &dag.getNode(idNode);
+        while (node->getType() == DAG::Node::Type::XNode) {
+            double x = trapMapData.getPoint(node->getIdInfo()).x();
+            if (x <= wallXL) idNode = node->getIdNodeR();
+            else if (x >= wallXR) idNode = node->getIdNodeL();
+            else break;
+            node = &dag.getNode(idNode);
+        }
+        return idNode;
+    };
+    const size_t noIdNode = DAG::Node::NO_ID;
+    std::vector<size_t> newIdsNode(dag.size(), noIdNode), order(1, skip(0));
+    newIdsNode[order[0]] = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        const DAG::Node &node = dag.getNode(order[i]);
+        if (node.getType() == DAG::Node::Type::Leaf) continue;
+        for (size_t idChild : {skip(node.getIdNodeL()), skip(node.getIdNodeR())}) {
+            if (newIdsNode[idChild] == DAG::Node::NO_ID)
+                newIdsNode[idChild] = order.size(), order.push_back(idChild);
+        }
+    }
+
+    slab.nodes.reserve(order.size());
+    for (size_t idNode : order) {
+        DAG::Node node = dag.getNode(idNode);
+        if (node.getType() == DAG::Node::Type::Leaf) {
+            assert(newIdsTrap[node.getIdInfo()] != Trapezoid::NO_ID);
+            node.setIdInfo(newIdsTrap[node.getIdInfo()]);
+        }
+        else {
+            node.setIdNodeL(newIdsNode[skip(node.getIdNodeL())]);
+            node.setIdNodeR(newIdsNode[skip(node.getIdNodeR())]);
+        }
+        slab.nodes.push_back(node);
+    }
+
+    // Kept trapezoids, clipped to the walls (the adjacencies across the walls refer to dropped trapezoids)
+    auto newIdTrap = [&newIdsTrap](size_t id) { return id != Trapezoid::NO_ID ? newIdsTrap[id] : Trapezoid::NO_ID; };
+    slab.trapezoids.reserve(nTrapezoids);
+    for (size_t id = 0; id < trapMap.size(); ++id) {
+        if (newIdsTrap[id] == Trapezoid::NO_ID) continue;
+        Trapezoid trap = trapMap.getTrapezoid(id);
+        trap.setIdAdjacencyTL(newIdTrap(trap.getIdAdjacencyTL())), trap.setIdAdjacencyTR(newIdTrap(trap.getIdAdjacencyTR()));
+        trap.setIdAdjacencyBL(newIdTrap(trap.getIdAdjacencyBL())), trap.setIdAdjacencyBR(newIdTrap(trap.getIdAdjacencyBR()));
+        assert(newIdsNode[trap.getIdDagLeaf()] != DAG::Node::NO_ID);
+        trap.setIdDagLeaf(newIdsNode[trap.getIdDagLeaf()]);
+        if (slab.idPointL != Trapezoid::NO_ID && pointX(trap.getIdPointL(), -inf) <= wallXL)
+            trap.setIdPointL(slab.idPointL), slab.idsWallL.push_back(newIdsTrap[id]);
+        if (slab.idPointR != Trapezoid::NO_ID && pointX(trap.getIdPointR(), inf) >= wallXR)
+            trap.setIdPointR(slab.idPointR), slab.idsWallR.push_back(newIdsTrap[id]);
+        slab.trapezoids.push_back(trap);
+    }
+}
+
+/**
+ * @brief Compute the X-nodes of the balanced tree of the walls between a range of slabs, for the parallel builder
+ * @param[in] firstSlab The first slab of the range
+ * @param[in] lastSlab The slab after the last one of the range
+ * @param[in] slabs The slabs
+ * @param[in] idRootNodes The IDs of the roots of the DAGs of the slabs
+ * @param[in,out] treeNodes The X-nodes of the tree, numbered in pre-order from 0
+ * @return The ID of the root of the sub-tree (the root of the DAG of the slab, if the range has one slab)
+ */
+size_t addSlabTree(size_t firstSlab, size_t lastSlab, const std::vector<SlabMap> &slabs,
+                   const std::vector<size_t> &idRootNodes, std::vector<DAG::Node> &treeNodes)
+{
+    if (lastSlab - firstSlab == 1) return idRootNodes[firstSlab];
+
+    size_t idNode = treeNodes.size(), midSlab = (firstSlab + lastSlab) / 2;
+    treeNodes.push_back(DAG::Node(DAG::Node::Type::XNode, slabs[midSlab].idPointL, DAG::Node::NO_ID, DAG::Node::NO_ID));
+    size_t idNodeL = addSlabTree(firstSlab, midSlab, slabs, idRootNodes, treeNodes);
+    size_t idNodeR = addSlabTree(midSlab, lastSlab, slabs, idRootNodes, treeNodes);
+    treeNodes[idNode].setIdNodeL(idNodeL);
+    treeNodes[idNode].setIdNodeR(idNodeR);
+    return idNode;
+}
+
+/**
+ * @brief Set the adjacencies between the trapezoids on the two sides of a wall, for the parallel builder
+ * @param[in] idWallPoint The ID of the point of the wall
+ * @param[in] idsTrapL The IDs of the trapezoids whose right side lies on the wall
+ * @param[in] idsTrapR The IDs of the trapezoids whose left side lies on the wall
+ * @param[in,out] trapezoids The trapezoids of the slabs
+ * @param[in] trapMapData The trapezoidal map dataset
+ * @param[in] boundingBox The bounding box of the trapezoidal map
+ *
+ * The sides on the wall are sorted from the bottom and walked in lockstep: two trapezoids are adjacent if their sides
+ * overlap. The segments crossing the wall are the same on both sides, so the bounds of the sides are computed by the
+ * same expressions and compared exactly. As in the incremental step, a trapezoid has a top and a bottom adjacency
+ * on a side (the same trapezoid if only one), and none at a corner where its segment ends in the wall point.
+ */
+void stitchSlabWall(size_t idWallPoint, const std::vector<size_t> &idsTrapL, const std::vector<size_t> &idsTrapR,
+                    std::vector<Trapezoid> &trapezoids, const TrapezoidalMapDataset &trapMapData,
+                    const cg3::BoundingBox2 &boundingBox)
+{
+    // Sides on the wall, sorted from the bottom (the sides reduced to the wall point have no adjacencies)
+    struct Side {
+        double yB, yT;
+        size_t idTrap;
+        size_t idAdjacencies[2];   // Bottom and top adjacent trapezoids on the other side
+    };
+    auto wallSides = [&](const std::vector<size_t> &idsTrap) {
+        std::vector<Side> sides;
+        sides.reserve(idsTrap.size());
+        for (size_t id : idsTrap) {
+            const Trapezoid &trap = trapezoids[id];
+            double yB = wallY(trap.getIdSegmentB(), idWallPoint, boundingBox.min().y(), trapMapData);
+            double yT = wallY(trap.getIdSegmentT(), idWallPoint, boundingBox.max().y(), trapMapData);
+            if (yB < yT) sides.push_back(Side{yB, yT, id, {Trapezoid::NO_ID, Trapezoid::NO_ID}});
+        }
+        std::sort(sides.begin(), sides.end(), [](const Side &s1, const Side &s2) { return s1.yB < s2.yB; });
+        return sides;
+    };
+    std::vector<Side> sidesL = wallSides(idsTrapL), sidesR = wallSides(idsTrapR);
+
+    // Walk the two sides of the wall from the bottom
+    auto addAdjacency = [](Side &side, size_t id) {
+        assert(side.idAdjacencies[1] == Trapezoid::NO_ID);
+        side.idAdjacencies[side.idAdjacencies[0] == Trapezoid::NO_ID ? 0 : 1] = id;
+    };
+    for (size_t i = 0, j = 0; i < sidesL.size() && j < sidesR.size(); ) {
+        assert(std::min(sidesL[i].yT, sidesR[j].yT) > std::max(sidesL[i].yB, sidesR[j].yB));
+        addAdjacency(sidesL[i], sidesR[j].idTrap);
+        addAdjacency(sidesR[j], sidesL[i].idTrap);
+        double yTL = sidesL[i].yT, yTR = sidesR[j].yT;
+        if (yTL <= yTR) ++i;
+        if (yTR <= yTL) ++j;
+    }
+
+    // Set the adjacencies: both the bottom and the top one are the single adjacent trapezoid, if any
+    for (const Side &side : sidesL) {
+        Trapezoid &trap = trapezoids[side.idTrap];
+        size_t idB = side.idAdjacencies[0];
+        size_t idT = side.idAdjacencies[1] != Trapezoid::NO_ID ? side.idAdjacencies[1] : idB;
+        trap.setIdAdjacencyTR(hasEndpoint(trap.getIdSegmentT(), idWallPoint, trapMapData) ? Trapezoid::NO_ID : idT);
+        trap.setIdAdjacencyBR(hasEndpoint(trap.getIdSegmentB(), idWallPoint, trapMapData) ? Trapezoid::NO_ID : idB);
+    }
+    for (const Side &side : sidesR) {
+        Trapezoid &trap = trapezoids[side.idTrap];
+        size_t idB = side.idAdjacencies[0];
+        size_t idT = side.idAdjacencies[1] != Trapezoid::NO_ID ? side.idAdjacencies[1] : idB;
+        trap.setIdAdjacencyTL(hasEndpoint(trap.getIdSegmentT(), idWallPoint, trapMapData) ? Trapezoid::NO_ID : idT);
+        trap.setIdAdjacencyBL(hasEndpoint(trap.getIdSegmentB(), idWallPoint, trapMapData) ? Trapezoid::NO_ID : idB);
+    }
+}
+
+/**
+ * @brief Merge the trapezoids split by a wall away from its point, for the parallel builder
+ * @param[in] idWallPoint The ID of the point of the wall
+ * @param[in] idsTrapL The IDs of the trapezoids whose right side lies on the wall, after the merges of the walls on
+ * the left
+ * @param[in,out] trapezoids The trapezoids of the slabs, stitched
+ * @param[in,out] idsMergedTrap The ID of the trapezoid every trapezoid has been merged into (NO_ID if none)
+ * @param[in] trapMapData The trapezoidal map dataset
+ *
+ * The vertical extension of the wall point ends at the segments above and below it, so a side on the wall not
+ * containing the wall point separates two trapezoids with the same segments, adjacent only to each other: the right
+ * one is merged into the left one, which takes its right point and its right neighbors.
+ */
+void mergeSlabWall(size_t idWallPoint, const std::vector<size_t> &idsTrapL, std::vector<Trapezoid> &trapezoids,
+                   std::vector<size_t> &idsMergedTrap, const TrapezoidalMapDataset &trapMapData)
+{
+    for (size_t idL : idsTrapL) {
+        Trapezoid &trapL = trapezoids[idL];
+
+        // The sides containing the wall point lie on its vertical extension
+        bool belowTop = trapL.getIdSegmentT() == Trapezoid::NO_ID ||
+                pointSegmentPosition(idWallPoint, trapL.getIdSegmentT(), trapMapData) <= 0;
+        bool aboveBottom = trapL.getIdSegmentB() == Trapezoid::NO_ID ||
+                pointSegmentPosition(idWallPoint, trapL.getIdSegmentB(), trapMapData) >= 0;
+        if (belowTop && aboveBottom) continue;
+
+        size_t idR = trapL.getIdAdjacencyTR();
+        assert(idR != Trapezoid::NO_ID && idR == trapL.getIdAdjacencyBR());
+        const Trapezoid &trapR = trapezoids[idR];
+        assert(trapR.getIdSegmentT() == trapL.getIdSegmentT() && trapR.getIdSegmentB() == trapL.getIdSegmentB());
+        assert(trapR.getIdAdjacencyTL() == idL && trapR.getIdAdjacencyBL() == idL);
+
+        // The right neighbors of the right trapezoid become adjacent to the left one
+        for (size_t idNeighbor : {trapR.getIdAdjacencyTR(), trapR.getIdAdjacencyBR()}) {
+            if (idNeighbor == Trapezoid::NO_ID) continue;
+            Trapezoid &neighbor = trapezoids[idNeighbor];
+            if (neighbor.getIdAdjacencyTL() == idR) neighbor.setIdAdjacencyTL(idL);
+            if (neighbor.getIdAdjacencyBL() == idR) neighbor.setIdAdjacencyBL(idL);
+        }
+        trapL.setIdPointR(trapR.getIdPointR());
+        trapL.setIdAdjacencyTR(trapR.getIdAdjacencyTR());
+        trapL.setIdAdjacencyBR(trapR.getIdAdjacencyBR());
+        idsMergedTrap[idR] = idL;
+    }
+}
+
+/**
+ * @brief Get the position of a point of the trapezoidal map with respect to a segment crossing its vertical line
+ * @param[in] idPoint The ID of the point
+ * @param[in] idSegment The ID of the segment
+ * @param[in] trapMapData The trapezoidal map dataset
+ * @return 1 if the point lies above the segment, -1 if it lies below, 0 if it is an endpoint of the segment
+ */
+int pointSegmentPosition(size_t idPoint, size_t idSegment, const TrapezoidalMapDataset &trapMapData)
+{
+    if (hasEndpoint(idSegment, idPoint, trapMapData)) return 0;
+
+    const TrapezoidalMapDataset::IndexedSegment2d &indexedSegment = trapMapData.getIndexedSegment(idSegment);
+    const cg3::Point2d *p1 = &trapMapData.getPoint(indexedSegment.first);
+    const cg3::Point2d *p2 = &trapMapData.getPoint(indexedSegment.second);
+    if (p1->x() > p2->x()) std::swap(p1, p2);
+    return orientation(*p1, *p2, trapMapData.getPoint(idPoint)) > 0 ? 1 : -1;
+}
+
+/**
+ * @brief Get the y-coordinate of a segment of the trapezoidal map on the vertical line through a wall point
+ * @param[in] idSegment The ID of the segment (NO_ID for a side of the bounding box)
+ * @param[in] idWallPoint The ID of the wall point
+ * @param[in] yBoundingBox The y-coordinate of the side of the bounding box
+ * @param[in] trapMapData The trapezoidal map dataset
+ * @return The y-coordinate of the segment, exactly the one of the wall point if it is an endpoint of the segment
+ */
+double wallY(size_t idSegment, size_t idWallPoint, double yBoundingBox, const TrapezoidalMapDataset &trapMapData)
+{
+    if (idSegment == Trapezoid::NO_ID) return yBoundingBox;
+
+    const cg3::Point2d &wallPoint = trapMapData.getPoint(idWallPoint);
+    if (hasEndpoint(idSegment, idWallPoint, trapMapData)) return wallPoint.y();
+
+    const TrapezoidalMapDataset::IndexedSegment2d &indexedSegment = trapMapData.getIndexedSegment(idSegment);
+    const cg3::Point2d &p1 = trapMapData.getPoint(indexedSegment.first);
+    const cg3::Point2d &p2 = trapMapData.getPoint(indexedSegment.second);
+    return p1.y() + (p2.y() - p1.y()) * (wallPoint.x() - p1.x()) / (p2.x() - p1.x());
+}
+
+/**
+ * @brief Check if a point is an endpoint of a segment of the trapezoidal map
+ * @param[in] idSegment The ID of the segment (NO_ID for a side of the bounding box)
+ * @param[in] idPoint The ID of the point
+ * @param[in] trapMapData The trapezoidal map dataset
+ * @return True if the point is an endpoint of the segment, false otherwise
+ */
+bool hasEndpoint(size_t idSegment, size_t idPoint, const TrapezoidalMapDataset &trapMapData)
+{
+    if (idSegment == Trapezoid::NO_ID) return false;
+    const TrapezoidalMapDataset::IndexedSegment2d &indexedSegment = trapMapData.getIndexedSegment(idSegment);
+    return indexedSegment.first == idPoint || indexedSegment.second == idPoint;
+}
+
 /**
  * @brief Check if the left point of the trapezoid overlaps with the left endpoint of the segment
  * @param[in] segment The new segment
@@ -905,6 +2856,232 @@ bool hasEndpointBR(size_t idTrapezoid, const TrapezoidalMap &trapMap)
         return segmentB.p1() == trapMapData.getPoint(trapMap.getTrapezoid(idTrapezoid).getIdPointR());
 }
 
+/**
+ * @brief Choose the adjacent trapezoid where a walk continues, between the top and the bottom one on the same side
+ * @param[in] point The query point
+ * @param[in] idTrapezoidT The ID of the top (left or right) adjacent trapezoid
+ * @param[in] idTrapezoidB The ID of the bottom (left or right) adjacent trapezoid
+ * @param[in] trapMap The trapezoidal map data structure
+ * @return The ID of the adjacent trapezoid on the same side of the query point with respect to the segment separating
+ * the two trapezoids, or the only existing one (Trapezoid::NO_ID if none)
+ */
+size_t walkAdjacency(const cg3::Point2d &point, size_t idTrapezoidT, size_t idTrapezoidB, const TrapezoidalMap &trapMap)
+{
+    if (idTrapezoidT == Trapezoid::NO_ID) return idTrapezoidB;
+    if (idTrapezoidB == Trapezoid::NO_ID || idTrapezoidT == idTrapezoidB) return idTrapezoidT;
+
+    // The bottom segment of the top trapezoid separates the two trapezoids
+    size_t idSegment = trapMap.getTrapezoid(idTrapezoidT).getIdSegmentB();
+    return positionWithRespectToSegment(point, idSegment, *trapMap.getRefTrapezoidalMapDataset()) > 0 ?
+           idTrapezoidT : idTrapezoidB;
+}
+
+/**
+ * @brief Get the position of a point with respect to a segment of the trapezoidal map
+ * @param[in] point The point
+ * @param[in] idSegment The ID of the segment
+ * @param[in] trapMapData The trapezoidal map dataset
+ * @return 1 if the point lies above the segment, -1 if it lies below, 0 if it lies on its line
+ */
+int positionWithRespectToSegment(const cg3::Point2d &point, size_t idSegment, const TrapezoidalMapDataset &trapMapData)
+{
+    assert(idSegment != Trapezoid::NO_ID);
+
+    const TrapezoidalMapDataset::IndexedSegment2d &indexedSegment = trapMapData.getIndexedSegment(idSegment);
+    const cg3::Point2d &p1 = trapMapData.getPoint(indexedSegment.first);
+    const cg3::Point2d &p2 = trapMapData.getPoint(indexedSegment.second);
+    return p1.x() < p2.x() ? orientation(p1, p2, point) : orientation(p2, p1, point);
+}
+
+/**
+ * @brief Visit the trapezoids crossed by a query segment, in order from its left (or bottom, if vertical) endpoint
+ * @param[in] segment The query segment, lying in the bounding box
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[in] visit The visitor, called with the ID of every crossed trapezoid and the ID of the segment crossed to
+ * enter it (NO_ID for the first trapezoid and for the ones entered through a vertical extension): the walk stops when
+ * it returns false
+ *
+ * In every trapezoid, the query segment leaves through the top (bottom) segment if its right endpoint lies above
+ * (below) the segment and the segment crosses its line before the right point of the trapezoid, otherwise through the
+ * right vertical extension, to the top-right or bottom-right adjacency depending on the position of the right point.
+ */
+template<class Visitor>
+void walkSegment(const cg3::Segment2d &segment, const TrapezoidalMap &trapMap, const DAG &dag, Visitor &visit)
+{
+    // Trapezoidal map dataset
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+
+    // Walk from the left endpoint (the bottom one for a vertical segment)
+    cg3::Segment2d orderedSegment = segment;
+    if (segment.p2().x() < segment.p1().x() || (segment.p2().x() == segment.p1().x() && segment.p2().y() < segment.p1().y()))
+        orderedSegment = cg3::Segment2d(segment.p2(), segment.p1());
+
+    size_t idTrapezoid = queryTrapezoidalMap(orderedSegment.p1(), trapMap, dag);
+    size_t idCrossedSegment = Trapezoid::NO_ID;
+    while (visit(idTrapezoid, idCrossedSegment)) {
+        const Trapezoid &trap = trapMap.getTrapezoid(idTrapezoid);
+        size_t idSegmentT = trap.getIdSegmentT(), idSegmentB = trap.getIdSegmentB(), idPointR = trap.getIdPointR();
+        cg3::Point2d crossing;
+
+        // Cross the top or the bottom segment (not the one just crossed), if it happens before the right point
+        bool crossT = idSegmentT != Trapezoid::NO_ID && idSegmentT != idCrossedSegment &&
+                crossingPoint(orderedSegment, idSegmentT, true, trapMapData, crossing) &&
+                (idPointR == Trapezoid::NO_ID || crossing.x() < trapMapData.getPoint(idPointR).x());
+        bool crossB = !crossT && idSegmentB != Trapezoid::NO_ID && idSegmentB != idCrossedSegment &&
+                crossingPoint(orderedSegment, idSegmentB, false, trapMapData, crossing) &&
+                (idPointR == Trapezoid::NO_ID || crossing.x() < trapMapData.getPoint(idPointR).x());
+        if (crossT || crossB) {
+            idCrossedSegment = crossT ? idSegmentT : idSegmentB;
+            idTrapezoid = queryTrapezoidalMapAcross(crossing, idCrossedSegment, crossT, trapMap, dag);
+            continue;
+        }
+
+        // The right endpoint lies in the trapezoid
+        if (idPointR == Trapezoid::NO_ID || orderedSegment.p2().x() < trapMapData.getPoint(idPointR).x())
+            break;
+
+        // Move through the right vertical extension, below or above the right point
+        bool below = orientation(orderedSegment.p1(), orderedSegment.p2(), trapMapData.getPoint(idPointR)) > 0;
+        size_t idNext = below ? trap.getIdAdjacencyBR() : trap.getIdAdjacencyTR();
+        if (idNext == Trapezoid::NO_ID) idNext = below ? trap.getIdAdjacencyTR() : trap.getIdAdjacencyBR();
+        if (idNext == Trapezoid::NO_ID) break;
+        idTrapezoid = idNext;
+        idCrossedSegment = Trapezoid::NO_ID;
+    }
+}
+
+/**
+ * @brief Find where a query segment crosses a segment of the trapezoidal map, towards its right (top) endpoint
+ * @param[in] segment The query segment, ordered from the left (bottom) endpoint
+ * @param[in] idSegment The ID of the segment of the trapezoidal map
+ * @param[in] upward True if the query segment has to cross from below the segment to above it, false for the opposite
+ * @param[in] trapMapData The trapezoidal map dataset
+ * @param[out] crossing The crossing point, on the segment of the trapezoidal map
+ * @return True if the right endpoint of the query segment lies strictly on the given side of the segment and the line
+ * of the query segment meets the segment, false otherwise
+ */
+bool crossingPoint(const cg3::Segment2d &segment, size_t idSegment, bool upward, const TrapezoidalMapDataset &trapMapData,
+                   cg3::Point2d &crossing)
+{
+    if (positionWithRespectToSegment(segment.p2(), idSegment, trapMapData) != (upward ? 1 : -1)) return false;
+
+    const TrapezoidalMapDataset::IndexedSegment2d &indexedSegment = trapMapData.getIndexedSegment(idSegment);
+    const cg3::Point2d &s1 = trapMapData.getPoint(indexedSegment.first);
+    const cg3::Point2d &s2 = trapMapData.getPoint(indexedSegment.second);
+    if (orientation(segment.p1(), segment.p2(), s1) * orientation(segment.p1(), segment.p2(), s2) > 0) return false;
+
+    // Intersection of the lines, clamped to the segment of the trapezoidal map
+    double dx = segment.p2().x() - segment.p1().x(), dy = segment.p2().y() - segment.p1().y();
+    double sx = s2.x() - s1.x(), sy = s2.y() - s1.y();
+    double t = ((segment.p1().x() - s1.x())*dy - (segment.p1().y() - s1.y())*dx) / (sx*dy - sy*dx);
+    t = std::min(std::max(t, 0.0), 1.0);
+    crossing = cg3::Point2d(s1.x() + t*sx, s1.y() + t*sy);
+    return true;
+}
+
+/**
+ * @brief Find the trapezoid on one side of a segment of the trapezoidal map, at a point of the segment
+ * @param[in] point The query point, on the segment
+ * @param[in] idSegment The ID of the segment
+ * @param[in] above True for the trapezoid above the segment, false for the one below
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @return The ID of the trapezoid
+ *
+ * Same as the point location query, but the side of the Y-nodes of the given segment is chosen by the parameter
+ * instead of by the position of the point, which lies on the segment up to the rounding errors.
+ */
+size_t queryTrapezoidalMapAcross(const cg3::Point2d &point, size_t idSegment, bool above, const TrapezoidalMap &trapMap,
+                                 const DAG &dag)
+{
+    // Trapezoidal map dataset
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+
+    const DAG::Node *dagNode = &dag.getRoot();
+    while (dagNode->getType() != DAG::Node::Type::Leaf) {
+        bool left;
+        if (dagNode->getType() == DAG::Node::Type::XNode)
+            left = point.x() < trapMapData.getPoint(dagNode->getIdInfo()).x();
+        else if (dagNode->getIdInfo() == idSegment)
+            left = above;
+        else
+            left = positionWithRespectToSegment(point, dagNode->getIdInfo(), trapMapData) > 0;
+        dagNode = &dag.getNode(left ? dagNode->getIdNodeL() : dagNode->getIdNodeR());
+    }
+    return dagNode->getIdInfo();
+}
+
+/**
+ * @brief Find the trapezoid reporting a trapezoid through its left vertical extension, in the rectangle query
+ * @param[in] idTrapezoid The ID of the trapezoid
+ * @param[in] rectangle The query rectangle, inside the bounding box
+ * @param[in] trapMap The trapezoidal map data structure
+ * @return The ID of the left adjacency containing the lowest point of the left vertical extension of the trapezoid in
+ * the rectangle, NO_ID if the extension does not lie in the rectangle (right of its left side)
+ */
+size_t rectanglePredecessor(size_t idTrapezoid, const cg3::BoundingBox2 &rectangle, const TrapezoidalMap &trapMap)
+{
+    // Trapezoidal map dataset
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+
+    const Trapezoid &trap = trapMap.getTrapezoid(idTrapezoid);
+    size_t idPointL = trap.getIdPointL(), idTL = trap.getIdAdjacencyTL(), idBL = trap.getIdAdjacencyBL();
+    if (idPointL == Trapezoid::NO_ID || (idTL == Trapezoid::NO_ID && idBL == Trapezoid::NO_ID)) return Trapezoid::NO_ID;
+
+    // Vertical extension of the left point, owning the points above its bottom end
+    const cg3::Point2d &pointL = trapMapData.getPoint(idPointL);
+    double yB = wallY(trap.getIdSegmentB(), idPointL, trapMap.getBoundingBox().min().y(), trapMapData);
+    double yT = wallY(trap.getIdSegmentT(), idPointL, trapMap.getBoundingBox().max().y(), trapMapData);
+    if (pointL.x() <= rectangle.min().x() || pointL.x() > rectangle.max().x() ||
+            yB >= rectangle.max().y() || yT < rectangle.min().y())
+        return Trapezoid::NO_ID;
+
+    // Left adjacency containing the lowest point of the extension in the rectangle
+    if (idTL == idBL || idBL == Trapezoid::NO_ID) return idTL;
+    if (idTL == Trapezoid::NO_ID) return idBL;
+    return std::max(yB, rectangle.min().y()) < pointL.y() ? idBL : idTL;
+}
+
+/**
+ * @brief Find the trapezoid reported by a trapezoid starting at the same point, in the rectangle query
+ * @param[in] idTrapezoid The ID of the trapezoid
+ * @param[in] rectangle The query rectangle, inside the bounding box
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @return The ID of the trapezoid between two segments starting at the left point of the given trapezoid, the upper
+ * one being its bottom segment, if the point lies inside the rectangle, NO_ID otherwise
+ *
+ * The left vertical extension of such a trapezoid has no length, so it has no left adjacencies: it is reported by the
+ * trapezoid above it, found with the DAG query of its left point.
+ */
+size_t rectangleWedge(size_t idTrapezoid, const cg3::BoundingBox2 &rectangle, const TrapezoidalMap &trapMap,
+                      const DAG &dag)
+{
+    // Trapezoidal map dataset
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+
+    const Trapezoid &trap = trapMap.getTrapezoid(idTrapezoid);
+    size_t idPointL = trap.getIdPointL(), idSegmentB = trap.getIdSegmentB();
+    if (idPointL == Trapezoid::NO_ID || trap.getIdAdjacencyBL() != Trapezoid::NO_ID ||
+            !hasEndpoint(idSegmentB, idPointL, trapMapData))
+        return Trapezoid::NO_ID;
+
+    const cg3::Point2d &pointL = trapMapData.getPoint(idPointL);
+    if (pointL.x() <= rectangle.min().x() || pointL.x() >= rectangle.max().x() ||
+            pointL.y() <= rectangle.min().y() || pointL.y() >= rectangle.max().y())
+        return Trapezoid::NO_ID;
+
+    // Trapezoid below the bottom segment, right of the left point: reported if its bottom segment starts there too
+    const TrapezoidalMapDataset::IndexedSegment2d &indexedSegment = trapMapData.getIndexedSegment(idSegmentB);
+    size_t idPointR = indexedSegment.first == idPointL ? indexedSegment.second : indexedSegment.first;
+    size_t idWedge = queryToBuildTrapezoidalMap(cg3::Segment2d(pointL, trapMapData.getPoint(idPointR)), trapMap, dag,
+                                                false);
+    const Trapezoid &wedge = trapMap.getTrapezoid(idWedge);
+    return wedge.getIdAdjacencyTL() == Trapezoid::NO_ID && wedge.getIdAdjacencyBL() == Trapezoid::NO_ID &&
+            wedge.getIdPointL() == idPointL ? idWedge : Trapezoid::NO_ID;
+}
+
 } // End namespace gasprjint
 
 } // End namespace gasprj
@@ -1,20 +1,68 @@
 #ifndef PLANAR_POINT_LOCATION_H
 #define PLANAR_POINT_LOCATION_H
 
+#include <vector>
+
+#include <cg3/geometry/bounding_box2.h>
 #include <cg3/geometry/segment2.h>
 
+#include "data_structures/concurrent_dag.h"
 #include "data_structures/dag.h"
-#include "drawables/drawable_trapezoidalmap.h"
-#include "drawables/drawable_trapezoidalmap_dataset.h"
+#include "data_structures/dag_grid.h"
+#include "data_structures/frozen_dag.h"
+#include "data_structures/mapped_trapezoidalmap.h"
+#include "data_structures/trapezoidalmap.h"
+#include "data_structures/trapezoidalmap_faces.h"
 
 namespace gasprj {
 
 /* Builders */
 void initTrapezoidalMap(TrapezoidalMap &trapMap, DAG &dag);
 void addSegmentToTrapezoidalMap(const cg3::Segment2d &segment, TrapezoidalMap &trapMap, DAG &dag);
+void addSegmentToTrapezoidalMap(const cg3::Segment2d &segment, TrapezoidalMap &trapMap, DAG &dag,
+                                ConcurrentDAG &concurrentDag);
+void removeSegmentFromTrapezoidalMap(const cg3::Segment2d &segment, TrapezoidalMap &trapMap, DAG &dag);
+size_t buildTrapezoidalMap(const std::vector<cg3::Segment2d> &segments, TrapezoidalMap &trapMap, DAG &dag,
+                           unsigned int seed, bool spatialSort = false);
+bool rebuildDegradedTrapezoidalMap(TrapezoidalMap &trapMap, DAG &dag, double maxDepthFactor, unsigned int seed);
+bool compactTrapezoidalMap(TrapezoidalMap &trapMap, DAG &dag, double maxDeadFraction, unsigned int seed);
+size_t buildTrapezoidalMapParallel(const std::vector<cg3::Segment2d> &segments, TrapezoidalMap &trapMap, DAG &dag,
+                                   unsigned int seed, unsigned int nThreads = 0);
 
 /* Query */
-size_t queryTrapezoidalMap(const cg3::Point2d &point, const TrapezoidalMap trapMap, const DAG &dag);
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const TrapezoidalMap &trapMap, const DAG &dag);
+void queryTrapezoidalMap(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                         const TrapezoidalMap &trapMap, const DAG &dag, unsigned int nThreads = 0,
+                         bool spatialSort = false);
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const TrapezoidalMap &trapMap, const DAG &dag,
+                           const DAGGrid &grid);
+void queryTrapezoidalMap(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                         const TrapezoidalMap &trapMap, const DAG &dag, const DAGGrid &grid, unsigned int nThreads = 0,
+                         bool spatialSort = false);
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const FrozenDAG &dag);
+void queryTrapezoidalMap(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                         const FrozenDAG &dag, unsigned int nThreads = 0, bool spatialSort = false);
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const ConcurrentDAG &dag);
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const ConcurrentDAG &dag, ConcurrentDAG::Leaf &leaf);
+void queryTrapezoidalMap(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                         const ConcurrentDAG &dag, unsigned int nThreads = 0);
+size_t queryTrapezoidalMap(const cg3::Point2d &point, const MappedTrapezoidalMap &mappedMap);
+void queryTrapezoidalMap(const cg3::Point2d *points, size_t nPoints, size_t *idTrapezoids,
+                         const MappedTrapezoidalMap &mappedMap, unsigned int nThreads = 0, bool spatialSort = false);
+size_t walkTrapezoidalMap(const cg3::Point2d &point, size_t idTrapezoid, const TrapezoidalMap &trapMap,
+                          unsigned int maxSteps);
+size_t queryTrapezoidalMap(const cg3::Point2d &point, size_t idHint, const TrapezoidalMap &trapMap, const DAG &dag,
+                           unsigned int maxSteps);
+size_t queryTrapezoidalMapLabel(const cg3::Point2d &point, const TrapezoidalMap &trapMap, const DAG &dag,
+                                const TrapezoidalMapFaces &faces);
+
+/* Range queries */
+size_t queryCrossedTrapezoids(const cg3::Segment2d &segment, const TrapezoidalMap &trapMap, const DAG &dag,
+                              size_t *idTrapezoids, size_t maxTrapezoids);
+size_t queryCrossedSegments(const cg3::Segment2d &segment, const TrapezoidalMap &trapMap, const DAG &dag,
+                            size_t *idSegments, size_t maxSegments);
+size_t queryRectangleTrapezoids(const cg3::BoundingBox2 &rectangle, const TrapezoidalMap &trapMap, const DAG &dag,
+                                size_t *idTrapezoids, size_t maxTrapezoids);
 
 } // End namespace gasprj
 
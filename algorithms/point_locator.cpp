@@ -0,0 +1,86 @@
+#include "point_locator.h"
+
+#include "algorithms/planar_point_location.h"
+
+namespace gasprj {
+
+/**
+ * @brief Constructor of a point locator
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @param[in] maxSteps The maximum number of adjacencies crossed by a walk before querying the DAG
+ */
+PointLocator::PointLocator(const TrapezoidalMap &trapMap, const DAG &dag, unsigned int maxSteps) :
+    trapMap(trapMap), dag(dag), maxSteps(maxSteps), idLastTrapezoid(Trapezoid::NO_ID),
+    dagGeneration(dag.getGeneration()), nWalks(0), nFallbacks(0)
+{
+}
+
+/**
+ * @brief Find the trapezoid containing the query point, starting from the trapezoid of the previous query
+ * @param[in] point The query point
+ * @return The ID of the trapezoid containing the query point
+ *
+ * If the data structures have been rebuilt since the previous query, the query starts from the root of the DAG.
+ */
+size_t PointLocator::query(const cg3::Point2d &point)
+{
+    if (dagGeneration != dag.getGeneration()) {
+        idLastTrapezoid = Trapezoid::NO_ID;
+        dagGeneration = dag.getGeneration();
+    }
+
+    size_t idTrapezoid = Trapezoid::NO_ID;
+    if (idLastTrapezoid != Trapezoid::NO_ID) {
+        idTrapezoid = walkTrapezoidalMap(point, idLastTrapezoid, trapMap, maxSteps);
+        nWalks++;
+    }
+    if (idTrapezoid == Trapezoid::NO_ID) {
+        idTrapezoid = queryTrapezoidalMap(point, trapMap, dag);
+        nFallbacks++;
+    }
+
+    idLastTrapezoid = idTrapezoid;
+    return idTrapezoid;
+}
+
+/**
+ * @brief Forget the previous query, so that the next one starts from the root of the DAG
+ *
+ * Call this method when the query stream jumps to a distant region (the rebuilds of the data structures are detected
+ * by the generation of the DAG).
+ */
+void PointLocator::reset()
+{
+    idLastTrapezoid = Trapezoid::NO_ID;
+    dagGeneration = dag.getGeneration();
+}
+
+/**
+ * @brief Get the trapezoid found by the previous query
+ * @return The ID of the trapezoid found by the previous query, Trapezoid::NO_ID if there is none
+ */
+size_t PointLocator::getIdLastTrapezoid() const
+{
+    return idLastTrapezoid;
+}
+
+/**
+ * @brief Get the number of queries that started with a walk from the previous trapezoid
+ * @return The number of walks
+ */
+size_t PointLocator::getNumberWalks() const
+{
+    return nWalks;
+}
+
+/**
+ * @brief Get the number of queries answered by the DAG, with no hint or after an unsuccessful walk
+ * @return The number of DAG queries
+ */
+size_t PointLocator::getNumberFallbacks() const
+{
+    return nFallbacks;
+}
+
+} // End namespace gasprj
@@ -0,0 +1,56 @@
+#ifndef POINT_LOCATOR_H
+#define POINT_LOCATOR_H
+
+#include <cg3/geometry/point2.h>
+
+#include "data_structures/dag.h"
+#include "data_structures/trapezoidalmap.h"
+
+namespace gasprj {
+
+/**
+ * @brief A stateful point locator for spatially coherent query streams
+ *
+ * This class performs the point location queries on a trapezoidal map, using the result of the previous query as a
+ * hint: the query walks on the adjacencies of the trapezoids from the previous trapezoid, and falls back to the DAG
+ * only if the query point is not reached within a bounded number of steps. When consecutive query points lie in the
+ * same or in nearby trapezoids (e.g. the positions along a track) the queries take constant amortized time.
+ *
+ * The locator keeps a reference to the trapezoidal map and to the DAG; it stays valid when segments are added to or
+ * removed from them, since any trapezoid is a valid hint (a hint beyond the removed trapezoids is replaced by a DAG
+ * query). When the data structures are rebuilt (rebuildDegradedTrapezoidalMap(), compactTrapezoidalMap()) the IDs of
+ * the trapezoids change: the locator records the generation of the DAG and forgets the previous query when it changes.
+ * Every locator has its own state, so concurrent query streams need one locator each.
+ */
+class PointLocator
+{
+public:
+    /**
+     * @brief Default maximum number of steps of the walk before querying the DAG
+     */
+    static constexpr unsigned int DEFAULT_MAX_STEPS = 16;
+
+    /* Constructors */
+    PointLocator(const TrapezoidalMap &trapMap, const DAG &dag, unsigned int maxSteps = DEFAULT_MAX_STEPS);
+
+    /* Public methods */
+    size_t query(const cg3::Point2d &point);
+    void reset();
+
+    size_t getIdLastTrapezoid() const;
+    size_t getNumberWalks() const;
+    size_t getNumberFallbacks() const;
+
+private:
+    /* Attributes */
+    const TrapezoidalMap &trapMap;
+    const DAG &dag;
+    unsigned int maxSteps;
+    size_t idLastTrapezoid;
+    size_t dagGeneration;    // Generation of the DAG of the previous query
+    size_t nWalks, nFallbacks;
+};
+
+} // End namespace gasprj
+
+#endif // POINT_LOCATOR_H
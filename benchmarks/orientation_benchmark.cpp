@@ -0,0 +1,102 @@
+/*
+ * Benchmark of the orientation predicate used by the Y-nodes of the DAG, comparing the adaptive exact predicate
+ * against the epsilon-based cg3::isPointAtLeft on random triples of points (where the filtered fast path always
+ * decides) and on almost collinear triples (where the exact fallback is needed). Reports the time per test and the
+ * number of tests in which the two predicates disagree.
+ *
+ * Usage: orientation_benchmark [number of tests] [seed]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <cg3/geometry/utils2.h>
+
+#include "algorithms/orientation.h"
+
+namespace {
+
+struct Triple {
+    cg3::Point2d a, b, c;
+};
+
+//Random triples of points in a square
+std::vector<Triple> randomTriples(size_t n, double radius, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> position(-radius, radius);
+    std::vector<Triple> triples;
+    triples.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        triples.push_back({cg3::Point2d(position(rng), position(rng)),
+                           cg3::Point2d(position(rng), position(rng)),
+                           cg3::Point2d(position(rng), position(rng))});
+    }
+    return triples;
+}
+
+//Random triples whose third point is the rounded interpolation of the first two, perturbed by a few ulps
+std::vector<Triple> almostCollinearTriples(size_t n, double radius, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> position(-radius, radius), parameter(0, 1);
+    std::uniform_int_distribution<int> ulps(-2, 2);
+    std::vector<Triple> triples;
+    triples.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        cg3::Point2d a(position(rng), position(rng)), b(position(rng), position(rng));
+        double t = parameter(rng);
+        double x = a.x() + t*(b.x() - a.x()), y = a.y() + t*(b.y() - a.y());
+        for (int k = ulps(rng); k != 0; k += (k > 0 ? -1 : 1))
+            y = std::nextafter(y, k > 0 ? INFINITY : -INFINITY);
+        triples.push_back({a, b, cg3::Point2d(x, y)});
+    }
+    return triples;
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchmark(const std::string &name, const std::vector<Triple> &triples)
+{
+    std::vector<char> cg3Left(triples.size()), exactLeft(triples.size());
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < triples.size(); i++)
+        cg3Left[i] = cg3::isPointAtLeft(triples[i].a, triples[i].b, triples[i].c);
+    double cg3Time = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < triples.size(); i++)
+        exactLeft[i] = gasprj::orientation(triples[i].a, triples[i].b, triples[i].c) > 0;
+    double exactTime = secondsSince(start);
+
+    size_t nDisagreements = 0;
+    for (size_t i = 0; i < triples.size(); i++)
+        if (cg3Left[i] != exactLeft[i]) nDisagreements++;
+
+    double nanoseconds = 1e9/triples.size();
+    std::cout << name << std::endl;
+    std::cout << "  cg3::isPointAtLeft:   " << cg3Time*nanoseconds << " ns/test" << std::endl;
+    std::cout << "  gasprj::orientation:  " << exactTime*nanoseconds << " ns/test" << std::endl;
+    std::cout << "  disagreements:        " << nDisagreements << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    size_t nTests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    unsigned int seed = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 0;
+
+    std::mt19937 rng(seed);
+    benchmark("Random points", randomTriples(nTests, 1e6, rng));
+    benchmark("Almost collinear points", almostCollinearTriples(nTests, 1e6, rng));
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+# Benchmark of the orientation predicate: adaptive exact evaluation against the cg3 epsilon-based test
+
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+QMAKE_CXXFLAGS += -O2
+DEFINES += NDEBUG
+
+CONFIG += CG3_CORE
+include (../cg3lib/cg3.pri)
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    orientation_benchmark.cpp \
+    ../algorithms/orientation.cpp
+
+HEADERS += \
+    ../algorithms/orientation.h
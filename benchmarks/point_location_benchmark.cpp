@@ -0,0 +1,1021 @@
+/*
+ * Benchmark of the point location on seeded synthetic workloads, so that the results can be compared across versions:
+ *
+ *   uniform  random non-intersecting segments of bounded length (as the random segments of the GUI)
+ *   grid     one slightly tilted segment in every cell of a square grid
+ *   strips   long, almost horizontal, parallel segments stacked along the y-axis
+ *   sorted   the strips, inserted from the bottom to the top with no randomization (worst case of the DAG depth)
+ *   polygons closed star-shaped polygons, one in every cell of a square grid, labelled as faces of the subdivision
+ *
+ * Every benchmark of a workload (construction, queries, indices, updates) is reported as a field of one JSON object per
+ * workload and line: the fields named same_results compare the answers with the ones of the plain DAG queries.
+ *
+ * Usage: point_location_benchmark [number of segments] [number of queries] [seed] [workload] [grid resolution]
+ *
+ * The grid index is only benchmarked when its resolution is given, since it is not used by default: the top levels of
+ * the DAG it skips stay in the cache, so it saves little over the plain descent.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <cg3/geometry/segment2.h>
+
+#include "algorithms/orientation.h"
+#include "algorithms/planar_point_location.h"
+#include "algorithms/point_locator.h"
+#include "data_structures/concurrent_dag.h"
+#include "data_structures/dag.h"
+#include "data_structures/dag_grid.h"
+#include "data_structures/frozen_dag.h"
+#include "data_structures/trapezoidalmap.h"
+#include "data_structures/trapezoidalmap_dataset.h"
+#include "data_structures/trapezoidalmap_faces.h"
+
+namespace {
+
+//Half side of the bounding box, as in the GUI
+const double BOUNDINGBOX = 1e6;
+
+//Number of segment and rectangle range queries, and of the samples per side checking each of them
+const size_t RANGE_QUERIES = 200;
+const size_t RANGE_SAMPLES = 8;
+
+//Random non-intersecting segments, with length bounded so that they are mostly accepted in the dataset
+std::vector<cg3::Segment2d> uniformSegments(size_t n, std::mt19937 &rng)
+{
+    double maxLength = 4*BOUNDINGBOX/std::sqrt(static_cast<double>(std::max<size_t>(n, 1)));
+    std::uniform_real_distribution<double> position(-BOUNDINGBOX + 1, BOUNDINGBOX - 1), length(-maxLength, maxLength);
+
+    TrapezoidalMapDataset dataset;
+    while (dataset.segmentNumber() < n) {
+        std::vector<cg3::Segment2d> candidates;
+        for (size_t i = dataset.segmentNumber(); i < n; i++) {
+            cg3::Point2d p1(position(rng), position(rng));
+            cg3::Point2d p2(std::max(-BOUNDINGBOX + 1, std::min(BOUNDINGBOX - 1, p1.x() + length(rng))),
+                            std::max(-BOUNDINGBOX + 1, std::min(BOUNDINGBOX - 1, p1.y() + length(rng))));
+            candidates.push_back(cg3::Segment2d(p1, p2));
+        }
+        dataset.addSegments(candidates);
+    }
+    return dataset.getSegments();
+}
+
+//One segment in every cell of a square grid, with the endpoints jittered to keep the x-coordinates distinct
+std::vector<cg3::Segment2d> gridSegments(size_t n, std::mt19937 &rng)
+{
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(n))));
+    double cell = 2*(BOUNDINGBOX - 1)/std::max<size_t>(side, 1);
+    std::uniform_real_distribution<double> jitter(0.05*cell, 0.15*cell);
+
+    std::vector<cg3::Segment2d> segments;
+    segments.reserve(n);
+    for (size_t i = 0; i < side && segments.size() < n; i++) {
+        for (size_t j = 0; j < side && segments.size() < n; j++) {
+            double x = -BOUNDINGBOX + 1 + i*cell, y = -BOUNDINGBOX + 1 + j*cell;
+            segments.push_back(cg3::Segment2d(cg3::Point2d(x + jitter(rng), y + jitter(rng)),
+                                              cg3::Point2d(x + cell - jitter(rng), y + cell - jitter(rng))));
+        }
+    }
+    return segments;
+}
+
+//Long parallel segments spanning the bounding box, from the bottom to the top
+std::vector<cg3::Segment2d> stripSegments(size_t n, std::mt19937 &rng)
+{
+    double gap = 2*(BOUNDINGBOX - 1)/(n + 1);
+    std::uniform_real_distribution<double> jitter(0, 0.1*BOUNDINGBOX), tilt(-0.1*gap, 0.1*gap);
+
+    std::vector<cg3::Segment2d> segments;
+    segments.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        double y = -BOUNDINGBOX + 1 + (i + 1)*gap, dy = tilt(rng);
+        segments.push_back(cg3::Segment2d(cg3::Point2d(-BOUNDINGBOX + 1 + jitter(rng), y - dy),
+                                          cg3::Point2d(BOUNDINGBOX - 1 - jitter(rng), y + dy)));
+    }
+    return segments;
+}
+
+//Edges of closed star-shaped polygons, one in every cell of a square grid, with 3 to 8 vertices at random angles
+std::vector<cg3::Segment2d> polygonSegments(size_t n, std::mt19937 &rng,
+                                            std::vector<std::vector<cg3::Point2d>> &polygons)
+{
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(n)/5.5)));
+    double cell = 2*(BOUNDINGBOX - 1)/std::max<size_t>(side, 1);
+    std::uniform_int_distribution<size_t> nVertices(3, 8);
+    std::uniform_real_distribution<double> angle(0, 2*std::acos(-1.0)), radius(0.2*cell, 0.45*cell);
+
+    std::vector<cg3::Segment2d> segments;
+    segments.reserve(n);
+    for (size_t i = 0; i < side && segments.size() + 3 <= n; i++) {
+        for (size_t j = 0; j < side && segments.size() + 3 <= n; j++) {
+            double x = -BOUNDINGBOX + 1 + (i + 0.5)*cell, y = -BOUNDINGBOX + 1 + (j + 0.5)*cell;
+            std::vector<double> angles(std::min(nVertices(rng), n - segments.size()));
+            for (double &a : angles)
+                a = angle(rng);
+            std::sort(angles.begin(), angles.end());
+
+            std::vector<cg3::Point2d> polygon;
+            for (double a : angles) {
+                double r = radius(rng);
+                polygon.push_back(cg3::Point2d(x + r*std::cos(a), y + r*std::sin(a)));
+            }
+            for (size_t k = 0; k < polygon.size(); k++)
+                segments.push_back(cg3::Segment2d(polygon[k], polygon[(k + 1) % polygon.size()]));
+            polygons.push_back(polygon);
+        }
+    }
+    return segments;
+}
+
+//Even-odd test of a point against the edges of a polygon
+bool insidePolygon(const cg3::Point2d &point, const std::vector<cg3::Point2d> &polygon)
+{
+    bool inside = false;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        const cg3::Point2d &p = polygon[i], &q = polygon[j];
+        if ((p.y() > point.y()) != (q.y() > point.y()) &&
+                point.x() < p.x() + (point.y() - p.y())*(q.x() - p.x())/(q.y() - p.y()))
+            inside = !inside;
+    }
+    return inside;
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//Latency at a given percentile of the sorted latencies
+double percentile(const std::vector<double> &sortedLatencies, double p)
+{
+    if (sortedLatencies.empty()) return 0;
+    size_t id = static_cast<size_t>(std::ceil(p/100*sortedLatencies.size()));
+    return sortedLatencies[std::min(std::max<size_t>(id, 1), sortedLatencies.size()) - 1];
+}
+
+const char *jsonBool(bool value)
+{
+    return value ? "true" : "false";
+}
+
+//Trapezoidal map and DAG of a workload, with the uniform queries and their answers shared by the benchmarks
+struct Workload {
+    std::string name;
+    unsigned int seed;
+    TrapezoidalMapDataset dataset;
+    std::vector<cg3::Segment2d> segments;   // Segments accepted by the dataset, in the generated order
+    gasprj::TrapezoidalMap trapMap;
+    gasprj::DAG dag;
+    double buildTime;
+    std::vector<cg3::Point2d> queries;
+    std::vector<size_t> results;            // Answers of the DAG to the queries
+    std::vector<std::vector<cg3::Point2d>> polygons;   // Polygons whose edges are all in the dataset (polygons only)
+
+    Workload(const std::string &name, size_t nSegments, size_t nQueries, unsigned int seed);
+};
+
+Workload::Workload(const std::string &name, size_t nSegments, size_t nQueries, unsigned int seed) :
+    name(name), seed(seed),
+    trapMap(&dataset, cg3::Point2d(-BOUNDINGBOX, -BOUNDINGBOX), cg3::Point2d(BOUNDINGBOX, BOUNDINGBOX))
+{
+    std::mt19937 rng(seed);
+    std::vector<cg3::Segment2d> generated;
+    if (name == "uniform") generated = uniformSegments(nSegments, rng);
+    else if (name == "grid") generated = gridSegments(nSegments, rng);
+    else if (name == "polygons") generated = polygonSegments(nSegments, rng, polygons);
+    else generated = stripSegments(nSegments, rng);
+
+    //Keep only the segments accepted by the dataset, in the generated order
+    std::vector<TrapezoidalMapDataset::SegmentInsertion> insertions = dataset.addSegments(generated);
+    segments.reserve(generated.size());
+    for (size_t i = 0; i < generated.size(); i++)
+        if (insertions[i] == TrapezoidalMapDataset::SegmentInsertion::Inserted)
+            segments.push_back(generated[i]);
+
+    //Keep only the polygons still closed
+    auto closed = [this](const std::vector<cg3::Point2d> &polygon) {
+        for (size_t k = 0; k < polygon.size(); k++) {
+            bool found;
+            dataset.findSegment(cg3::Segment2d(polygon[k], polygon[(k + 1) % polygon.size()]), found);
+            if (!found) return false;
+        }
+        return true;
+    };
+    polygons.erase(std::remove_if(polygons.begin(), polygons.end(),
+                                  [&closed](const std::vector<cg3::Point2d> &polygon) { return !closed(polygon); }),
+                   polygons.end());
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    gasprj::initTrapezoidalMap(trapMap, dag);
+    if (name == "sorted") {
+        for (const cg3::Segment2d &segment : segments)
+            gasprj::addSegmentToTrapezoidalMap(segment, trapMap, dag);
+    }
+    else {
+        gasprj::buildTrapezoidalMap(segments, trapMap, dag, seed);
+    }
+    buildTime = secondsSince(start);
+
+    std::uniform_real_distribution<double> position(-BOUNDINGBOX, BOUNDINGBOX);
+    queries.reserve(nQueries);
+    for (size_t i = 0; i < nQueries; i++)
+        queries.push_back(cg3::Point2d(position(rng), position(rng)));
+    results.reserve(nQueries);
+    for (const cg3::Point2d &query : queries)
+        results.push_back(gasprj::queryTrapezoidalMap(query, trapMap, dag));
+}
+
+//Same top and bottom segments of the answers of another trapezoidal map (whose trapezoids may be split differently)
+bool sameSegments(const Workload &workload, const gasprj::TrapezoidalMap &otherTrapMap,
+                  const std::vector<size_t> &otherResults)
+{
+    for (size_t i = 0; i < workload.queries.size(); i++) {
+        const gasprj::Trapezoid &trap = workload.trapMap.getTrapezoid(workload.results[i]);
+        const gasprj::Trapezoid &otherTrap = otherTrapMap.getTrapezoid(otherResults[i]);
+        if (trap.getIdSegmentT() != otherTrap.getIdSegmentT() || trap.getIdSegmentB() != otherTrap.getIdSegmentB())
+            return false;
+    }
+    return true;
+}
+
+
+
+//Uniform queries, timed one by one
+struct QueryResult {
+    double queryTime;
+    double latencyP50, latencyP90, latencyP99, latencyMax;
+};
+
+QueryResult benchmarkQueries(const Workload &workload)
+{
+    QueryResult result;
+    std::vector<double> latencies;
+    latencies.reserve(workload.queries.size());
+    size_t checksum = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const cg3::Point2d &query : workload.queries) {
+        std::chrono::steady_clock::time_point queryStart = std::chrono::steady_clock::now();
+        checksum += gasprj::queryTrapezoidalMap(query, workload.trapMap, workload.dag);
+        latencies.push_back(secondsSince(queryStart)*1e9);
+    }
+    result.queryTime = secondsSince(start);
+    if (checksum == static_cast<size_t>(-1)) std::cerr << checksum << std::endl;
+
+    std::sort(latencies.begin(), latencies.end());
+    result.latencyP50 = percentile(latencies, 50);
+    result.latencyP90 = percentile(latencies, 90);
+    result.latencyP99 = percentile(latencies, 99);
+    result.latencyMax = latencies.empty() ? 0 : latencies.back();
+    return result;
+}
+
+void print(std::ostream &out, const QueryResult &result)
+{
+    out << ", \"query_s\": " << result.queryTime
+        << ", \"latency_ns\": {\"p50\": " << result.latencyP50 << ", \"p90\": " << result.latencyP90
+        << ", \"p99\": " << result.latencyP99 << ", \"max\": " << result.latencyMax << "}";
+}
+
+//Coherent queries (a random walk with short steps), answered by the DAG and by the walking point locator
+struct CoherentResult {
+    double dagTime, locatorTime;
+    size_t fallbacks;
+    bool sameResults;
+};
+
+CoherentResult benchmarkCoherent(const Workload &workload)
+{
+    CoherentResult result;
+    std::mt19937 rng(workload.seed);
+    double stepLength = 0.1*BOUNDINGBOX/std::sqrt(static_cast<double>(std::max<size_t>(workload.segments.size(), 1)));
+    std::normal_distribution<double> step(0, stepLength);
+    std::vector<cg3::Point2d> track;
+    track.reserve(workload.queries.size());
+    cg3::Point2d position(0, 0);
+    for (size_t i = 0; i < workload.queries.size(); i++) {
+        position = cg3::Point2d(std::max(-BOUNDINGBOX, std::min(BOUNDINGBOX, position.x() + step(rng))),
+                                std::max(-BOUNDINGBOX, std::min(BOUNDINGBOX, position.y() + step(rng))));
+        track.push_back(position);
+    }
+
+    std::vector<size_t> dagResults, locatorResults;
+    dagResults.reserve(track.size());
+    locatorResults.reserve(track.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const cg3::Point2d &query : track)
+        dagResults.push_back(gasprj::queryTrapezoidalMap(query, workload.trapMap, workload.dag));
+    result.dagTime = secondsSince(start);
+
+    gasprj::PointLocator locator(workload.trapMap, workload.dag);
+    start = std::chrono::steady_clock::now();
+    for (const cg3::Point2d &query : track)
+        locatorResults.push_back(locator.query(query));
+    result.locatorTime = secondsSince(start);
+    result.fallbacks = locator.getNumberFallbacks();
+    result.sameResults = dagResults == locatorResults;
+    return result;
+}
+
+void print(std::ostream &out, const CoherentResult &result)
+{
+    out << ", \"coherent\": {\"dag_s\": " << result.dagTime
+        << ", \"locator_s\": " << result.locatorTime
+        << ", \"locator_fallbacks\": " << result.fallbacks
+        << ", \"same_results\": " << jsonBool(result.sameResults) << "}";
+}
+
+//Uniform queries answered by the DAG from the root and from the nodes of the grid index, then by a grid made stale
+//by the layout of the DAG and by the same grid after its update
+struct GridResult {
+    size_t resolution, bytes;
+    double buildTime, dagTime, gridTime;
+    bool sameResults, sameStaleResults;
+};
+
+GridResult benchmarkGrid(const Workload &workload, size_t resolution)
+{
+    GridResult result;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    gasprj::DAGGrid grid(workload.dag, workload.trapMap, resolution);
+    result.buildTime = secondsSince(start);
+    result.resolution = grid.getResolution();
+    result.bytes = grid.memory();
+
+    std::vector<size_t> dagResults, gridResults;
+    dagResults.reserve(workload.queries.size());
+    gridResults.reserve(workload.queries.size());
+    start = std::chrono::steady_clock::now();
+    for (const cg3::Point2d &query : workload.queries)
+        dagResults.push_back(gasprj::queryTrapezoidalMap(query, workload.trapMap, workload.dag));
+    result.dagTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (const cg3::Point2d &query : workload.queries)
+        gridResults.push_back(gasprj::queryTrapezoidalMap(query, workload.trapMap, workload.dag, grid));
+    result.gridTime = secondsSince(start);
+    result.sameResults = gridResults == workload.results;
+
+    gasprj::TrapezoidalMap trapMap = workload.trapMap;
+    gasprj::DAG dag = workload.dag;
+    dag.optimizeLayout(trapMap);
+    std::vector<size_t> staleResults, updatedResults;
+    for (const cg3::Point2d &query : workload.queries)
+        staleResults.push_back(gasprj::queryTrapezoidalMap(query, trapMap, dag, grid));
+    grid.update(dag, trapMap);
+    for (const cg3::Point2d &query : workload.queries)
+        updatedResults.push_back(gasprj::queryTrapezoidalMap(query, trapMap, dag, grid));
+    result.sameStaleResults = grid.isValid(dag) && staleResults == workload.results &&
+            updatedResults == workload.results;
+    return result;
+}
+
+void print(std::ostream &out, const GridResult &result)
+{
+    out << ", \"grid\": {\"resolution\": " << result.resolution
+        << ", \"build_s\": " << result.buildTime
+        << ", \"memory_bytes\": " << result.bytes
+        << ", \"dag_query_s\": " << result.dagTime
+        << ", \"grid_query_s\": " << result.gridTime
+        << ", \"same_results\": " << jsonBool(result.sameResults)
+        << ", \"stale_same_results\": " << jsonBool(result.sameStaleResults) << "}";
+}
+
+//Uniform queries answered one by one by the DAG and by the frozen DAG, and as a single batch by the frozen DAG
+struct BatchResult {
+    double dagLoopTime, frozenLoopTime, frozenBatchTime;
+    bool sameResults;
+};
+
+BatchResult benchmarkBatch(const Workload &workload)
+{
+    BatchResult result;
+    size_t nQueries = workload.queries.size();
+    gasprj::FrozenDAG frozenDag(workload.dag, workload.dataset);
+    std::vector<size_t> dagLoopResults(nQueries), frozenLoopResults(nQueries), frozenBatchResults(nQueries);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nQueries; i++)
+        dagLoopResults[i] = gasprj::queryTrapezoidalMap(workload.queries[i], workload.trapMap, workload.dag);
+    result.dagLoopTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nQueries; i++)
+        frozenLoopResults[i] = gasprj::queryTrapezoidalMap(workload.queries[i], frozenDag);
+    result.frozenLoopTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    gasprj::queryTrapezoidalMap(workload.queries.data(), nQueries, frozenBatchResults.data(), frozenDag, 1);
+    result.frozenBatchTime = secondsSince(start);
+    result.sameResults = frozenLoopResults == workload.results && frozenBatchResults == workload.results;
+    return result;
+}
+
+void print(std::ostream &out, const BatchResult &result)
+{
+    out << ", \"batch\": {\"dag_loop_s\": " << result.dagLoopTime
+        << ", \"frozen_loop_s\": " << result.frozenLoopTime
+        << ", \"frozen_batch_s\": " << result.frozenBatchTime
+        << ", \"same_results\": " << jsonBool(result.sameResults) << "}";
+}
+
+//Batches answered in the order of the Hilbert curve, and construction with the rounds sorted along the same curve
+//(skipped on the sorted workload, whose insertion order is the point of the workload: its fields are omitted)
+struct SortedResult {
+    double dagBatchTime, frozenBatchTime, buildTime;
+    size_t buildDepth;
+    bool built, sameResults;
+};
+
+SortedResult benchmarkSorted(Workload &workload)
+{
+    SortedResult result;
+    size_t nQueries = workload.queries.size();
+    gasprj::FrozenDAG frozenDag(workload.dag, workload.dataset);
+    std::vector<size_t> dagResults(nQueries), frozenResults(nQueries);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    gasprj::queryTrapezoidalMap(workload.queries.data(), nQueries, dagResults.data(), workload.trapMap, workload.dag,
+                                1, true);
+    result.dagBatchTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    gasprj::queryTrapezoidalMap(workload.queries.data(), nQueries, frozenResults.data(), frozenDag, 1, true);
+    result.frozenBatchTime = secondsSince(start);
+    result.sameResults = dagResults == workload.results && frozenResults == workload.results;
+
+    result.built = workload.name != "sorted";
+    if (result.built) {
+        gasprj::TrapezoidalMap sortedTrapMap(&workload.dataset,
+                                             cg3::Point2d(-BOUNDINGBOX, -BOUNDINGBOX),
+                                             cg3::Point2d(BOUNDINGBOX, BOUNDINGBOX));
+        gasprj::DAG sortedDag;
+        start = std::chrono::steady_clock::now();
+        gasprj::initTrapezoidalMap(sortedTrapMap, sortedDag);
+        result.buildDepth = gasprj::buildTrapezoidalMap(workload.segments, sortedTrapMap, sortedDag, workload.seed,
+                                                        true);
+        result.buildTime = secondsSince(start);
+    }
+    return result;
+}
+
+void print(std::ostream &out, const SortedResult &result)
+{
+    out << ", \"sorted\": {\"dag_batch_s\": " << result.dagBatchTime
+        << ", \"frozen_batch_s\": " << result.frozenBatchTime;
+    if (result.built) {
+        out << ", \"build_s\": " << result.buildTime
+            << ", \"build_depth\": " << result.buildDepth;
+    }
+    out << ", \"same_results\": " << jsonBool(result.sameResults) << "}";
+}
+
+//Construction split in vertical slabs on all the hardware threads, which must give the same trapezoids
+struct ParallelResult {
+    double buildTime;
+    size_t buildDepth, nTrapezoids;
+    bool sameResults;
+};
+
+ParallelResult benchmarkParallel(Workload &workload)
+{
+    ParallelResult result;
+    gasprj::TrapezoidalMap parallelTrapMap(&workload.dataset,
+                                           cg3::Point2d(-BOUNDINGBOX, -BOUNDINGBOX),
+                                           cg3::Point2d(BOUNDINGBOX, BOUNDINGBOX));
+    gasprj::DAG parallelDag;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    result.buildDepth = gasprj::buildTrapezoidalMapParallel(workload.segments, parallelTrapMap, parallelDag,
+                                                            workload.seed);
+    result.buildTime = secondsSince(start);
+    result.nTrapezoids = parallelTrapMap.size();
+
+    std::vector<size_t> parallelResults;
+    parallelResults.reserve(workload.queries.size());
+    for (const cg3::Point2d &query : workload.queries)
+        parallelResults.push_back(gasprj::queryTrapezoidalMap(query, parallelTrapMap, parallelDag));
+    result.sameResults = parallelTrapMap.size() == workload.trapMap.size() &&
+            sameSegments(workload, parallelTrapMap, parallelResults);
+    return result;
+}
+
+void print(std::ostream &out, const ParallelResult &result)
+{
+    out << ", \"parallel\": {\"build_s\": " << result.buildTime
+        << ", \"build_depth\": " << result.buildDepth
+        << ", \"trapezoids\": " << result.nTrapezoids
+        << ", \"same_results\": " << jsonBool(result.sameResults) << "}";
+}
+
+//Incremental construction published to a concurrent DAG, queried by another thread during the insertions: the reader
+//checks that every query point lies in the copy of the trapezoid returned with the leaf
+struct ConcurrentResult {
+    double buildTime, loopTime;
+    size_t readerQueries, readerOutside;
+    bool sameResults;
+};
+
+//Same conventions of the query: a point in the vertical extension of an endpoint or on a segment is at its right or
+//below it
+bool insideLeaf(const cg3::Point2d &point, const gasprj::ConcurrentDAG::Leaf &leaf,
+                const gasprj::ConcurrentDAG &concurrentDag, const TrapezoidalMapDataset &dataset)
+{
+    if (leaf.idPointL != gasprj::Trapezoid::NO_ID && point.x() < dataset.getPoint(leaf.idPointL).x())
+        return false;
+    if (leaf.idPointR != gasprj::Trapezoid::NO_ID && point.x() >= dataset.getPoint(leaf.idPointR).x())
+        return false;
+    if (leaf.idSegmentT != gasprj::Trapezoid::NO_ID) {
+        const gasprj::FrozenDAG::OrderedSegment &segment = concurrentDag.getSegment(leaf.idSegmentT);
+        if (gasprj::orientation(segment.p1, segment.p2, point) > 0)
+            return false;
+    }
+    if (leaf.idSegmentB != gasprj::Trapezoid::NO_ID) {
+        const gasprj::FrozenDAG::OrderedSegment &segment = concurrentDag.getSegment(leaf.idSegmentB);
+        if (gasprj::orientation(segment.p1, segment.p2, point) <= 0)
+            return false;
+    }
+    return true;
+}
+
+ConcurrentResult benchmarkConcurrent(Workload &workload)
+{
+    ConcurrentResult result;
+    TrapezoidalMapDataset &dataset = workload.dataset;
+    const std::vector<cg3::Point2d> &queries = workload.queries;
+    gasprj::TrapezoidalMap concurrentTrapMap(&dataset, cg3::Point2d(-BOUNDINGBOX, -BOUNDINGBOX),
+                                             cg3::Point2d(BOUNDINGBOX, BOUNDINGBOX));
+    gasprj::DAG concurrentDagSource;
+    gasprj::initTrapezoidalMap(concurrentTrapMap, concurrentDagSource);
+    gasprj::ConcurrentDAG concurrentDag(concurrentDagSource, concurrentTrapMap);
+    std::vector<cg3::Segment2d> shuffledSegments = workload.segments;
+    std::shuffle(shuffledSegments.begin(), shuffledSegments.end(), std::mt19937(workload.seed));
+
+    std::atomic<bool> inserting(true);
+    size_t readerQueries = 0, readerOutside = 0;
+    //The dataset is filled before the insertions, so its points can be read by the reader
+    std::thread reader([&queries, &concurrentDag, &dataset, &inserting, &readerQueries, &readerOutside]() {
+        gasprj::ConcurrentDAG::Leaf leaf;
+        for (size_t i = 0; inserting.load(std::memory_order_relaxed) && !queries.empty(); i++, readerQueries++) {
+            const cg3::Point2d &query = queries[i % queries.size()];
+            gasprj::queryTrapezoidalMap(query, concurrentDag, leaf);
+            if (!insideLeaf(query, leaf, concurrentDag, dataset))
+                readerOutside++;
+        }
+    });
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const cg3::Segment2d &segment : shuffledSegments)
+        gasprj::addSegmentToTrapezoidalMap(segment, concurrentTrapMap, concurrentDagSource, concurrentDag);
+    result.buildTime = secondsSince(start);
+    inserting.store(false, std::memory_order_relaxed);
+    reader.join();
+    result.readerQueries = readerQueries;
+    result.readerOutside = readerOutside;
+
+    std::vector<size_t> concurrentResults(queries.size());
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); i++)
+        concurrentResults[i] = gasprj::queryTrapezoidalMap(queries[i], concurrentDag);
+    result.loopTime = secondsSince(start);
+    result.sameResults = sameSegments(workload, concurrentTrapMap, concurrentResults);
+    return result;
+}
+
+void print(std::ostream &out, const ConcurrentResult &result)
+{
+    out << ", \"concurrent\": {\"build_s\": " << result.buildTime
+        << ", \"reader_queries\": " << result.readerQueries
+        << ", \"reader_outside\": " << result.readerOutside
+        << ", \"loop_s\": " << result.loopTime
+        << ", \"same_results\": " << jsonBool(result.sameResults) << "}";
+}
+
+//Removal of half of the segments in random order, then compaction of the retired DAG nodes (compared with a
+//construction of the remaining segments): a point locator used before the compaction must forget its previous query,
+//and a frozen DAG must be detected as stale
+struct RemovalResult {
+    double removalTime, compactTime;
+    size_t removalNodes, compactNodes;
+    bool removalSameResults, compactSameResults, compactLocatorSameResults, compactFrozenStale;
+};
+
+RemovalResult benchmarkRemoval(Workload &workload)
+{
+    RemovalResult result;
+    TrapezoidalMapDataset *dataset = &workload.dataset;
+    std::vector<cg3::Segment2d> shuffledSegments = workload.segments;
+    std::shuffle(shuffledSegments.begin(), shuffledSegments.end(), std::mt19937(workload.seed + 1));
+    std::vector<cg3::Segment2d> removedSegments(shuffledSegments.begin(),
+                                                shuffledSegments.begin() + shuffledSegments.size()/2);
+    std::vector<cg3::Segment2d> remainingSegments(shuffledSegments.begin() + shuffledSegments.size()/2,
+                                                  shuffledSegments.end());
+
+    gasprj::TrapezoidalMap removalTrapMap(dataset, cg3::Point2d(-BOUNDINGBOX, -BOUNDINGBOX),
+                                          cg3::Point2d(BOUNDINGBOX, BOUNDINGBOX));
+    gasprj::DAG removalDag;
+    gasprj::initTrapezoidalMap(removalTrapMap, removalDag);
+    gasprj::buildTrapezoidalMap(workload.segments, removalTrapMap, removalDag, workload.seed);
+
+    gasprj::TrapezoidalMap remainingTrapMap(dataset, cg3::Point2d(-BOUNDINGBOX, -BOUNDINGBOX),
+                                            cg3::Point2d(BOUNDINGBOX, BOUNDINGBOX));
+    gasprj::DAG remainingDag;
+    gasprj::initTrapezoidalMap(remainingTrapMap, remainingDag);
+    gasprj::buildTrapezoidalMap(remainingSegments, remainingTrapMap, remainingDag, workload.seed);
+
+    //Same answers of the construction of the remaining segments, compared by their top and bottom segments
+    auto sameResults = [&workload, &remainingTrapMap, &remainingDag](const gasprj::TrapezoidalMap &otherTrapMap,
+                                                                     const gasprj::DAG &otherDag) {
+        for (const cg3::Point2d &query : workload.queries) {
+            const gasprj::Trapezoid &trap = remainingTrapMap.getTrapezoid(
+                        gasprj::queryTrapezoidalMap(query, remainingTrapMap, remainingDag));
+            const gasprj::Trapezoid &otherTrap = otherTrapMap.getTrapezoid(
+                        gasprj::queryTrapezoidalMap(query, otherTrapMap, otherDag));
+            if (trap.getIdSegmentT() != otherTrap.getIdSegmentT() || trap.getIdSegmentB() != otherTrap.getIdSegmentB())
+                return false;
+        }
+        return true;
+    };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const cg3::Segment2d &segment : removedSegments)
+        gasprj::removeSegmentFromTrapezoidalMap(segment, removalTrapMap, removalDag);
+    result.removalTime = secondsSince(start);
+    result.removalNodes = removalDag.size();
+    result.removalSameResults = sameResults(removalTrapMap, removalDag);
+
+    gasprj::PointLocator locator(removalTrapMap, removalDag);
+    for (const cg3::Point2d &query : workload.queries)
+        locator.query(query);
+    gasprj::FrozenDAG frozenDag(removalDag, *dataset);
+
+    start = std::chrono::steady_clock::now();
+    gasprj::compactTrapezoidalMap(removalTrapMap, removalDag, 0, workload.seed);
+    result.compactTime = secondsSince(start);
+    result.compactNodes = removalDag.size();
+    result.compactSameResults = sameResults(removalTrapMap, removalDag);
+
+    result.compactLocatorSameResults = true;
+    for (const cg3::Point2d &query : workload.queries) {
+        if (locator.query(query) != gasprj::queryTrapezoidalMap(query, removalTrapMap, removalDag))
+            result.compactLocatorSameResults = false;
+    }
+    result.compactFrozenStale = !frozenDag.isValid(removalDag);
+    return result;
+}
+
+void print(std::ostream &out, const RemovalResult &result)
+{
+    out << ", \"removal\": {\"remove_s\": " << result.removalTime
+        << ", \"nodes\": " << result.removalNodes
+        << ", \"same_results\": " << jsonBool(result.removalSameResults)
+        << ", \"compact_s\": " << result.compactTime
+        << ", \"compact_nodes\": " << result.compactNodes
+        << ", \"compact_same_results\": " << jsonBool(result.compactSameResults)
+        << ", \"compact_locator_same_results\": " << jsonBool(result.compactLocatorSameResults)
+        << ", \"compact_frozen_stale\": " << jsonBool(result.compactFrozenStale) << "}";
+}
+
+//Faces of the subdivision labelled by their IDs (compared with the faces of a construction with another seed), and
+//queries of the labels
+struct FacesResult {
+    double buildTime, queryTime;
+    size_t nFaces;
+    bool sameResults;
+};
+
+FacesResult benchmarkFaces(Workload &workload)
+{
+    FacesResult result;
+    size_t nQueries = workload.queries.size();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    gasprj::TrapezoidalMapFaces faces(workload.trapMap);
+    result.buildTime = secondsSince(start);
+    result.nFaces = faces.size();
+    for (size_t idFace = 0; idFace < faces.size(); idFace++)
+        faces.setLabel(idFace, idFace);
+
+    std::vector<size_t> labels(nQueries);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nQueries; i++)
+        labels[i] = gasprj::queryTrapezoidalMapLabel(workload.queries[i], workload.trapMap, workload.dag, faces);
+    result.queryTime = secondsSince(start);
+
+    gasprj::TrapezoidalMap otherTrapMap(&workload.dataset,
+                                        cg3::Point2d(-BOUNDINGBOX, -BOUNDINGBOX),
+                                        cg3::Point2d(BOUNDINGBOX, BOUNDINGBOX));
+    gasprj::DAG otherDag;
+    gasprj::initTrapezoidalMap(otherTrapMap, otherDag);
+    gasprj::buildTrapezoidalMap(workload.segments, otherTrapMap, otherDag, workload.seed + 1);
+    gasprj::TrapezoidalMapFaces otherFaces(otherTrapMap);
+
+    result.sameResults = otherFaces.size() == faces.size();
+    for (size_t i = 0; i < nQueries && result.sameResults; i++)
+        result.sameResults = otherFaces.getFace(gasprj::queryTrapezoidalMap(workload.queries[i], otherTrapMap,
+                                                                            otherDag)) == labels[i];
+    return result;
+}
+
+void print(std::ostream &out, const FacesResult &result)
+{
+    out << ", \"faces\": {\"build_s\": " << result.buildTime
+        << ", \"faces\": " << result.nFaces
+        << ", \"label_query_s\": " << result.queryTime
+        << ", \"same_results\": " << jsonBool(result.sameResults) << "}";
+}
+
+//Faces inside the polygons labelled by the index of the polygon, and queries of the labels (checked against the
+//even-odd test of the queries on every polygon)
+struct PolygonsResult {
+    double labelTime, queryTime;
+    size_t nPolygons, nLabelled, nInside;
+    bool sameResults;
+};
+
+PolygonsResult benchmarkPolygons(Workload &workload)
+{
+    PolygonsResult result;
+    const std::vector<std::vector<cg3::Point2d>> &polygons = workload.polygons;
+    const std::vector<cg3::Point2d> &queries = workload.queries;
+    result.nPolygons = polygons.size();
+
+    gasprj::TrapezoidalMapFaces faces(workload.trapMap);
+    result.nLabelled = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < polygons.size(); i++)
+        if (faces.labelPolygon(polygons[i], i, workload.dataset) != gasprj::TrapezoidalMapFaces::NO_ID)
+            result.nLabelled++;
+    result.labelTime = secondsSince(start);
+
+    std::vector<size_t> labels(queries.size());
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); i++)
+        labels[i] = gasprj::queryTrapezoidalMapLabel(queries[i], workload.trapMap, workload.dag, faces);
+    result.queryTime = secondsSince(start);
+
+    //Brute force: every polygon whose bounding box contains the query
+    std::vector<cg3::Point2d> minPoints, maxPoints;
+    for (const std::vector<cg3::Point2d> &polygon : polygons) {
+        cg3::Point2d minPoint = polygon.front(), maxPoint = polygon.front();
+        for (const cg3::Point2d &p : polygon) {
+            minPoint = cg3::Point2d(std::min(minPoint.x(), p.x()), std::min(minPoint.y(), p.y()));
+            maxPoint = cg3::Point2d(std::max(maxPoint.x(), p.x()), std::max(maxPoint.y(), p.y()));
+        }
+        minPoints.push_back(minPoint);
+        maxPoints.push_back(maxPoint);
+    }
+    result.nInside = 0;
+    result.sameResults = result.nLabelled == polygons.size();
+    for (size_t i = 0; i < queries.size() && result.sameResults; i++) {
+        const cg3::Point2d &query = queries[i];
+        size_t label = gasprj::TrapezoidalMapFaces::NO_LABEL;
+        for (size_t j = 0; j < polygons.size(); j++) {
+            if (query.x() >= minPoints[j].x() && query.x() <= maxPoints[j].x() &&
+                    query.y() >= minPoints[j].y() && query.y() <= maxPoints[j].y() &&
+                    insidePolygon(query, polygons[j])) {
+                label = j;
+                break;
+            }
+        }
+        if (label != gasprj::TrapezoidalMapFaces::NO_LABEL) result.nInside++;
+        result.sameResults = labels[i] == label;
+    }
+    return result;
+}
+
+void print(std::ostream &out, const PolygonsResult &result)
+{
+    out << ", \"polygons\": {\"polygons\": " << result.nPolygons
+        << ", \"labelled\": " << result.nLabelled
+        << ", \"label_s\": " << result.labelTime
+        << ", \"inside_queries\": " << result.nInside
+        << ", \"label_query_s\": " << result.queryTime
+        << ", \"same_results\": " << jsonBool(result.sameResults) << "}";
+}
+
+//Trapezoids crossed by corridors from the queries towards the next ones and intersecting viewports centered at the
+//queries, both a twentieth of the bounding box wide (checked against the point location of samples of the ranges)
+struct RangeResult {
+    double segmentTime, rectangleTime;
+    size_t segmentTrapezoids, rectangleTrapezoids;
+    bool sameResults;
+};
+
+RangeResult benchmarkRange(const Workload &workload)
+{
+    RangeResult result;
+    const std::vector<cg3::Point2d> &queries = workload.queries;
+    const gasprj::TrapezoidalMap &trapMap = workload.trapMap;
+    const gasprj::DAG &dag = workload.dag;
+
+    //A single buffer, large enough for any answer
+    std::vector<size_t> idTrapezoids(trapMap.size());
+    size_t nRanges = std::min(RANGE_QUERIES, queries.size()/2);
+    result.segmentTrapezoids = result.rectangleTrapezoids = 0;
+    result.sameResults = true;
+
+    //Every sampled point is located in one of the reported trapezoids
+    auto covered = [&trapMap, &dag, &idTrapezoids](const cg3::Point2d &point, size_t nTrapezoids) {
+        size_t idTrapezoid = gasprj::queryTrapezoidalMap(point, trapMap, dag);
+        return std::find(idTrapezoids.begin(), idTrapezoids.begin() + nTrapezoids, idTrapezoid) !=
+                idTrapezoids.begin() + nTrapezoids;
+    };
+
+    std::vector<cg3::Segment2d> corridors(nRanges);
+    for (size_t i = 0; i < nRanges; i++)
+        corridors[i] = cg3::Segment2d(queries[2*i], queries[2*i] + (queries[2*i + 1] - queries[2*i])*0.05);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nRanges; i++)
+        result.segmentTrapezoids += gasprj::queryCrossedTrapezoids(corridors[i], trapMap, dag,
+                                                                   idTrapezoids.data(), idTrapezoids.size());
+    result.segmentTime = secondsSince(start);
+
+    for (size_t i = 0; i < nRanges && result.sameResults; i++) {
+        const cg3::Point2d &p1 = corridors[i].p1(), &p2 = corridors[i].p2();
+        size_t nTrapezoids = gasprj::queryCrossedTrapezoids(corridors[i], trapMap, dag,
+                                                            idTrapezoids.data(), idTrapezoids.size());
+        for (size_t j = 0; j <= RANGE_SAMPLES && result.sameResults; j++) {
+            double t = static_cast<double>(j)/RANGE_SAMPLES;
+            result.sameResults = covered(p1 + (p2 - p1)*t, nTrapezoids);
+        }
+    }
+
+    const cg3::Point2d halfViewport(0.05*BOUNDINGBOX, 0.05*BOUNDINGBOX);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nRanges; i++)
+        result.rectangleTrapezoids += gasprj::queryRectangleTrapezoids(
+                    cg3::BoundingBox2(queries[i] - halfViewport, queries[i] + halfViewport), trapMap, dag,
+                    idTrapezoids.data(), idTrapezoids.size());
+    result.rectangleTime = secondsSince(start);
+
+    for (size_t i = 0; i < nRanges && result.sameResults; i++) {
+        cg3::BoundingBox2 viewport(queries[i] - halfViewport, queries[i] + halfViewport);
+        size_t nTrapezoids = gasprj::queryRectangleTrapezoids(viewport, trapMap, dag,
+                                                              idTrapezoids.data(), idTrapezoids.size());
+        std::vector<size_t> sortedTrapezoids(idTrapezoids.begin(), idTrapezoids.begin() + nTrapezoids);
+        std::sort(sortedTrapezoids.begin(), sortedTrapezoids.end());
+        result.sameResults = std::adjacent_find(sortedTrapezoids.begin(), sortedTrapezoids.end()) ==
+                sortedTrapezoids.end();
+        for (size_t j = 0; j <= RANGE_SAMPLES && result.sameResults; j++) {
+            for (size_t k = 0; k <= RANGE_SAMPLES && result.sameResults; k++) {
+                cg3::Point2d point(std::max(-BOUNDINGBOX, std::min(BOUNDINGBOX,
+                                            viewport.min().x() + viewport.lengthX()*j/RANGE_SAMPLES)),
+                                   std::max(-BOUNDINGBOX, std::min(BOUNDINGBOX,
+                                            viewport.min().y() + viewport.lengthY()*k/RANGE_SAMPLES)));
+                result.sameResults = covered(point, nTrapezoids);
+            }
+        }
+    }
+    return result;
+}
+
+void print(std::ostream &out, const RangeResult &result)
+{
+    out << ", \"range\": {\"segment_s\": " << result.segmentTime
+        << ", \"segment_trapezoids\": " << result.segmentTrapezoids
+        << ", \"rectangle_s\": " << result.rectangleTime
+        << ", \"rectangle_trapezoids\": " << result.rectangleTrapezoids
+        << ", \"same_results\": " << jsonBool(result.sameResults) << "}";
+}
+
+//Uniform queries answered one by one by the DAG and by the frozen DAG after the cache-oblivious layout of the nodes
+//(which renumbers the nodes of the workload, so it runs after the other benchmarks)
+struct LayoutResult {
+    double layoutTime, dagTime, frozenTime;
+    bool sameResults;
+};
+
+LayoutResult benchmarkLayout(Workload &workload)
+{
+    LayoutResult result;
+    size_t nQueries = workload.queries.size();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    workload.dag.optimizeLayout(workload.trapMap);
+    result.layoutTime = secondsSince(start);
+
+    std::vector<size_t> dagResults(nQueries), frozenResults(nQueries);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nQueries; i++)
+        dagResults[i] = gasprj::queryTrapezoidalMap(workload.queries[i], workload.trapMap, workload.dag);
+    result.dagTime = secondsSince(start);
+
+    gasprj::FrozenDAG frozenDag(workload.dag, workload.dataset);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nQueries; i++)
+        frozenResults[i] = gasprj::queryTrapezoidalMap(workload.queries[i], frozenDag);
+    result.frozenTime = secondsSince(start);
+    result.sameResults = dagResults == workload.results && frozenResults == workload.results;
+    return result;
+}
+
+void print(std::ostream &out, const LayoutResult &result)
+{
+    out << ", \"layout\": {\"build_s\": " << result.layoutTime
+        << ", \"dag_loop_s\": " << result.dagTime
+        << ", \"frozen_loop_s\": " << result.frozenTime
+        << ", \"same_results\": " << jsonBool(result.sameResults) << "}";
+}
+
+//Size of the DAG and memory of the data structures
+struct SizeResult {
+    size_t nTrapezoids, nNodes;
+    gasprj::DAG::Statistics dagStatistics;
+    size_t dagBytes, trapezoidsBytes, datasetBytes;
+    long peakResidentKBytes;
+};
+
+SizeResult measureSize(Workload &workload)
+{
+    SizeResult result;
+    result.nTrapezoids = workload.trapMap.size();
+    result.nNodes = workload.dag.size();
+    result.dagStatistics = workload.dag.getStatistics();
+    result.dagBytes = workload.dag.getNodes().capacity()*sizeof(gasprj::DAG::Node);
+    result.trapezoidsBytes = workload.trapMap.size()*sizeof(gasprj::Trapezoid);
+    result.datasetBytes = workload.dataset.getPoints().capacity()*sizeof(cg3::Point2d) +
+                          workload.dataset.getIndexedSegments().capacity()*
+                          sizeof(TrapezoidalMapDataset::IndexedSegment2d);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peakResidentKBytes = usage.ru_maxrss;
+    return result;
+}
+
+void print(std::ostream &out, const SizeResult &result)
+{
+    out << ", \"trapezoids\": " << result.nTrapezoids
+        << ", \"dag\": {\"nodes\": " << result.nNodes
+        << ", \"x_nodes\": " << result.dagStatistics.nXNodes
+        << ", \"y_nodes\": " << result.dagStatistics.nYNodes
+        << ", \"leaves\": " << result.dagStatistics.nLeaves
+        << ", \"max_depth\": " << result.dagStatistics.maxDepth
+        << ", \"average_leaf_depth\": " << result.dagStatistics.averageLeafDepth << "}"
+        << ", \"memory_bytes\": {\"dag\": " << result.dagBytes
+        << ", \"trapezoids\": " << result.trapezoidsBytes
+        << ", \"dataset\": " << result.datasetBytes << "}"
+        << ", \"peak_rss_kb\": " << result.peakResidentKBytes;
+}
+
+
+
+//Run all the benchmarks of a workload, printing their results as a JSON object
+void run(const std::string &name, size_t nSegments, size_t nQueries, unsigned int seed, size_t gridResolution)
+{
+    Workload workload(name, nSegments, nQueries, seed);
+
+    std::cout << "{\"workload\": \"" << workload.name << "\""
+              << ", \"seed\": " << seed
+              << ", \"segments\": " << workload.segments.size()
+              << ", \"queries\": " << nQueries
+              << ", \"build_s\": " << workload.buildTime;
+    print(std::cout, benchmarkQueries(workload));
+    print(std::cout, benchmarkCoherent(workload));
+    if (gridResolution > 0)
+        print(std::cout, benchmarkGrid(workload, gridResolution));
+    print(std::cout, benchmarkBatch(workload));
+    print(std::cout, benchmarkSorted(workload));
+    print(std::cout, benchmarkParallel(workload));
+    print(std::cout, benchmarkConcurrent(workload));
+    print(std::cout, benchmarkRemoval(workload));
+    print(std::cout, benchmarkFaces(workload));
+    if (!workload.polygons.empty())
+        print(std::cout, benchmarkPolygons(workload));
+    print(std::cout, benchmarkRange(workload));
+    print(std::cout, benchmarkLayout(workload));
+    print(std::cout, measureSize(workload));
+    std::cout << "}" << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    size_t nSegments = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    size_t nQueries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+    unsigned int seed = argc > 3 ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+    std::string selectedWorkload = argc > 4 ? argv[4] : "";
+    size_t gridResolution = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 0;
+
+    const std::vector<std::string> workloads = {"uniform", "grid", "strips", "sorted", "polygons"};
+    if (!selectedWorkload.empty() && std::find(workloads.begin(), workloads.end(), selectedWorkload) == workloads.end()) {
+        std::cerr << "Unknown workload " << selectedWorkload << ": use uniform, grid, strips, sorted or polygons"
+                  << std::endl;
+        return 1;
+    }
+
+    for (const std::string &workload : workloads)
+        if (selectedWorkload.empty() || workload == selectedWorkload)
+            run(workload, nSegments, nQueries, seed, gridResolution);
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+# Benchmark of the point location: construction and queries of the trapezoidal map on synthetic workloads
+
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+QMAKE_CXXFLAGS += -O2
+DEFINES += NDEBUG
+
+CONFIG += CG3_CORE
+include (../cg3lib/cg3.pri)
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    point_location_benchmark.cpp \
+    ../algorithms/orientation.cpp \
+    ../algorithms/planar_point_location.cpp \
+    ../algorithms/point_locator.cpp \
+    ../data_structures/dag_grid.cpp \
+    ../data_structures/mapped_trapezoidalmap.cpp \
+    ../data_structures/segment_bvh.cpp \
+    ../data_structures/segment_intersection_checker.cpp \
+    ../data_structures/trapezoidalmap_dataset.cpp \
+    ../data_structures/trapezoidalmap_faces.cpp
+
+HEADERS += \
+    ../algorithms/orientation.h \
+    ../algorithms/planar_point_location.h \
+    ../algorithms/point_locator.h \
+    ../data_structures/chunked_array.h \
+    ../data_structures/chunked_array.tpp \
+    ../data_structures/concurrent_dag.h \
+    ../data_structures/concurrent_dag.tpp \
+    ../data_structures/dag.h \
+    ../data_structures/dag.tpp \
+    ../data_structures/dag_grid.h \
+    ../data_structures/dag_node.h \
+    ../data_structures/dag_node.tpp \
+    ../data_structures/frozen_dag.h \
+    ../data_structures/frozen_dag.tpp \
+    ../data_structures/mapped_trapezoidalmap.h \
+    ../data_structures/segment_bvh.h \
+    ../data_structures/segment_intersection_checker.h \
+    ../data_structures/trapezoid.h \
+    ../data_structures/trapezoid.tpp \
+    ../data_structures/trapezoidalmap.h \
+    ../data_structures/trapezoidalmap.tpp \
+    ../data_structures/trapezoidalmap_dataset.h \
+    ../data_structures/trapezoidalmap_faces.h
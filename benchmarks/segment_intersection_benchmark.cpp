@@ -0,0 +1,111 @@
+/*
+ * Benchmark of the segment intersection checker, comparing the flat BVH levels of SegmentIntersectionChecker against
+ * the pointer-based cg3 AABB tree it used to wrap, on the same random segments. Reports the time of the incremental
+ * insertion of the segments and of the check and count queries, and verifies that both give the same answers.
+ *
+ * Usage: segment_intersection_benchmark [number of segments] [number of queries] [seed]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <cg3/data_structures/trees/aabbtree.h>
+#include <cg3/geometry/segment2.h>
+
+#include "data_structures/segment_intersection_checker.h"
+
+namespace {
+
+typedef cg3::AABBTree<2, cg3::Segment2d> AABBTree;
+
+//Random segments with a bounded length, ordered as in the trapezoidal map dataset
+std::vector<cg3::Segment2d> randomSegments(size_t n, double radius, double maxLength, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> position(-radius, radius), length(-maxLength, maxLength);
+    std::vector<cg3::Segment2d> segments;
+    segments.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        cg3::Point2d p1(position(rng), position(rng));
+        cg3::Point2d p2(p1.x() + length(rng), p1.y() + length(rng));
+        segments.push_back(p2 < p1 ? cg3::Segment2d(p2, p1) : cg3::Segment2d(p1, p2));
+    }
+    return segments;
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    size_t nSegments = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    size_t nQueries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+    unsigned int seed = argc > 3 ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+
+    std::mt19937 rng(seed);
+    std::vector<cg3::Segment2d> segments = randomSegments(nSegments, 1e6, 1e3, rng);
+    std::vector<cg3::Segment2d> queries = randomSegments(nQueries, 1e6, 1e4, rng);
+
+    //Incremental insertion
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    AABBTree aabbTree(&SegmentIntersectionChecker::aabbValueExtractor);
+    for (const cg3::Segment2d &segment : segments)
+        aabbTree.insert(segment);
+    double treeInsertTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    SegmentIntersectionChecker checker;
+    for (const cg3::Segment2d &segment : segments)
+        checker.insert(segment);
+    double bvhInsertTime = secondsSince(start);
+
+    //Check queries
+    std::vector<char> treeChecks, bvhChecks;
+    treeChecks.reserve(nQueries);
+    bvhChecks.reserve(nQueries);
+
+    start = std::chrono::steady_clock::now();
+    for (const cg3::Segment2d &query : queries)
+        treeChecks.push_back(aabbTree.aabbOverlapCheck(query, &SegmentIntersectionChecker::checkSegmentIntersection));
+    double treeCheckTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (const cg3::Segment2d &query : queries)
+        bvhChecks.push_back(checker.checkIntersections(query));
+    double bvhCheckTime = secondsSince(start);
+
+    //Count queries
+    std::vector<size_t> treeCounts, bvhCounts;
+    treeCounts.reserve(nQueries);
+    bvhCounts.reserve(nQueries);
+
+    start = std::chrono::steady_clock::now();
+    for (const cg3::Segment2d &query : queries) {
+        std::vector<AABBTree::iterator> out;
+        aabbTree.aabbOverlapQuery(query, std::back_inserter(out), &SegmentIntersectionChecker::checkSegmentIntersection);
+        treeCounts.push_back(out.size());
+    }
+    double treeCountTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (const cg3::Segment2d &query : queries)
+        bvhCounts.push_back(checker.countIntersections(query));
+    double bvhCountTime = secondsSince(start);
+
+    bool sameResults = treeChecks == bvhChecks && treeCounts == bvhCounts;
+
+    std::cout << nSegments << " segments, " << nQueries << " queries, seed " << seed << std::endl;
+    std::cout << "                AABB tree     flat BVH" << std::endl;
+    std::cout << "insert (s)      " << treeInsertTime << "     " << bvhInsertTime << std::endl;
+    std::cout << "check (s)       " << treeCheckTime << "     " << bvhCheckTime << std::endl;
+    std::cout << "count (s)       " << treeCountTime << "     " << bvhCountTime << std::endl;
+    std::cout << "same results:   " << (sameResults ? "yes" : "NO") << std::endl;
+
+    return sameResults ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+# Benchmark of the segment intersection checker: flat BVH against the cg3 AABB tree
+
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+QMAKE_CXXFLAGS += -O2
+DEFINES += NDEBUG
+
+CONFIG += CG3_CORE
+include (../cg3lib/cg3.pri)
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    segment_intersection_benchmark.cpp \
+    ../data_structures/segment_bvh.cpp \
+    ../data_structures/segment_intersection_checker.cpp
+
+HEADERS += \
+    ../data_structures/segment_bvh.h \
+    ../data_structures/segment_intersection_checker.h
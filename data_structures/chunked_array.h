@@ -0,0 +1,58 @@
+#ifndef CHUNKED_ARRAY_H
+#define CHUNKED_ARRAY_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace gasprj {
+
+/**
+ * @brief An append-only array whose elements are never relocated
+ *
+ * The elements are stored in chunks of 2^CHUNK_BITS elements, allocated when the previous ones are full and listed in
+ * a table of chunk pointers allocated once for the maximum size, so an element stays at the same address until the
+ * array is cleared. A single writer can append elements while other threads read the elements published to them:
+ * the new elements and chunks are written before the release of the size, or of any other atomic publishing them.
+ */
+template <class T, size_t CHUNK_BITS = 16>
+class ChunkedArray
+{
+public:
+    /**
+     * @brief Number of elements of a chunk
+     */
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+
+    /**
+     * @brief Maximum number of elements (the indices fit in 30 bits)
+     */
+    static constexpr size_t MAX_SIZE = size_t(1) << 30;
+
+    /* Constructors */
+    ChunkedArray();
+    ~ChunkedArray();
+    ChunkedArray(const ChunkedArray &) = delete;
+    ChunkedArray &operator=(const ChunkedArray &) = delete;
+
+    /* Public methods */
+    const T &operator[](size_t id) const;
+    T &operator[](size_t id);
+    size_t size() const;
+
+    T &add();
+    void publish();
+    void clear();
+
+private:
+    /* Attributes */
+    std::vector<T*> chunks;            // Table of the chunks, never resized
+    size_t nElements;                  // Number of elements added by the writer
+    std::atomic<size_t> nPublished;    // Number of elements published to the readers
+};
+
+} // End namespace gasprj
+
+#include "chunked_array.tpp"
+
+#endif // CHUNKED_ARRAY_H
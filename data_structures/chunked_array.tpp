@@ -0,0 +1,94 @@
+#include "chunked_array.h"
+
+#include <cassert>
+
+namespace gasprj {
+
+/**
+ * @brief Default constructor of an empty chunked array
+ */
+template <class T, size_t CHUNK_BITS>
+inline ChunkedArray<T, CHUNK_BITS>::ChunkedArray() :
+    chunks(MAX_SIZE / CHUNK_SIZE, nullptr), nElements(0), nPublished(0)
+{
+}
+
+/**
+ * @brief Destructor of the chunked array, which deletes all the chunks
+ */
+template <class T, size_t CHUNK_BITS>
+inline ChunkedArray<T, CHUNK_BITS>::~ChunkedArray()
+{
+    clear();
+}
+
+/**
+ * @brief Get an element of the array
+ * @param[in] id Index of the element
+ * @return The specified element
+ */
+template <class T, size_t CHUNK_BITS>
+inline const T &ChunkedArray<T, CHUNK_BITS>::operator[](size_t id) const
+{
+    return chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+}
+
+/**
+ * @brief Get an element of the array (writer only)
+ * @param[in] id Index of the element
+ * @return The specified element
+ */
+template <class T, size_t CHUNK_BITS>
+inline T &ChunkedArray<T, CHUNK_BITS>::operator[](size_t id)
+{
+    assert(id < nElements);
+    return chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+}
+
+/**
+ * @brief Get the number of elements published to the readers
+ * @return The number of published elements
+ */
+template <class T, size_t CHUNK_BITS>
+inline size_t ChunkedArray<T, CHUNK_BITS>::size() const
+{
+    return nPublished.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Add a default-constructed element at the end of the array (writer only)
+ * @return The new element, to be filled before its publication
+ */
+template <class T, size_t CHUNK_BITS>
+inline T &ChunkedArray<T, CHUNK_BITS>::add()
+{
+    assert(nElements < MAX_SIZE);
+    T *&chunk = chunks[nElements >> CHUNK_BITS];
+    if (chunk == nullptr) chunk = new T[CHUNK_SIZE];
+    return chunk[nElements++ & (CHUNK_SIZE - 1)];
+}
+
+/**
+ * @brief Publish the elements added by the writer, so that the readers see them in the size (writer only)
+ */
+template <class T, size_t CHUNK_BITS>
+inline void ChunkedArray<T, CHUNK_BITS>::publish()
+{
+    nPublished.store(nElements, std::memory_order_release);
+}
+
+/**
+ * @brief Delete all the elements and the chunks (there must be no concurrent readers)
+ */
+template <class T, size_t CHUNK_BITS>
+inline void ChunkedArray<T, CHUNK_BITS>::clear()
+{
+    for (T *&chunk : chunks) {
+        delete[] chunk;
+        chunk = nullptr;
+    }
+    nElements = 0;
+    nPublished.store(0, std::memory_order_release);
+}
+
+} // End namespace gasprj
@@ -0,0 +1,97 @@
+#ifndef CONCURRENT_DAG_H
+#define CONCURRENT_DAG_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "data_structures/chunked_array.h"
+#include "data_structures/dag.h"
+#include "data_structures/frozen_dag.h"
+#include "data_structures/trapezoidalmap.h"
+
+namespace gasprj {
+
+/**
+ * @brief The copy of the DAG query data structure that can be queried while new segments are inserted
+ *
+ * The nodes are stored as in the frozen DAG (with the information needed by the query inline), in chunked arrays that
+ * never relocate them, and only one thread (the writer) updates them. The incremental step of the construction adds
+ * new nodes and overwrites the leaves of the crossed trapezoids: the new nodes are written first, unreachable by the
+ * queries, then every overwritten leaf is replaced with a single atomic store. A leaf keeps the ID of its trapezoid
+ * in the same word of its type, so the other fields of the new node can be written in place before the store, while
+ * the queries reading the leaf ignore them. The children of the overwritten leaves are new nodes only, so every query
+ * walks either the old or the new DAG below every leaf, and the queries (the readers) never wait for the writer.
+ *
+ * The queries return the ID of the trapezoid in the version of the DAG they walked: a query concurrent with the
+ * insertion of a segment can return the ID of a crossed trapezoid, which the insertion reuses for a new trapezoid, so
+ * the trapezoidal map cannot be read by the queries. Every leaf instead refers to a published copy of the segments and
+ * the points of its trapezoid, written before the leaf and never changed: the copy describes the trapezoid as it was
+ * in the version of the DAG walked by the query.
+ */
+class ConcurrentDAG
+{
+public:
+    /**
+     * @brief Maximum number of nodes (the two highest bits of the child indices are reserved to the node type)
+     */
+    static constexpr size_t MAX_NODES = FrozenDAG::MAX_NODES;
+
+    /**
+     * @brief The published copy of the trapezoid of a leaf, with the fields read by the queries
+     */
+    struct Leaf {
+        size_t idTrapezoid;               // ID of the trapezoid in the trapezoidal map, when the leaf was published
+        size_t idSegmentT, idSegmentB;    // Top and bottom segments (NO_ID for the sides of the bounding box)
+        size_t idPointL, idPointR;        // Left and right points (NO_ID for the sides of the bounding box)
+    };
+
+    /* Constructors */
+    ConcurrentDAG();
+    ConcurrentDAG(const DAG &dag, const TrapezoidalMap &trapMap);
+
+    /* Public methods */
+    FrozenDAG::Node getRoot() const;
+    FrozenDAG::Node getNode(size_t id) const;
+    const FrozenDAG::OrderedSegment &getSegment(size_t id) const;
+    const Leaf &getLeaf(size_t id) const;
+    size_t size() const;
+
+    void publish(const DAG &dag, const TrapezoidalMap &trapMap, const std::vector<size_t> &idOverwrittenNodes);
+    void reset(const DAG &dag, const TrapezoidalMap &trapMap);
+    void clear();
+
+private:
+    /**
+     * @brief A node stored in the concurrent DAG, which can be overwritten if it is a leaf
+     *
+     * The layout is the one of the frozen DAG node, with the type packed in the two highest bits of an atomic word,
+     * together with the left child (X-node and Y-node) or the index of the copy of the trapezoid (Leaf).
+     */
+    struct StoredNode {
+        std::atomic<uint32_t> tagId;
+        uint32_t idNodeR;
+        union {
+            double x;          // X-node: x-coordinate of the point
+            uint32_t idInfo;   // Y-node: index of the ordered segment
+        };
+    };
+
+    /* Private static constants */
+    static constexpr uint32_t TYPE_SHIFT = 30;
+    static constexpr uint32_t ID_MASK = (uint32_t(1) << TYPE_SHIFT) - 1;
+
+    /* Internal methods declaration */
+    uint32_t storeNode(const DAG::Node &dagNode, const TrapezoidalMap &trapMap, StoredNode &node);
+
+    /* Attributes */
+    ChunkedArray<StoredNode> nodes;                      // Nodes, with the same IDs of the DAG
+    ChunkedArray<FrozenDAG::OrderedSegment> segments;    // Segments, with the same IDs of the dataset
+    ChunkedArray<Leaf> leaves;                           // Copies of the trapezoids, one for every published leaf
+};
+
+} // End namespace gasprj
+
+#include "concurrent_dag.tpp"
+
+#endif // CONCURRENT_DAG_H
@@ -0,0 +1,195 @@
+#include "concurrent_dag.h"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace gasprj {
+
+/**
+ * @brief Default constructor of an empty concurrent DAG
+ */
+inline ConcurrentDAG::ConcurrentDAG() :
+    nodes(), segments(), leaves()
+{
+}
+
+/**
+ * @brief Constructor of a concurrent DAG as a copy of a DAG
+ * @param[in] dag The DAG to be copied
+ * @param[in] trapMap The trapezoidal map data structure of the DAG
+ */
+inline ConcurrentDAG::ConcurrentDAG(const DAG &dag, const TrapezoidalMap &trapMap)
+{
+    publish(dag, trapMap, std::vector<size_t>());
+}
+
+/**
+ * @brief Get the current version of the root of the concurrent DAG
+ * @return A copy of the root
+ */
+inline FrozenDAG::Node ConcurrentDAG::getRoot() const
+{
+    return getNode(0);
+}
+
+/**
+ * @brief Get the current version of a specific node of the concurrent DAG
+ * @param[in] id Index of the node
+ * @return A copy of the specified node, which stays consistent even if the node is overwritten in the meanwhile (the
+ * information of a leaf is the index of the copy of its trapezoid)
+ */
+inline FrozenDAG::Node ConcurrentDAG::getNode(size_t id) const
+{
+    const StoredNode &node = nodes[id];
+    uint32_t tagId = node.tagId.load(std::memory_order_acquire);
+    DAG::Node::Type type = static_cast<DAG::Node::Type>(tagId >> TYPE_SHIFT);
+    switch (type) {
+        case DAG::Node::Type::XNode:
+            return FrozenDAG::Node(type, tagId & ID_MASK, node.idNodeR, node.x, 0);
+        case DAG::Node::Type::YNode:
+            return FrozenDAG::Node(type, tagId & ID_MASK, node.idNodeR, 0, node.idInfo);
+        default:
+            return FrozenDAG::Node(type, 0, 0, 0, tagId & ID_MASK);
+    }
+}
+
+/**
+ * @brief Get a specific ordered segment of the concurrent DAG
+ * @param[in] id Index of the segment (the same of the trapezoidal map dataset)
+ * @return The specified segment, with the endpoints ordered by x-coordinate
+ */
+inline const FrozenDAG::OrderedSegment &ConcurrentDAG::getSegment(size_t id) const
+{
+    return segments[id];
+}
+
+/**
+ * @brief Get the published copy of the trapezoid of a leaf
+ * @param[in] id Index of the copy, the information of the leaf
+ * @return The copy of the trapezoid, never changed after the publication of the leaf
+ */
+inline const ConcurrentDAG::Leaf &ConcurrentDAG::getLeaf(size_t id) const
+{
+    return leaves[id];
+}
+
+/**
+ * @brief Get the number of nodes (internal and leaves) published in the concurrent DAG
+ * @return The number of nodes in the concurrent DAG
+ */
+inline size_t ConcurrentDAG::size() const
+{
+    return nodes.size();
+}
+
+/**
+ * @brief Publish the changes of the DAG since the last publication (writer only)
+ * @param[in] dag The DAG, changed only by incremental steps since the last publication
+ * @param[in] trapMap The trapezoidal map data structure of the DAG
+ * @param[in] idOverwrittenNodes The IDs of the leaves overwritten since the last publication
+ *
+ * Copy the new segments of the dataset and the new nodes of the DAG, with the copies of the trapezoids of the new
+ * leaves, then overwrite the leaves, one atomic store each. Throws std::overflow_error if the DAG has more than
+ * MAX_NODES nodes.
+ */
+inline void ConcurrentDAG::publish(const DAG &dag, const TrapezoidalMap &trapMap,
+                                   const std::vector<size_t> &idOverwrittenNodes)
+{
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+    const std::vector<DAG::Node> &dagNodes = dag.getNodes();
+    if (dagNodes.size() > MAX_NODES)
+        throw std::overflow_error("Too many nodes for the concurrent DAG");
+
+    // Copy the new segments ordering their endpoints
+    const std::vector<TrapezoidalMapDataset::IndexedSegment2d> &indexedSegments = trapMapData.getIndexedSegments();
+    for (size_t id = segments.size(); id < indexedSegments.size(); ++id) {
+        const cg3::Point2d &p1 = trapMapData.getPoint(indexedSegments[id].first);
+        const cg3::Point2d &p2 = trapMapData.getPoint(indexedSegments[id].second);
+        segments.add() = p1.x() < p2.x() ? FrozenDAG::OrderedSegment{p1, p2} : FrozenDAG::OrderedSegment{p2, p1};
+    }
+    segments.publish();
+
+    // Copy the new nodes, still unreachable by the queries
+    size_t idFirstNewNode = nodes.size();
+    for (size_t id = idFirstNewNode; id < dagNodes.size(); ++id) {
+        StoredNode &node = nodes.add();
+        node.tagId.store(storeNode(dagNodes[id], trapMap, node), std::memory_order_relaxed);
+    }
+    nodes.publish();
+
+    // Overwrite the leaves: the queries read the other fields only after the store of the new type
+    for (size_t id : idOverwrittenNodes) {
+        StoredNode &node = nodes[id];
+        assert(node.tagId.load(std::memory_order_relaxed) >> TYPE_SHIFT == static_cast<uint32_t>(DAG::Node::Type::Leaf));
+        assert(dagNodes[id].getType() == DAG::Node::Type::Leaf ||
+               (dagNodes[id].getIdNodeL() >= idFirstNewNode && dagNodes[id].getIdNodeR() >= idFirstNewNode));
+        node.tagId.store(storeNode(dagNodes[id], trapMap, node), std::memory_order_release);
+    }
+}
+
+/**
+ * @brief Replace the content of the concurrent DAG with a copy of a DAG (there must be no concurrent readers)
+ * @param[in] dag The DAG to be copied
+ * @param[in] trapMap The trapezoidal map data structure of the DAG
+ *
+ * Needed after the changes of the DAG other than the incremental steps (e.g. a new construction or layout).
+ */
+inline void ConcurrentDAG::reset(const DAG &dag, const TrapezoidalMap &trapMap)
+{
+    clear();
+    publish(dag, trapMap, std::vector<size_t>());
+}
+
+/**
+ * @brief Delete all the nodes and segments in the concurrent DAG (there must be no concurrent readers)
+ */
+inline void ConcurrentDAG::clear()
+{
+    nodes.clear();
+    segments.clear();
+    leaves.clear();
+}
+
+
+
+/* Internal methods declaration */
+
+/**
+ * @brief Store the fields of a node of the DAG other than the atomic word, with the information needed by the query
+ * @param[in] dagNode The node of the DAG
+ * @param[in] trapMap The trapezoidal map data structure of the DAG
+ * @param[out] node The stored node
+ * @return The atomic word of the node (the type and the left child or the index of the copy of the trapezoid), to be
+ * stored by the caller
+ *
+ * The copy of the trapezoid of a leaf is published before the return, so it is visible before the leaf.
+ */
+inline uint32_t ConcurrentDAG::storeNode(const DAG::Node &dagNode, const TrapezoidalMap &trapMap, StoredNode &node)
+{
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+    uint32_t id = 0;
+    switch (dagNode.getType()) {
+        case DAG::Node::Type::XNode:
+            id = static_cast<uint32_t>(dagNode.getIdNodeL());
+            node.idNodeR = static_cast<uint32_t>(dagNode.getIdNodeR());
+            node.x = trapMapData.getPoint(dagNode.getIdInfo()).x();
+            break;
+        case DAG::Node::Type::YNode:
+            id = static_cast<uint32_t>(dagNode.getIdNodeL());
+            node.idNodeR = static_cast<uint32_t>(dagNode.getIdNodeR());
+            node.idInfo = static_cast<uint32_t>(dagNode.getIdInfo());
+            break;
+        case DAG::Node::Type::Leaf: {
+            const Trapezoid &trapezoid = trapMap.getTrapezoid(dagNode.getIdInfo());
+            id = static_cast<uint32_t>(leaves.size());
+            leaves.add() = Leaf{dagNode.getIdInfo(), trapezoid.getIdSegmentT(), trapezoid.getIdSegmentB(),
+                                trapezoid.getIdPointL(), trapezoid.getIdPointR()};
+            leaves.publish();
+            break;
+        }
+    }
+    assert(id <= ID_MASK);
+    return (static_cast<uint32_t>(dagNode.getType()) << TYPE_SHIFT) | id;
+}
+
+} // End namespace gasprj
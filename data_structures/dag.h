@@ -5,11 +5,17 @@
 
 namespace gasprj {
 
+class TrapezoidalMap;
+
 /**
  * @brief The DAG query data structure
  *
  * This class defines a DAG data structure associated to a trapezoidal map to perform the point location queries. The
  * DAG (directed acyclic graph) is composed by a set of internal nodes (X and Y nodes) and leaves (trapezoids).
+ *
+ * The insertions only append nodes and overwrite leaves, so the IDs of the nodes stay valid. clear() and
+ * optimizeLayout() instead invalidate them, and increment the generation of the DAG: the data structures built on the
+ * IDs of the nodes (DAGGrid, PointLocator, FrozenDAG) record the generation to detect it.
  */
 class DAG
 {
@@ -17,6 +23,19 @@ public:
     /* Classes */
     class Node;
 
+    /**
+     * @brief Statistics about the shape of the DAG
+     *
+     * The depth of a node is the number of internal nodes in the longest path from the root to it.
+     */
+    struct Statistics {
+        size_t maxDepth;           // Depth of the deepest leaf
+        double averageLeafDepth;   // Average depth of the leaves
+        size_t nXNodes;            // Number of X-nodes
+        size_t nYNodes;            // Number of Y-nodes
+        size_t nLeaves;            // Number of leaves
+    };
+
     /* Constructors */
     DAG();
 
@@ -26,15 +45,24 @@ public:
 
     const std::vector<Node> &getNodes() const;
     size_t size();
+    size_t getGeneration() const;
+    size_t depth() const;
+    Statistics getStatistics() const;
 
+    void reserve(size_t n);
     void addNode(Node &node);
     void overwriteNode(Node &node, size_t id);
+    void optimizeLayout(TrapezoidalMap &trapMap);
 
     void clear();
 
 private:
+    /* Internal methods declaration */
+    void layoutSubtree(size_t idNode, size_t height, std::vector<size_t> &newIds, std::vector<size_t> &order) const;
+
     /* Attributes */
     std::vector<Node> nodes;
+    size_t generation;   // Incremented every time the IDs of the existing nodes are invalidated
 };
 
 } // End namespace gasprj
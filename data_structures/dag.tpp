@@ -1,8 +1,12 @@
 #include "dag.h"
 
+#include <algorithm>
 #include <cassert>
+#include <stdexcept>
+#include <utility>
 
 #include "trapezoid.h"
+#include "trapezoidalmap.h"
 
 namespace gasprj {
 
@@ -10,7 +14,7 @@ namespace gasprj {
  * @brief Default constructor of a DAG
  */
 inline DAG::DAG() :
-    nodes()
+    nodes(), generation(0)
 {
 }
 
@@ -46,10 +50,13 @@ inline const std::vector<DAG::Node> &DAG::getNodes() const
  * @brief Add a new node in the DAG
  * @param node New node
  *
- * Perform an insertion in the back of the vector of nodes
+ * Perform an insertion in the back of the vector of nodes. Throws std::overflow_error if the ID of the new node would
+ * not fit in the DAG leaf references of the trapezoids.
  */
 inline void DAG::addNode(DAG::Node &node)
 {
+    if (nodes.size() > Trapezoid::MAX_ID)
+        throw std::overflow_error("Too many nodes for the index type of the trapezoids");
     nodes.push_back(node);
 }
 
@@ -73,12 +80,191 @@ inline size_t DAG::size()
     return nodes.size();
 }
 
+/**
+ * @brief Get the generation of the DAG
+ * @return The number of times the IDs of the nodes have been invalidated by clear() or optimizeLayout()
+ */
+inline size_t DAG::getGeneration() const
+{
+    return generation;
+}
+
+/**
+ * @brief Get the depth of the DAG
+ * @return The number of internal nodes in the longest path from the root to a leaf
+ */
+inline size_t DAG::depth() const
+{
+    return getStatistics().maxDepth;
+}
+
+/**
+ * @brief Compute the statistics about the shape of the DAG
+ * @return The depth of the deepest leaf, the average depth of the leaves and the number of nodes of every type
+ *
+ * A node can be reached through several paths, so the depths are computed following a topological order of the nodes
+ * (the reverse of the post-order of a depth-first visit from the root), relaxing the depth of the children of every
+ * node. Takes linear time in the size of the DAG.
+ */
+inline DAG::Statistics DAG::getStatistics() const
+{
+    Statistics statistics = {0, 0, 0, 0, 0};
+    if (nodes.empty()) return statistics;
+
+    // Post-order of the nodes, computed through a depth-first visit with an explicit stack
+    std::vector<size_t> postOrder;
+    postOrder.reserve(nodes.size());
+    std::vector<bool> visited(nodes.size(), false);
+    std::vector<std::pair<size_t, bool>> stack(1, std::make_pair(size_t(0), false));
+    while (!stack.empty()) {
+        std::pair<size_t, bool> item = stack.back();
+        stack.pop_back();
+        // All the children of the node have been visited
+        if (item.second) {
+            postOrder.push_back(item.first);
+            continue;
+        }
+        if (visited[item.first]) continue;
+        visited[item.first] = true;
+        stack.push_back(std::make_pair(item.first, true));
+        const Node &node = nodes[item.first];
+        if (node.getType() != Node::Type::Leaf) {
+            if (!visited[node.getIdNodeR()]) stack.push_back(std::make_pair(node.getIdNodeR(), false));
+            if (!visited[node.getIdNodeL()]) stack.push_back(std::make_pair(node.getIdNodeL(), false));
+        }
+    }
+
+    // Relax the depths following the topological order
+    std::vector<size_t> nodeDepths(nodes.size(), 0);
+    size_t totalLeafDepth = 0;
+    for (std::vector<size_t>::const_reverse_iterator it = postOrder.rbegin(); it != postOrder.rend(); ++it) {
+        const Node &node = nodes[*it];
+        switch (node.getType()) {
+            case Node::Type::XNode:
+            case Node::Type::YNode:
+                node.getType() == Node::Type::XNode ? ++statistics.nXNodes : ++statistics.nYNodes;
+                nodeDepths[node.getIdNodeL()] = std::max(nodeDepths[node.getIdNodeL()], nodeDepths[*it]+1);
+                nodeDepths[node.getIdNodeR()] = std::max(nodeDepths[node.getIdNodeR()], nodeDepths[*it]+1);
+                break;
+            case Node::Type::Leaf:
+                ++statistics.nLeaves;
+                totalLeafDepth += nodeDepths[*it];
+                statistics.maxDepth = std::max(statistics.maxDepth, nodeDepths[*it]);
+                break;
+        }
+    }
+    statistics.averageLeafDepth = static_cast<double>(totalLeafDepth) / statistics.nLeaves;
+
+    return statistics;
+}
+
+/**
+ * @brief Reserve space for the nodes of the DAG
+ * @param[in] n The total number of nodes the DAG should be able to store without reallocating
+ */
+inline void DAG::reserve(size_t n)
+{
+    nodes.reserve(n);
+}
+
+/**
+ * @brief Renumber the nodes of the DAG in a cache-oblivious order
+ * @param[in,out] trapMap The trapezoidal map associated to the DAG, whose references to the leaves are updated
+ *
+ * The incremental construction appends the new nodes and turns the leaves of the crossed trapezoids into internal
+ * nodes in place, so the nodes visited by a query end up scattered over the whole vector. This method lays out the
+ * nodes in the van Emde Boas order: the top half of the levels of the DAG is stored first (recursively in the same
+ * order), followed by the subgraphs hanging from it, each stored contiguously (again recursively). A query then visits
+ * O(log_B n) blocks of B nodes for every block size B, whatever the size of the cache lines and of the pages.
+ *
+ * A node reached through several paths is stored with the first subgraph reaching it. The root is still the first
+ * node, and the new nodes added by the following insertions are appended as usual. The IDs of the nodes change, so the
+ * data structures built on them (a DAGGrid, a FrozenDAG) must be built again: the generation of the DAG is
+ * incremented. Takes O(n log n) time in the size n of the DAG.
+ */
+inline void DAG::optimizeLayout(TrapezoidalMap &trapMap)
+{
+    if (nodes.empty()) return;
+
+    // New order of the nodes (the levels of the DAG are one more than its depth). NO_ID is copied, since the
+    // vector takes the fill value by reference and the constant has no definition out of the class
+    const size_t noId = Node::NO_ID;
+    std::vector<size_t> newIds(nodes.size(), noId);
+    std::vector<size_t> order;
+    order.reserve(nodes.size());
+    layoutSubtree(0, depth()+1, newIds, order);
+
+    // Nodes unreachable from the root (none after a regular construction) are kept at the end
+    for (size_t id = 0; id < nodes.size(); ++id) {
+        if (newIds[id] == Node::NO_ID) {
+            newIds[id] = order.size();
+            order.push_back(id);
+        }
+    }
+
+    // Move the nodes, updating the references to the children and the references of the trapezoids to the leaves
+    std::vector<Node> newNodes;
+    newNodes.reserve(nodes.capacity());
+    for (size_t id : order) {
+        Node node = nodes[id];
+        if (node.getType() == Node::Type::Leaf) {
+            trapMap.getTrapezoid(node.getIdInfo()).setIdDagLeaf(newNodes.size());
+        }
+        else {
+            node.setIdNodeL(newIds[node.getIdNodeL()]);
+            node.setIdNodeR(newIds[node.getIdNodeR()]);
+        }
+        newNodes.push_back(node);
+    }
+    nodes.swap(newNodes);
+    ++generation;
+}
+
+/**
+ * @brief Assign the new IDs to the nodes of a subgraph, in the van Emde Boas order
+ * @param[in] idNode The root of the subgraph
+ * @param[in] height The number of levels of the subgraph to lay out
+ * @param[in,out] newIds The new ID of every node (NO_ID for the nodes not yet placed)
+ * @param[in,out] order The nodes in the new order
+ *
+ * The top ceil(height/2) levels are laid out first, then the subgraphs rooted at the children of the top nodes that
+ * have not been placed yet, each with the remaining levels.
+ */
+inline void DAG::layoutSubtree(size_t idNode, size_t height, std::vector<size_t> &newIds,
+                               std::vector<size_t> &order) const
+{
+    if (newIds[idNode] != Node::NO_ID) return;
+    if (height <= 1) {
+        newIds[idNode] = order.size();
+        order.push_back(idNode);
+        return;
+    }
+
+    // Top levels
+    size_t topHeight = (height+1) / 2;
+    size_t first = order.size();
+    layoutSubtree(idNode, topHeight, newIds, order);
+    size_t last = order.size();
+
+    // Bottom subgraphs, from left to right
+    for (size_t i = first; i < last; ++i) {
+        const Node &node = nodes[order[i]];
+        if (node.getType() != Node::Type::Leaf) {
+            layoutSubtree(node.getIdNodeL(), height - topHeight, newIds, order);
+            layoutSubtree(node.getIdNodeR(), height - topHeight, newIds, order);
+        }
+    }
+}
+
 /**
  * @brief Delete all the nodes in the DAG
+ *
+ * The generation of the DAG is incremented, since the IDs of the old nodes are reused by the new ones.
  */
 inline void DAG::clear()
 {
     nodes.clear();
+    ++generation;
 }
 
 } // End namespace gasprj
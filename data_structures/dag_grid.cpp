@@ -0,0 +1,239 @@
+#include "dag_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "algorithms/orientation.h"
+
+namespace gasprj {
+
+/**
+ * @brief Default constructor of a grid index, with no cells (all the queries start from the root)
+ */
+DAGGrid::DAGGrid() :
+    boundingBox(cg3::Point2d(0, 0), cg3::Point2d(0, 0)),
+    resolution(0), cellWidth(0), cellHeight(0), dagGeneration(0)
+{
+}
+
+/**
+ * @brief Constructor of a grid index over a DAG
+ * @param[in] dag The DAG query data structure
+ * @param[in] trapMap The trapezoidal map data structure of the DAG
+ * @param[in] resolution The number of cells along each side of the bounding box
+ * @param[in] memoryBudget The maximum memory of the cells, in bytes
+ */
+DAGGrid::DAGGrid(const DAG &dag, const TrapezoidalMap &trapMap, size_t resolution, size_t memoryBudget) :
+    DAGGrid()
+{
+    build(dag, trapMap, resolution, memoryBudget);
+}
+
+/**
+ * @brief Get the node where the query of a point starts
+ * @param[in] point The query point
+ * @return The ID of the node stored in the cell containing the point, the root (0) if the point lies outside the
+ * bounding box or the grid is empty
+ */
+size_t DAGGrid::getIdStartNode(const cg3::Point2d &point) const
+{
+    if (resolution == 0 ||
+            !(point.x() >= boundingBox.min().x() && point.x() <= boundingBox.max().x() &&
+              point.y() >= boundingBox.min().y() && point.y() <= boundingBox.max().y()))
+        return 0;
+
+    // Cell indices, corrected for the rounding errors so that the point lies inside the cell used by the build
+    size_t i = std::min(static_cast<size_t>((point.x() - boundingBox.min().x()) / cellWidth), resolution-1);
+    size_t j = std::min(static_cast<size_t>((point.y() - boundingBox.min().y()) / cellHeight), resolution-1);
+    if (i > 0 && point.x() < cellX(i)) --i;
+    else if (i+1 < resolution && point.x() > cellX(i+1)) ++i;
+    if (j > 0 && point.y() < cellY(j)) --j;
+    else if (j+1 < resolution && point.y() > cellY(j+1)) ++j;
+
+    return cells[j*resolution + i];
+}
+
+/**
+ * @brief Check if the grid can be used with a DAG
+ * @param[in] dag The DAG query data structure
+ * @return True if the IDs of the nodes stored in the cells are still valid for the DAG, false if the DAG has been
+ * cleared or its nodes renumbered after the last build() or update()
+ */
+bool DAGGrid::isValid(const DAG &dag) const
+{
+    return dagGeneration == dag.getGeneration();
+}
+
+/**
+ * @brief Get the number of cells along each side of the bounding box
+ * @return The resolution of the grid
+ */
+size_t DAGGrid::getResolution() const
+{
+    return resolution;
+}
+
+/**
+ * @brief Get the memory used by the cells
+ * @return The memory used by the cells, in bytes
+ */
+size_t DAGGrid::memory() const
+{
+    return cells.capacity()*sizeof(size_t);
+}
+
+/**
+ * @brief Check if the grid has no cells
+ * @return True if the grid has no cells, false otherwise
+ */
+bool DAGGrid::isEmpty() const
+{
+    return resolution == 0;
+}
+
+/**
+ * @brief Build the grid index over a DAG
+ * @param[in] dag The DAG query data structure
+ * @param[in] trapMap The trapezoidal map data structure of the DAG
+ * @param[in] resolution The number of cells along each side of the bounding box
+ * @param[in] memoryBudget The maximum memory of the cells, in bytes
+ *
+ * The resolution is reduced so that the cells fit in the memory budget. Every cell descends the DAG from the root as
+ * long as all its points take the same branch, so the build takes O(r^2 d) time, with r the resolution and d the
+ * depth of the DAG.
+ */
+void DAGGrid::build(const DAG &dag, const TrapezoidalMap &trapMap, size_t resolution, size_t memoryBudget)
+{
+    clear();
+
+    size_t maxResolution = static_cast<size_t>(std::sqrt(static_cast<double>(memoryBudget / sizeof(size_t))));
+    this->resolution = std::min(resolution, maxResolution);
+    if (this->resolution == 0 || dag.getNodes().empty()) {
+        this->resolution = 0;
+        return;
+    }
+
+    boundingBox = trapMap.getBoundingBox();
+    cellWidth = (boundingBox.max().x() - boundingBox.min().x()) / this->resolution;
+    cellHeight = (boundingBox.max().y() - boundingBox.min().y()) / this->resolution;
+    cells.assign(this->resolution*this->resolution, 0);
+    dagGeneration = dag.getGeneration();
+
+    update(dag, trapMap);
+}
+
+/**
+ * @brief Deepen the cells after the insertion of new segments in the trapezoidal map and DAG
+ * @param[in] dag The DAG query data structure
+ * @param[in] trapMap The trapezoidal map data structure of the DAG
+ *
+ * Call this method after addSegmentToTrapezoidalMap(): the cells whose node has been split by the new segments
+ * continue the descent from it. Skipping the call after the insertions only makes the queries start from shallower
+ * nodes. If the DAG has been cleared or its nodes renumbered (rebuildDegradedTrapezoidalMap(),
+ * compactTrapezoidalMap(), DAG::optimizeLayout()), the IDs stored in the cells are meaningless: the grid is built again
+ * from the root, with the same resolution.
+ */
+void DAGGrid::update(const DAG &dag, const TrapezoidalMap &trapMap)
+{
+    if (!isValid(dag)) {
+        size_t resolution = this->resolution;
+        build(dag, trapMap, resolution, resolution*resolution*sizeof(size_t));
+        return;
+    }
+
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+    for (size_t j = 0; j < resolution; ++j)
+        for (size_t i = 0; i < resolution; ++i)
+            cells[j*resolution + i] = descend(cells[j*resolution + i], i, j, dag, trapMapData);
+}
+
+/**
+ * @brief Remove all the cells: all the queries start from the root
+ */
+void DAGGrid::clear()
+{
+    boundingBox = cg3::BoundingBox2(cg3::Point2d(0, 0), cg3::Point2d(0, 0));
+    resolution = 0;
+    cellWidth = cellHeight = 0;
+    dagGeneration = 0;
+    cells.clear();
+    cells.shrink_to_fit();
+}
+
+
+
+/* Internal methods implementation */
+
+/**
+ * @brief Descend the DAG with all the points of a cell, as long as they take the same branch
+ * @param[in] idNode The ID of the node where the descent starts
+ * @param[in] i,j The column and the row of the cell
+ * @param[in] dag The DAG query data structure
+ * @param[in] trapMapData The trapezoidal map dataset
+ * @return The ID of the deepest node reached by all the points of the cell
+ *
+ * The comparisons follow the query: a point on the vertical extension of an endpoint goes right, a point on the line of
+ * a segment goes below. Since the cell is convex, all its points lie on the same side of a line if its corners do.
+ */
+size_t DAGGrid::descend(size_t idNode, size_t i, size_t j, const DAG &dag,
+                        const TrapezoidalMapDataset &trapMapData) const
+{
+    const double x0 = cellX(i), x1 = cellX(i+1), y0 = cellY(j), y1 = cellY(j+1);
+
+    while (true) {
+        const DAG::Node &node = dag.getNode(idNode);
+        switch (node.getType()) {
+            // Point-Endpoint comparison
+            case DAG::Node::Type::XNode: {
+                double x = trapMapData.getPoint(node.getIdInfo()).x();
+                if (x1 < x) idNode = node.getIdNodeL();
+                else if (x0 >= x) idNode = node.getIdNodeR();
+                else return idNode;
+                break;
+            }
+            // Point-Segment comparison
+            case DAG::Node::Type::YNode: {
+                const TrapezoidalMapDataset::IndexedSegment2d &segment = trapMapData.getIndexedSegment(node.getIdInfo());
+                cg3::Point2d p1 = trapMapData.getPoint(segment.first), p2 = trapMapData.getPoint(segment.second);
+                if (p1.x() > p2.x()) std::swap(p1, p2);
+                int position00 = orientation(p1.x(), p1.y(), p2.x(), p2.y(), x0, y0);
+                int position10 = orientation(p1.x(), p1.y(), p2.x(), p2.y(), x1, y0);
+                int position01 = orientation(p1.x(), p1.y(), p2.x(), p2.y(), x0, y1);
+                int position11 = orientation(p1.x(), p1.y(), p2.x(), p2.y(), x1, y1);
+                if (position00 > 0 && position10 > 0 && position01 > 0 && position11 > 0)
+                    idNode = node.getIdNodeL();
+                else if (position00 <= 0 && position10 <= 0 && position01 <= 0 && position11 <= 0)
+                    idNode = node.getIdNodeR();
+                else
+                    return idNode;
+                break;
+            }
+            // The cell lies inside a single trapezoid
+            default: {
+                return idNode;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Get the x-coordinate of the left side of a column of cells
+ * @param[in] i The column (resolution for the right side of the bounding box)
+ * @return The x-coordinate of the left side of the column
+ */
+double DAGGrid::cellX(size_t i) const
+{
+    return i == resolution ? boundingBox.max().x() : boundingBox.min().x() + i*cellWidth;
+}
+
+/**
+ * @brief Get the y-coordinate of the bottom side of a row of cells
+ * @param[in] j The row (resolution for the top side of the bounding box)
+ * @return The y-coordinate of the bottom side of the row
+ */
+double DAGGrid::cellY(size_t j) const
+{
+    return j == resolution ? boundingBox.max().y() : boundingBox.min().y() + j*cellHeight;
+}
+
+} // End namespace gasprj
@@ -0,0 +1,70 @@
+#ifndef DAG_GRID_H
+#define DAG_GRID_H
+
+#include <vector>
+
+#include <cg3/geometry/bounding_box2.h>
+#include <cg3/geometry/point2.h>
+
+#include "data_structures/dag.h"
+#include "data_structures/trapezoidalmap.h"
+
+namespace gasprj {
+
+/**
+ * @brief The uniform grid index over the DAG query data structure
+ *
+ * This class divides the bounding box of a trapezoidal map in a uniform grid of cells, and stores for every cell the
+ * deepest DAG node reached by all the points of the cell: the queries of the points in the cell start from it instead
+ * of the root, skipping the top levels of the DAG. If the cell lies inside a single trapezoid, the node is its leaf
+ * and the query needs no comparison at all. The skipped levels are the ones that stay in the cache, though: on uniform
+ * queries issued in a tight loop the grid saves little over the plain descent, so it is only used when built
+ * explicitly.
+ *
+ * The grid stays valid when segments are added to the trapezoidal map, since the leaves of the crossed trapezoids are
+ * overwritten in place by the roots of their sub-graphs: update() deepens the cells again after the insertions. The
+ * grid records the generation of the DAG, so it detects when the IDs of the nodes are invalidated (the DAG is cleared,
+ * rebuilt, compacted or laid out again): update() then builds the grid again, and the queries ignore a stale grid.
+ */
+class DAGGrid
+{
+public:
+    /**
+     * @brief Default maximum memory of the cells, in bytes
+     */
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 16 << 20;
+
+    /* Constructors */
+    DAGGrid();
+    DAGGrid(const DAG &dag, const TrapezoidalMap &trapMap, size_t resolution,
+            size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+
+    /* Public methods */
+    size_t getIdStartNode(const cg3::Point2d &point) const;
+    bool isValid(const DAG &dag) const;
+    size_t getResolution() const;
+    size_t memory() const;
+    bool isEmpty() const;
+
+    void build(const DAG &dag, const TrapezoidalMap &trapMap, size_t resolution,
+               size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+    void update(const DAG &dag, const TrapezoidalMap &trapMap);
+    void clear();
+
+private:
+    /* Internal methods declaration */
+    size_t descend(size_t idNode, size_t i, size_t j, const DAG &dag, const TrapezoidalMapDataset &trapMapData) const;
+    double cellX(size_t i) const;
+    double cellY(size_t j) const;
+
+    /* Attributes */
+    cg3::BoundingBox2 boundingBox;
+    size_t resolution;
+    double cellWidth, cellHeight;
+    size_t dagGeneration;
+    std::vector<size_t> cells;   // IDs of the start nodes, by row
+};
+
+} // End namespace gasprj
+
+#endif // DAG_GRID_H
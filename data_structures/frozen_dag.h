@@ -0,0 +1,105 @@
+#ifndef FROZEN_DAG_H
+#define FROZEN_DAG_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <cg3/geometry/point2.h>
+
+#include "data_structures/dag.h"
+#include "data_structures/trapezoidalmap_dataset.h"
+
+namespace gasprj {
+
+/**
+ * @brief The frozen (read-only) version of the DAG query data structure
+ *
+ * This class defines a compact copy of a DAG, optimized for the point location queries and not modifiable anymore.
+ * Every node takes 16 bytes: two 32-bit child indices, with the type of the node packed in the two highest bits of
+ * the left one, and the information needed by the query stored inline in the node:
+ *  - X-node, the x-coordinate of the point;
+ *  - Y-node, the index of the segment in the array of ordered segments of the frozen DAG;
+ *  - Leaf, the ID of the trapezoid.
+ * The segments are copied from the dataset with their endpoints ordered by x-coordinate, so that the query does not
+ * need to access the trapezoidal map dataset.
+ *
+ * The frozen DAG is a snapshot: the following changes of the DAG (incremental steps, compactions, rebuilds) are not
+ * reflected, and the IDs of the trapezoids it returns may no longer refer to the same trapezoids. It records the
+ * generation and the size of the DAG, so isValid() tells if it must be frozen again.
+ */
+class FrozenDAG
+{
+public:
+    /* Classes */
+    class Node;
+
+    /**
+     * @brief A segment with the endpoints ordered by x-coordinate
+     */
+    struct OrderedSegment {
+        cg3::Point2d p1, p2;
+    };
+
+    /**
+     * @brief Maximum number of nodes (the two highest bits of the child indices are reserved to the node type)
+     */
+    static constexpr size_t MAX_NODES = (size_t(1) << 30) - 1;
+
+    /* Constructors */
+    FrozenDAG();
+    FrozenDAG(const DAG &dag, const TrapezoidalMapDataset &trapMapData);
+
+    /* Public methods */
+    const Node &getRoot() const;
+    const Node &getNode(size_t id) const;
+    const OrderedSegment &getSegment(size_t id) const;
+    size_t size() const;
+    bool isValid(const DAG &dag) const;
+
+    void freeze(const DAG &dag, const TrapezoidalMapDataset &trapMapData);
+    void clear();
+
+private:
+    /* Attributes */
+    std::vector<Node> nodes;
+    std::vector<OrderedSegment> segments;
+    size_t dagGeneration, dagSize;    // Generation and size of the DAG when frozen
+};
+
+/**
+ * @brief The internal node or leaf of a frozen DAG
+ */
+class FrozenDAG::Node
+{
+public:
+    /* Constructors */
+    Node();
+    Node(DAG::Node::Type type, uint32_t idNodeL, uint32_t idNodeR, double x, uint32_t idInfo);
+
+    /* Getters */
+    DAG::Node::Type getType() const;
+    bool isLeaf() const;
+    uint32_t getIdNodeL() const;
+    uint32_t getIdNodeR() const;
+    double getX() const;
+    uint32_t getIdInfo() const;
+
+private:
+    /* Private static constants */
+    static constexpr uint32_t TYPE_SHIFT = 30;
+    static constexpr uint32_t ID_MASK = (uint32_t(1) << TYPE_SHIFT) - 1;
+
+    /* Attributes */
+    uint32_t tagIdNodeL, idNodeR;
+    union {
+        double x;          // X-node: x-coordinate of the point
+        uint32_t idInfo;   // Y-node: index of the ordered segment, Leaf: ID of the trapezoid
+    };
+};
+
+} // End namespace gasprj
+
+#include "frozen_dag.tpp"
+
+#endif // FROZEN_DAG_H
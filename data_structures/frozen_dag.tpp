@@ -0,0 +1,216 @@
+#include "frozen_dag.h"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace gasprj {
+
+/**
+ * @brief Default constructor of a frozen DAG
+ */
+inline FrozenDAG::FrozenDAG() :
+    nodes(), segments(), dagGeneration(0), dagSize(0)
+{
+}
+
+/**
+ * @brief Constructor of a frozen DAG as a copy of a DAG
+ * @param[in] dag The DAG to be copied
+ * @param[in] trapMapData The trapezoidal map dataset referenced by the DAG
+ */
+inline FrozenDAG::FrozenDAG(const DAG &dag, const TrapezoidalMapDataset &trapMapData)
+{
+    freeze(dag, trapMapData);
+}
+
+/**
+ * @brief Get the root of the frozen DAG
+ * @return The first node of the frozen DAG
+ */
+inline const FrozenDAG::Node &FrozenDAG::getRoot() const
+{
+    return nodes[0];
+}
+
+/**
+ * @brief Get a specific node of the frozen DAG
+ * @param[in] id Index of the node
+ * @return The specified node of the frozen DAG
+ */
+inline const FrozenDAG::Node &FrozenDAG::getNode(size_t id) const
+{
+    return nodes[id];
+}
+
+/**
+ * @brief Get a specific ordered segment of the frozen DAG
+ * @param[in] id Index of the segment (the same of the trapezoidal map dataset)
+ * @return The specified segment, with the endpoints ordered by x-coordinate
+ */
+inline const FrozenDAG::OrderedSegment &FrozenDAG::getSegment(size_t id) const
+{
+    return segments[id];
+}
+
+/**
+ * @brief Get the number of nodes (internal and leaves) composing the frozen DAG
+ * @return The number of nodes in the frozen DAG
+ */
+inline size_t FrozenDAG::size() const
+{
+    return nodes.size();
+}
+
+/**
+ * @brief Check if the frozen DAG is still a copy of a DAG
+ * @param[in] dag The DAG query data structure
+ * @return True if the DAG has not changed since the last freeze(), false if segments have been added or removed, or
+ * the DAG has been cleared, rebuilt or laid out again
+ *
+ * The incremental steps only append nodes to the DAG, the other changes increment its generation.
+ */
+inline bool FrozenDAG::isValid(const DAG &dag) const
+{
+    return !nodes.empty() && dagGeneration == dag.getGeneration() && dagSize == dag.getNodes().size();
+}
+
+/**
+ * @brief Replace the content of the frozen DAG with a copy of a DAG
+ * @param[in] dag The DAG to be copied
+ * @param[in] trapMapData The trapezoidal map dataset referenced by the DAG
+ *
+ * The node indices of the DAG are preserved, so the DAG leaves referenced by the trapezoids are still valid. Throws
+ * std::overflow_error if the DAG has more than MAX_NODES nodes.
+ */
+inline void FrozenDAG::freeze(const DAG &dag, const TrapezoidalMapDataset &trapMapData)
+{
+    const std::vector<DAG::Node> &dagNodes = dag.getNodes();
+    if (dagNodes.size() > MAX_NODES)
+        throw std::overflow_error("Too many nodes for the frozen DAG");
+
+    // Copy the segments ordering their endpoints
+    segments.clear();
+    segments.reserve(trapMapData.getIndexedSegments().size());
+    for (const TrapezoidalMapDataset::IndexedSegment2d &indexedSegment : trapMapData.getIndexedSegments()) {
+        const cg3::Point2d &p1 = trapMapData.getPoint(indexedSegment.first);
+        const cg3::Point2d &p2 = trapMapData.getPoint(indexedSegment.second);
+        if (p1.x() < p2.x()) segments.push_back({p1, p2});
+        else segments.push_back({p2, p1});
+    }
+
+    // Copy the nodes, storing inline the information needed by the query
+    nodes.clear();
+    nodes.reserve(dagNodes.size());
+    for (const DAG::Node &dagNode : dagNodes) {
+        switch (dagNode.getType()) {
+            case DAG::Node::Type::XNode:
+                nodes.push_back(Node(DAG::Node::Type::XNode, dagNode.getIdNodeL(), dagNode.getIdNodeR(),
+                                     trapMapData.getPoint(dagNode.getIdInfo()).x(), 0));
+                break;
+            case DAG::Node::Type::YNode:
+                nodes.push_back(Node(DAG::Node::Type::YNode, dagNode.getIdNodeL(), dagNode.getIdNodeR(),
+                                     0, dagNode.getIdInfo()));
+                break;
+            case DAG::Node::Type::Leaf:
+                nodes.push_back(Node(DAG::Node::Type::Leaf, 0, 0, 0, dagNode.getIdInfo()));
+                break;
+        }
+    }
+    dagGeneration = dag.getGeneration();
+    dagSize = dagNodes.size();
+}
+
+/**
+ * @brief Delete all the nodes and segments in the frozen DAG
+ */
+inline void FrozenDAG::clear()
+{
+    nodes.clear();
+    segments.clear();
+    dagGeneration = 0;
+    dagSize = 0;
+}
+
+
+
+/**
+ * @brief Default constructor of a frozen DAG node
+ */
+inline FrozenDAG::Node::Node() :
+    tagIdNodeL(0), idNodeR(0), x(0)
+{
+}
+
+/**
+ * @brief Constructor of a frozen DAG node
+ * @param[in] type Type of the node
+ * @param[in] idNodeL Index of the left child
+ * @param[in] idNodeR Index of the right child
+ * @param[in] x The x-coordinate of the point (X-node only)
+ * @param[in] idInfo The index of the segment (Y-node) or the ID of the trapezoid (Leaf)
+ */
+inline FrozenDAG::Node::Node(DAG::Node::Type type, uint32_t idNodeL, uint32_t idNodeR, double x, uint32_t idInfo) :
+    tagIdNodeL((static_cast<uint32_t>(type) << TYPE_SHIFT) | idNodeL), idNodeR(idNodeR)
+{
+    assert(idNodeL <= ID_MASK && idNodeR <= ID_MASK);
+    if (type == DAG::Node::Type::XNode) this->x = x;
+    else this->idInfo = idInfo;
+}
+
+/**
+ * @brief Get the type of the node
+ * @return Type of the node
+ */
+inline DAG::Node::Type FrozenDAG::Node::getType() const
+{
+    return static_cast<DAG::Node::Type>(tagIdNodeL >> TYPE_SHIFT);
+}
+
+/**
+ * @brief Check if the node is a leaf
+ * @return True if the node is a leaf, false otherwise
+ */
+inline bool FrozenDAG::Node::isLeaf() const
+{
+    return getType() == DAG::Node::Type::Leaf;
+}
+
+/**
+ * @brief Get the index of the left child
+ * @return Index of the left child
+ */
+inline uint32_t FrozenDAG::Node::getIdNodeL() const
+{
+    return tagIdNodeL & ID_MASK;
+}
+
+/**
+ * @brief Get the index of the right child
+ * @return Index of the right child
+ */
+inline uint32_t FrozenDAG::Node::getIdNodeR() const
+{
+    return idNodeR;
+}
+
+/**
+ * @brief Get the x-coordinate of the point of a X-node
+ * @return The x-coordinate of the point
+ */
+inline double FrozenDAG::Node::getX() const
+{
+    assert(getType() == DAG::Node::Type::XNode);
+    return x;
+}
+
+/**
+ * @brief Get the index of the segment of a Y-node or the ID of the trapezoid of a leaf
+ * @return The index of the segment or the ID of the trapezoid
+ */
+inline uint32_t FrozenDAG::Node::getIdInfo() const
+{
+    assert(getType() != DAG::Node::Type::XNode);
+    return idInfo;
+}
+
+} // End namespace gasprj
@@ -0,0 +1,262 @@
+#include "loose_quadtree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+//Cell of the items not stored in the quadtree
+const uint32_t NO_CELL = std::numeric_limits<uint32_t>::max();
+
+}
+
+namespace gasprj {
+
+/**
+ * @brief Default constructor of a loose quadtree, over an empty extent
+ */
+LooseQuadtree::LooseQuadtree() :
+    LooseQuadtree(cg3::BoundingBox2(cg3::Point2d(0, 0), cg3::Point2d(0, 0)), 0)
+{
+}
+
+/**
+ * @brief Constructor of an empty loose quadtree
+ * @param[in] extent The region divided by the cells, which should contain the items
+ * @param[in] depth The deepest level of the quadtree (level 0 is a single cell)
+ */
+LooseQuadtree::LooseQuadtree(const cg3::BoundingBox2 &extent, size_t depth)
+{
+    reset(extent, depth);
+}
+
+/**
+ * @brief Get the deepest level of the quadtree
+ * @return The depth of the quadtree
+ */
+size_t LooseQuadtree::getDepth() const
+{
+    return depth;
+}
+
+/**
+ * @brief Get the region divided by the cells
+ * @return The extent of the quadtree
+ */
+const cg3::BoundingBox2 &LooseQuadtree::getExtent() const
+{
+    return extent;
+}
+
+/**
+ * @brief Get the width of the cells of a level
+ * @param[in] level The level of the quadtree
+ * @return The width of the cells
+ */
+double LooseQuadtree::getCellWidth(size_t level) const
+{
+    return extent.lengthX() / static_cast<double>(size_t(1) << level);
+}
+
+/**
+ * @brief Get the height of the cells of a level
+ * @param[in] level The level of the quadtree
+ * @return The height of the cells
+ */
+double LooseQuadtree::getCellHeight(size_t level) const
+{
+    return extent.lengthY() / static_cast<double>(size_t(1) << level);
+}
+
+/**
+ * @brief Get the number of items stored in the quadtree
+ * @return The number of items
+ */
+size_t LooseQuadtree::size() const
+{
+    return nItems;
+}
+
+/**
+ * @brief Find the items and the cells intersecting a region
+ * @param[in] region The query region
+ * @param[in] lodLevel The level of detail: the cells of this level are reported as a whole, instead of their items
+ * and the items below them (a level deeper than the quadtree reports only items)
+ * @param[out] ids The IDs of the items stored above the level of detail, in the cells whose loose bounds intersect
+ * the region (a superset of the items intersecting the region)
+ * @param[out] cells The non-empty cells of the level of detail whose loose bounds intersect the region
+ */
+void LooseQuadtree::query(const Box &region, size_t lodLevel, std::vector<uint32_t> &ids,
+                          std::vector<Cell> &cells) const
+{
+    ids.clear();
+    cells.clear();
+    if (!cellItems.empty())
+        query(0, 0, 0, region, lodLevel, ids, cells);
+}
+
+/**
+ * @brief Remove all the items and divide a new extent
+ * @param[in] extent The region divided by the cells, which should contain the items
+ * @param[in] depth The deepest level of the quadtree (level 0 is a single cell)
+ */
+void LooseQuadtree::reset(const cg3::BoundingBox2 &extent, size_t depth)
+{
+    assert(depth < 16);
+    this->extent = extent;
+    this->depth = depth;
+    size_t nCells = ((size_t(1) << (2*(depth+1))) - 1) / 3;
+    cellItems.assign(nCells, std::vector<uint32_t>());
+    cellCounts.assign(nCells, 0);
+    itemCells.clear();
+    itemPositions.clear();
+    nItems = 0;
+}
+
+/**
+ * @brief Insert an item, or move it if its bounding box has changed
+ * @param[in] id The ID of the item
+ * @param[in] box The bounding box of the item
+ */
+void LooseQuadtree::update(size_t id, const Box &box)
+{
+    assert(id < NO_CELL);
+    if (id < itemCells.size() && itemCells[id] != NO_CELL)
+        remove(id);
+    if (id >= itemCells.size()) {
+        itemCells.resize(id+1, NO_CELL);
+        itemPositions.resize(id+1, 0);
+    }
+
+    // Deepest level whose cells contain the box, and cell of its center
+    size_t level = depth;
+    while (level > 0 && (getCellWidth(level) < box.maxX - box.minX || getCellHeight(level) < box.maxY - box.minY))
+        --level;
+    size_t i = 0, j = 0;
+    if (level > 0) {
+        double maxIndex = static_cast<double>((size_t(1) << level) - 1);
+        double x = (0.5*(box.minX + box.maxX) - extent.min().x()) / getCellWidth(level);
+        double y = (0.5*(box.minY + box.maxY) - extent.min().y()) / getCellHeight(level);
+        i = static_cast<size_t>(std::min(std::max(x, 0.0), maxIndex));
+        j = static_cast<size_t>(std::min(std::max(y, 0.0), maxIndex));
+    }
+
+    size_t idCell = cellIndex(level, i, j);
+    itemCells[id] = static_cast<uint32_t>(idCell);
+    itemPositions[id] = static_cast<uint32_t>(cellItems[idCell].size());
+    cellItems[idCell].push_back(static_cast<uint32_t>(id));
+    for (size_t l = 0; l <= level; ++l)
+        ++cellCounts[cellIndex(l, i >> (level-l), j >> (level-l))];
+    ++nItems;
+}
+
+/**
+ * @brief Remove an item, if it is stored
+ * @param[in] id The ID of the item
+ */
+void LooseQuadtree::remove(size_t id)
+{
+    if (id >= itemCells.size() || itemCells[id] == NO_CELL) return;
+
+    size_t idCell = itemCells[id];
+    std::vector<uint32_t> &items = cellItems[idCell];
+    uint32_t position = itemPositions[id];
+    items[position] = items.back();
+    itemPositions[items[position]] = position;
+    items.pop_back();
+    itemCells[id] = NO_CELL;
+
+    // Level and coordinates of the cell, to update the counts of the cell and its ancestors
+    size_t level = 0;
+    while (cellIndex(level+1, 0, 0) <= idCell)
+        ++level;
+    size_t offset = idCell - cellIndex(level, 0, 0);
+    size_t i = offset & ((size_t(1) << level) - 1), j = offset >> level;
+    for (size_t l = 0; l <= level; ++l)
+        --cellCounts[cellIndex(l, i >> (level-l), j >> (level-l))];
+    --nItems;
+}
+
+/**
+ * @brief Remove all the items, keeping the extent
+ */
+void LooseQuadtree::clear()
+{
+    for (std::vector<uint32_t> &items : cellItems)
+        items.clear();
+    std::fill(cellCounts.begin(), cellCounts.end(), 0);
+    itemCells.clear();
+    itemPositions.clear();
+    nItems = 0;
+}
+
+
+
+/* Internal methods declaration */
+
+/**
+ * @brief Find the items and the cells intersecting a region, below a cell
+ * @param[in] level The level of the cell
+ * @param[in] i The column of the cell
+ * @param[in] j The row of the cell
+ * @param[in] region The query region
+ * @param[in] lodLevel The level of detail
+ * @param[out] ids The IDs of the items found
+ * @param[out] cells The cells of the level of detail found
+ */
+void LooseQuadtree::query(size_t level, size_t i, size_t j, const Box &region, size_t lodLevel,
+                          std::vector<uint32_t> &ids, std::vector<Cell> &cells) const
+{
+    size_t idCell = cellIndex(level, i, j);
+    if (cellCounts[idCell] == 0) return;
+
+    // The loose bounds of the root are unbounded, since it also stores the items larger than the extent
+    Box box = cellBox(level, i, j);
+    if (level > 0) {
+        float halfWidth = 0.5f*(box.maxX - box.minX), halfHeight = 0.5f*(box.maxY - box.minY);
+        if (box.minX - halfWidth > region.maxX || box.maxX + halfWidth < region.minX ||
+                box.minY - halfHeight > region.maxY || box.maxY + halfHeight < region.minY)
+            return;
+    }
+
+    if (level == lodLevel) {
+        cells.push_back(Cell{box, cellCounts[idCell]});
+        return;
+    }
+
+    ids.insert(ids.end(), cellItems[idCell].begin(), cellItems[idCell].end());
+    if (level < depth)
+        for (size_t child = 0; child < 4; ++child)
+            query(level+1, 2*i + (child & 1), 2*j + (child >> 1), region, lodLevel, ids, cells);
+}
+
+/**
+ * @brief Get the index of a cell in the attribute arrays
+ * @param[in] level The level of the cell
+ * @param[in] i The column of the cell
+ * @param[in] j The row of the cell
+ * @return The index of the cell
+ */
+size_t LooseQuadtree::cellIndex(size_t level, size_t i, size_t j) const
+{
+    return ((size_t(1) << (2*level)) - 1) / 3 + (j << level) + i;
+}
+
+/**
+ * @brief Get the extent of a cell
+ * @param[in] level The level of the cell
+ * @param[in] i The column of the cell
+ * @param[in] j The row of the cell
+ * @return The extent of the cell (not loose)
+ */
+LooseQuadtree::Box LooseQuadtree::cellBox(size_t level, size_t i, size_t j) const
+{
+    double width = getCellWidth(level), height = getCellHeight(level);
+    double minX = extent.min().x() + width*i, minY = extent.min().y() + height*j;
+    return Box{static_cast<float>(minX), static_cast<float>(minY),
+               static_cast<float>(minX + width), static_cast<float>(minY + height)};
+}
+
+} // End namespace gasprj
@@ -0,0 +1,80 @@
+#ifndef LOOSE_QUADTREE_H
+#define LOOSE_QUADTREE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <cg3/geometry/bounding_box2.h>
+
+namespace gasprj {
+
+/**
+ * @brief The loose quadtree over the bounding boxes of a set of items (the trapezoids of a drawn map)
+ *
+ * The levels of the quadtree are complete grids over the extent, with 2^k cells per side at level k. An item is stored
+ * in the deepest level whose cells are at least as large as its bounding box, in the cell containing the center of the
+ * box: the item then lies in the cell enlarged by half a cell on each side (the loose bounds of the cell), so the
+ * bounds are fixed and the items can be moved in constant time when their box changes. Every cell counts also the
+ * items stored below it, so a region can be summarized at any level without visiting its items.
+ */
+class LooseQuadtree
+{
+public:
+    /**
+     * @brief Axis-aligned box, in single precision as the render-side arrays
+     */
+    struct Box {
+        float minX, minY, maxX, maxY;
+    };
+
+    /**
+     * @brief Cell summarizing the items of a region, reported by the queries at the level of detail
+     */
+    struct Cell {
+        Box box;           // Extent of the cell (not loose)
+        uint32_t count;    // Number of items stored in the cell and below it
+    };
+
+    /**
+     * @brief Default depth of the quadtree (the deepest level has 256x256 cells)
+     */
+    static constexpr size_t DEFAULT_DEPTH = 8;
+
+    /* Constructors */
+    LooseQuadtree();
+    LooseQuadtree(const cg3::BoundingBox2 &extent, size_t depth = DEFAULT_DEPTH);
+
+    /* Public methods */
+    size_t getDepth() const;
+    const cg3::BoundingBox2 &getExtent() const;
+    double getCellWidth(size_t level) const;
+    double getCellHeight(size_t level) const;
+    size_t size() const;
+
+    void query(const Box &region, size_t lodLevel, std::vector<uint32_t> &ids, std::vector<Cell> &cells) const;
+
+    void reset(const cg3::BoundingBox2 &extent, size_t depth = DEFAULT_DEPTH);
+    void update(size_t id, const Box &box);
+    void remove(size_t id);
+    void clear();
+
+private:
+    /* Internal methods declaration */
+    void query(size_t level, size_t i, size_t j, const Box &region, size_t lodLevel,
+               std::vector<uint32_t> &ids, std::vector<Cell> &cells) const;
+    size_t cellIndex(size_t level, size_t i, size_t j) const;
+    Box cellBox(size_t level, size_t i, size_t j) const;
+
+    /* Attributes */
+    cg3::BoundingBox2 extent;
+    size_t depth;
+    std::vector<std::vector<uint32_t>> cellItems;   // IDs of the items stored in the cells, by level and row
+    std::vector<uint32_t> cellCounts;               // Number of items stored in the cells and below them
+    std::vector<uint32_t> itemCells;                // Cell of every item (NO_CELL if not stored)
+    std::vector<uint32_t> itemPositions;            // Position of every item in the list of its cell
+    size_t nItems;
+};
+
+} // End namespace gasprj
+
+#endif // LOOSE_QUADTREE_H
@@ -0,0 +1,382 @@
+#include "mapped_trapezoidalmap.h"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gasprj {
+
+namespace gasprjint {
+
+/**
+ * @brief Signature at the beginning of every binary trapezoidal map file
+ */
+constexpr char MAPPED_MAGIC[8] = {'G', 'A', 'S', 'P', 'R', 'J', 'T', 'M'};
+
+/**
+ * @brief Byte order mark, read back reversed on a machine with a different byte order
+ */
+constexpr uint32_t MAPPED_BYTE_ORDER = 0x01020304;
+
+bool addArraySize(uint64_t nElements, size_t elementSize, size_t &size);
+bool isValidId(size_t id, uint64_t nElements);
+
+} // End namespace gasprjint
+
+// The trapezoids and the DAG nodes are stored in the file as they are in memory
+static_assert(std::is_trivially_copyable<Trapezoid>::value, "Trapezoid must be trivially copyable");
+static_assert(std::is_trivially_copyable<DAG::Node>::value, "DAG::Node must be trivially copyable");
+static_assert(sizeof(MappedTrapezoidalMap::Header) % 8 == 0 && sizeof(DAG::Node) % 8 == 0 &&
+              alignof(Trapezoid) <= 8, "The arrays in the file must stay aligned");
+
+
+
+/**
+ * @brief Default constructor of a memory-mapped trapezoidal map, with no file mapped
+ */
+MappedTrapezoidalMap::MappedTrapezoidalMap() :
+    mapping(nullptr), mappingSize(0),
+    header(nullptr), points(nullptr), segments(nullptr), trapezoids(nullptr), nodes(nullptr)
+{
+}
+
+/**
+ * @brief Destructor of a memory-mapped trapezoidal map, unmapping the file
+ */
+MappedTrapezoidalMap::~MappedTrapezoidalMap()
+{
+    close();
+}
+
+/**
+ * @brief Map in memory a binary trapezoidal map file
+ * @param[in] filename The path of the file
+ * @return True if the file has been mapped, false if it cannot be read or it is not a valid file
+ *
+ * The file stays mapped until close() is called or the object is destroyed. Any previously mapped file is unmapped.
+ */
+bool MappedTrapezoidalMap::open(const std::string &filename)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after closing the file descriptor
+    size_t fileSize = static_cast<size_t>(fileStat.st_size);
+    void *fileMapping = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (fileMapping == MAP_FAILED) return false;
+
+    // Check the header and the size of the arrays (the counts are read from the file, so the size may overflow)
+    const Header *fileHeader = static_cast<const Header *>(fileMapping);
+    size_t expectedSize = sizeof(Header);
+    if (std::memcmp(fileHeader->magic, gasprjint::MAPPED_MAGIC, sizeof(gasprjint::MAPPED_MAGIC)) != 0 ||
+            fileHeader->version != VERSION || fileHeader->byteOrder != gasprjint::MAPPED_BYTE_ORDER ||
+            fileHeader->nTrapezoids == 0 || fileHeader->nNodes == 0 ||
+            !gasprjint::addArraySize(fileHeader->nPoints, sizeof(Point), expectedSize) ||
+            !gasprjint::addArraySize(fileHeader->nSegments, sizeof(Segment), expectedSize) ||
+            !gasprjint::addArraySize(fileHeader->nNodes, sizeof(DAG::Node), expectedSize) ||
+            !gasprjint::addArraySize(fileHeader->nTrapezoids, sizeof(Trapezoid), expectedSize) ||
+            expectedSize != fileSize) {
+        munmap(fileMapping, fileSize);
+        return false;
+    }
+
+    // Point the arrays inside the mapping
+    mapping = fileMapping;
+    mappingSize = fileSize;
+    header = fileHeader;
+    const char *data = static_cast<const char *>(mapping) + sizeof(Header);
+    points = reinterpret_cast<const Point *>(data);
+    data += header->nPoints*sizeof(Point);
+    segments = reinterpret_cast<const Segment *>(data);
+    data += header->nSegments*sizeof(Segment);
+    nodes = reinterpret_cast<const DAG::Node *>(data);
+    data += header->nNodes*sizeof(DAG::Node);
+    trapezoids = reinterpret_cast<const Trapezoid *>(data);
+
+    // Check every reference once, so that the queries can follow them with no bound checks
+    if (!validate()) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Unmap the mapped file, if any
+ */
+void MappedTrapezoidalMap::close()
+{
+    if (mapping != nullptr) munmap(mapping, mappingSize);
+
+    mapping = nullptr;
+    mappingSize = 0;
+    header = nullptr;
+    points = nullptr;
+    segments = nullptr;
+    trapezoids = nullptr;
+    nodes = nullptr;
+}
+
+/**
+ * @brief Check if a file is mapped
+ * @return True if a file is mapped, false otherwise
+ */
+bool MappedTrapezoidalMap::isOpen() const
+{
+    return mapping != nullptr;
+}
+
+/**
+ * @brief Get a specific point of the dataset
+ * @param[in] id The ID of the point
+ * @return The specified point
+ */
+const MappedTrapezoidalMap::Point &MappedTrapezoidalMap::getPoint(size_t id) const
+{
+    assert(isOpen() && id < header->nPoints);
+    return points[id];
+}
+
+/**
+ * @brief Get the number of points of the dataset
+ * @return The number of points of the dataset
+ */
+size_t MappedTrapezoidalMap::pointNumber() const
+{
+    return isOpen() ? header->nPoints : 0;
+}
+
+/**
+ * @brief Get a specific segment of the dataset
+ * @param[in] id The ID of the segment
+ * @return The specified segment, with the endpoints ordered by x-coordinate
+ */
+const MappedTrapezoidalMap::Segment &MappedTrapezoidalMap::getSegment(size_t id) const
+{
+    assert(isOpen() && id < header->nSegments);
+    return segments[id];
+}
+
+/**
+ * @brief Get the number of segments of the dataset
+ * @return The number of segments of the dataset
+ */
+size_t MappedTrapezoidalMap::segmentNumber() const
+{
+    return isOpen() ? header->nSegments : 0;
+}
+
+/**
+ * @brief Get a specific trapezoid of the trapezoidal map
+ * @param[in] id The ID of the trapezoid
+ * @return The specified trapezoid
+ */
+const Trapezoid &MappedTrapezoidalMap::getTrapezoid(size_t id) const
+{
+    assert(isOpen() && id < header->nTrapezoids);
+    return trapezoids[id];
+}
+
+/**
+ * @brief Get the number of trapezoids of the trapezoidal map
+ * @return The number of trapezoids of the trapezoidal map
+ */
+size_t MappedTrapezoidalMap::size() const
+{
+    return isOpen() ? header->nTrapezoids : 0;
+}
+
+/**
+ * @brief Get the root of the DAG
+ * @return The first node of the DAG
+ */
+const DAG::Node &MappedTrapezoidalMap::getRoot() const
+{
+    assert(isOpen());
+    return nodes[0];
+}
+
+/**
+ * @brief Get a specific node of the DAG
+ * @param[in] id Index of the node
+ * @return The specified node of the DAG
+ */
+const DAG::Node &MappedTrapezoidalMap::getNode(size_t id) const
+{
+    assert(isOpen() && id < header->nNodes);
+    return nodes[id];
+}
+
+/**
+ * @brief Get the number of nodes (internal and leaves) of the DAG
+ * @return The number of nodes of the DAG
+ */
+size_t MappedTrapezoidalMap::nodeNumber() const
+{
+    return isOpen() ? header->nNodes : 0;
+}
+
+/**
+ * @brief Save a trapezoidal map, its dataset and its DAG in a binary file, that can be mapped in memory
+ * @param[in] filename The path of the file
+ * @param[in] trapMap The trapezoidal map data structure
+ * @param[in] dag The DAG query data structure
+ * @return True if the file has been written, false otherwise
+ */
+bool MappedTrapezoidalMap::save(const std::string &filename, const TrapezoidalMap &trapMap, const DAG &dag)
+{
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+    const std::vector<cg3::Point2d> &dataPoints = trapMapData.getPoints();
+    const std::vector<TrapezoidalMapDataset::IndexedSegment2d> &dataSegments = trapMapData.getIndexedSegments();
+    const std::vector<DAG::Node> &dagNodes = dag.getNodes();
+
+    std::ofstream outfile(filename, std::ios::binary | std::ios::trunc);
+    if (!outfile) return false;
+
+    // Header
+    Header fileHeader;
+    std::memset(&fileHeader, 0, sizeof(Header));
+    std::memcpy(fileHeader.magic, gasprjint::MAPPED_MAGIC, sizeof(gasprjint::MAPPED_MAGIC));
+    fileHeader.version = VERSION;
+    fileHeader.byteOrder = gasprjint::MAPPED_BYTE_ORDER;
+    fileHeader.nPoints = dataPoints.size();
+    fileHeader.nSegments = dataSegments.size();
+    fileHeader.nTrapezoids = trapMap.size();
+    fileHeader.nNodes = dagNodes.size();
+    outfile.write(reinterpret_cast<const char *>(&fileHeader), sizeof(Header));
+
+    // Points
+    std::vector<Point> filePoints;
+    filePoints.reserve(dataPoints.size());
+    for (const cg3::Point2d &point : dataPoints)
+        filePoints.push_back({point.x(), point.y()});
+    outfile.write(reinterpret_cast<const char *>(filePoints.data()), filePoints.size()*sizeof(Point));
+
+    // Segments, ordering their endpoints
+    std::vector<Segment> fileSegments;
+    fileSegments.reserve(dataSegments.size());
+    for (const TrapezoidalMapDataset::IndexedSegment2d &indexedSegment : dataSegments) {
+        if (dataPoints[indexedSegment.first].x() < dataPoints[indexedSegment.second].x())
+            fileSegments.push_back({indexedSegment.first, indexedSegment.second});
+        else
+            fileSegments.push_back({indexedSegment.second, indexedSegment.first});
+    }
+    outfile.write(reinterpret_cast<const char *>(fileSegments.data()), fileSegments.size()*sizeof(Segment));
+
+    // DAG nodes
+    outfile.write(reinterpret_cast<const char *>(dagNodes.data()), dagNodes.size()*sizeof(DAG::Node));
+
+    // Trapezoids, last since their size is not a multiple of 8 bytes (copied one by one, since the trapezoidal map may
+    // store a derived version of them)
+    for (size_t id = 0; id < trapMap.size(); ++id) {
+        Trapezoid trapezoid = trapMap.getTrapezoid(id);
+        outfile.write(reinterpret_cast<const char *>(&trapezoid), sizeof(Trapezoid));
+    }
+
+    outfile.close();
+    return !outfile.fail();
+}
+
+
+
+/* Internal methods declaration */
+
+/**
+ * @brief Check that every reference stored in the mapped file is in the bounds of the referenced array
+ * @return True if the references of the segments, the DAG nodes and the trapezoids are valid, false otherwise
+ *
+ * The references are only checked to be in bounds: a DAG with cycles or a wrong trapezoidal map is not detected, but
+ * the queries on it cannot read outside of the mapping.
+ */
+bool MappedTrapezoidalMap::validate() const
+{
+    for (size_t id = 0; id < header->nSegments; ++id)
+        if (segments[id].idPointL >= header->nPoints || segments[id].idPointR >= header->nPoints)
+            return false;
+
+    for (size_t id = 0; id < header->nNodes; ++id) {
+        const DAG::Node &node = nodes[id];
+        switch (node.getType()) {
+            case DAG::Node::Type::XNode:
+                if (node.getIdInfo() >= header->nPoints) return false;
+                break;
+            case DAG::Node::Type::YNode:
+                if (node.getIdInfo() >= header->nSegments) return false;
+                break;
+            case DAG::Node::Type::Leaf:
+                if (node.getIdInfo() >= header->nTrapezoids) return false;
+                continue;
+            default:
+                return false;
+        }
+        if (node.getIdNodeL() >= header->nNodes || node.getIdNodeR() >= header->nNodes) return false;
+    }
+
+    for (size_t id = 0; id < header->nTrapezoids; ++id) {
+        const Trapezoid &trap = trapezoids[id];
+        if (!gasprjint::isValidId(trap.getIdSegmentT(), header->nSegments) ||
+                !gasprjint::isValidId(trap.getIdSegmentB(), header->nSegments) ||
+                !gasprjint::isValidId(trap.getIdPointL(), header->nPoints) ||
+                !gasprjint::isValidId(trap.getIdPointR(), header->nPoints) ||
+                !gasprjint::isValidId(trap.getIdAdjacencyTL(), header->nTrapezoids) ||
+                !gasprjint::isValidId(trap.getIdAdjacencyTR(), header->nTrapezoids) ||
+                !gasprjint::isValidId(trap.getIdAdjacencyBL(), header->nTrapezoids) ||
+                !gasprjint::isValidId(trap.getIdAdjacencyBR(), header->nTrapezoids) ||
+                trap.getIdDagLeaf() >= header->nNodes)
+            return false;
+    }
+
+    return true;
+}
+
+
+
+namespace gasprjint {
+
+/**
+ * @brief Add the size of an array read from the file header to a total size, checking for overflow
+ * @param[in] nElements The number of elements of the array
+ * @param[in] elementSize The size of an element
+ * @param[in,out] size The total size, increased by the size of the array
+ * @return True if the size is representable, false if it overflows
+ */
+bool addArraySize(uint64_t nElements, size_t elementSize, size_t &size)
+{
+    const size_t maxSize = std::numeric_limits<size_t>::max();
+    if (nElements > (maxSize - size)/elementSize) return false;
+    size += static_cast<size_t>(nElements)*elementSize;
+    return true;
+}
+
+/**
+ * @brief Check if an ID read from the file references an element of an array, or no element
+ * @param[in] id The ID
+ * @param[in] nElements The number of elements of the array
+ * @return True if the ID is NO_ID or less than the number of elements, false otherwise
+ */
+bool isValidId(size_t id, uint64_t nElements)
+{
+    return id == Trapezoid::NO_ID || id < nElements;
+}
+
+} // End namespace gasprjint
+
+} // End namespace gasprj
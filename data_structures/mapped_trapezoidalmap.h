@@ -0,0 +1,100 @@
+#ifndef MAPPED_TRAPEZOIDALMAP_H
+#define MAPPED_TRAPEZOIDALMAP_H
+
+#include <cstdint>
+#include <string>
+
+#include "data_structures/dag.h"
+#include "data_structures/trapezoid.h"
+#include "data_structures/trapezoidalmap.h"
+
+namespace gasprj {
+
+/**
+ * @brief The read-only trapezoidal map and DAG, memory-mapped from a binary file
+ *
+ * This class maps in memory a binary file storing the points and segments of a trapezoidal map dataset, the
+ * trapezoids of the trapezoidal map and the nodes of its DAG. The file is laid out as the arrays used in memory, so it
+ * is accessed in place, with no copy and no parsing: the pages are loaded on demand and shared among all the processes
+ * mapping the same file.
+ *
+ * The file starts with a header, followed by the arrays of points, segments (with the endpoints ordered by
+ * x-coordinate), DAG nodes and trapezoids. The file is not portable among machines with different byte order or word
+ * size: the header stores a version number and a byte order mark, checked when the file is opened together with the
+ * size of the arrays and every reference among them.
+ */
+class MappedTrapezoidalMap
+{
+public:
+    /**
+     * @brief A point of the dataset
+     */
+    struct Point {
+        double x, y;
+    };
+
+    /**
+     * @brief A segment of the dataset, as the IDs of its left and right endpoints
+     */
+    struct Segment {
+        uint64_t idPointL, idPointR;
+    };
+
+    /**
+     * @brief The header of the binary file
+     */
+    struct Header {
+        char magic[8];          // File signature
+        uint32_t version;       // Version of the file format
+        uint32_t byteOrder;     // Byte order mark
+        uint64_t nPoints;       // Number of points
+        uint64_t nSegments;     // Number of segments
+        uint64_t nTrapezoids;   // Number of trapezoids
+        uint64_t nNodes;        // Number of DAG nodes
+    };
+
+    /**
+     * @brief Version of the file format
+     */
+    static constexpr uint32_t VERSION = 2;
+
+    /* Constructors */
+    MappedTrapezoidalMap();
+    MappedTrapezoidalMap(const MappedTrapezoidalMap &) = delete;
+    MappedTrapezoidalMap &operator=(const MappedTrapezoidalMap &) = delete;
+    ~MappedTrapezoidalMap();
+
+    /* Public methods */
+    bool open(const std::string &filename);
+    void close();
+    bool isOpen() const;
+
+    const Point &getPoint(size_t id) const;
+    size_t pointNumber() const;
+    const Segment &getSegment(size_t id) const;
+    size_t segmentNumber() const;
+    const Trapezoid &getTrapezoid(size_t id) const;
+    size_t size() const;
+    const DAG::Node &getRoot() const;
+    const DAG::Node &getNode(size_t id) const;
+    size_t nodeNumber() const;
+
+    static bool save(const std::string &filename, const TrapezoidalMap &trapMap, const DAG &dag);
+
+private:
+    /* Internal methods declaration */
+    bool validate() const;
+
+    /* Attributes */
+    void *mapping;
+    size_t mappingSize;
+    const Header *header;
+    const Point *points;
+    const Segment *segments;
+    const Trapezoid *trapezoids;
+    const DAG::Node *nodes;
+};
+
+} // End namespace gasprj
+
+#endif // MAPPED_TRAPEZOIDALMAP_H
@@ -0,0 +1,257 @@
+#include "segment_bvh.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace gasprj {
+
+namespace gasprjint {
+
+/**
+ * @brief Maximum depth of the stack visiting the BVH (the median split keeps the depth logarithmic)
+ */
+constexpr size_t BVH_STACK_SIZE = 64;
+
+/**
+ * @brief Check if two intervals overlap, within the tolerance of the BVH
+ */
+inline bool intervalsOverlap(double min1, double max1, double min2, double max2)
+{
+    return !(min1 - SegmentBVH::EPS > max2 + SegmentBVH::EPS || min2 - SegmentBVH::EPS > max1 + SegmentBVH::EPS);
+}
+
+} // End namespace gasprjint
+
+
+
+/**
+ * @brief Default constructor of an empty BVH
+ */
+SegmentBVH::SegmentBVH()
+{
+}
+
+/**
+ * @brief Build the BVH of a set of segments, replacing the previous content
+ * @param[in] input The segments
+ *
+ * Takes O(n log n) time: every node splits its segments in two halves, at the median of their centers along the
+ * largest extent of the centers, found in linear time.
+ */
+void SegmentBVH::build(const std::vector<cg3::Segment2d> &input)
+{
+    clear();
+    if (input.empty()) return;
+    assert(input.size() < std::numeric_limits<uint32_t>::max());
+
+    std::vector<uint32_t> ids(input.size());
+    for (uint32_t i = 0; i < ids.size(); ++i) ids[i] = i;
+
+    size_t nNodes = 2*(input.size()/LEAF_SIZE + 1);
+    nodeMinX.reserve(nNodes); nodeMinY.reserve(nNodes); nodeMaxX.reserve(nNodes); nodeMaxY.reserve(nNodes);
+    nodeFirst.reserve(nNodes); nodeCount.reserve(nNodes);
+    buildNode(input, ids, 0, static_cast<uint32_t>(ids.size()));
+
+    // Store the segments in the order of the leaves
+    segments.reserve(input.size());
+    segmentIds = ids;
+    segmentMinX.reserve(input.size()); segmentMinY.reserve(input.size());
+    segmentMaxX.reserve(input.size()); segmentMaxY.reserve(input.size());
+    for (uint32_t id : ids) {
+        const cg3::Segment2d &segment = input[id];
+        segments.push_back(segment);
+        segmentMinX.push_back(std::min(segment.p1().x(), segment.p2().x()));
+        segmentMinY.push_back(std::min(segment.p1().y(), segment.p2().y()));
+        segmentMaxX.push_back(std::max(segment.p1().x(), segment.p2().x()));
+        segmentMaxY.push_back(std::max(segment.p1().y(), segment.p2().y()));
+    }
+}
+
+/**
+ * @brief Get the segments stored in the BVH
+ * @return The segments, in the order of the leaves
+ */
+const std::vector<cg3::Segment2d> &SegmentBVH::getSegments() const
+{
+    return segments;
+}
+
+/**
+ * @brief Get the number of segments stored in the BVH
+ * @return The number of segments
+ */
+size_t SegmentBVH::size() const
+{
+    return segments.size();
+}
+
+/**
+ * @brief Check if the BVH is empty
+ * @return True if no segment is stored in the BVH, false otherwise
+ */
+bool SegmentBVH::empty() const
+{
+    return segments.empty();
+}
+
+/**
+ * @brief Check if a segment overlaps at least one of the segments in the BVH
+ * @param[in] segment The query segment
+ * @param[in] overlapChecker The exact overlap test, called with the query segment first
+ * @return True if an overlapping segment has been found, false otherwise
+ */
+bool SegmentBVH::checkOverlap(const cg3::Segment2d &segment, SegmentOverlapChecker overlapChecker) const
+{
+    auto stopAtFirst = [](uint32_t i) { (void) i; return true; };
+    return visitOverlaps(segment, overlapChecker, stopAtFirst);
+}
+
+/**
+ * @brief Count the segments in the BVH overlapping a segment
+ * @param[in] segment The query segment
+ * @param[in] overlapChecker The exact overlap test, called with the query segment first
+ * @return The number of overlapping segments
+ */
+size_t SegmentBVH::countOverlaps(const cg3::Segment2d &segment, SegmentOverlapChecker overlapChecker) const
+{
+    size_t count = 0;
+    auto countAll = [&count](uint32_t i) { (void) i; ++count; return false; };
+    visitOverlaps(segment, overlapChecker, countAll);
+    return count;
+}
+
+/**
+ * @brief Find the segments in the BVH overlapping a segment
+ * @param[in] segment The query segment
+ * @param[in] overlapChecker The exact overlap test, called with the query segment first
+ * @param[out] ids The indices (in the input of build()) of the overlapping segments, appended in no specific order
+ */
+void SegmentBVH::findOverlaps(const cg3::Segment2d &segment, SegmentOverlapChecker overlapChecker,
+                              std::vector<size_t> &ids) const
+{
+    auto appendAll = [this, &ids](uint32_t i) { ids.push_back(segmentIds[i]); return false; };
+    visitOverlaps(segment, overlapChecker, appendAll);
+}
+
+/**
+ * @brief Delete all the nodes and segments of the BVH
+ */
+void SegmentBVH::clear()
+{
+    nodeMinX.clear(); nodeMinY.clear(); nodeMaxX.clear(); nodeMaxY.clear();
+    nodeFirst.clear(); nodeCount.clear();
+    segments.clear();
+    segmentIds.clear();
+    segmentMinX.clear(); segmentMinY.clear(); segmentMaxX.clear(); segmentMaxY.clear();
+}
+
+
+
+/* Internal methods implementation */
+
+/**
+ * @brief Visit the segments in the BVH overlapping a segment, with an explicit stack
+ * @param[in] segment The query segment
+ * @param[in] overlapChecker The exact overlap test, called with the query segment first
+ * @param[in] visitor Called with the position of every overlapping segment, returns true to stop the visit
+ * @return True if the visit has been stopped by the visitor, false otherwise
+ */
+template<class Visitor>
+bool SegmentBVH::visitOverlaps(const cg3::Segment2d &segment, SegmentOverlapChecker overlapChecker,
+                               Visitor &visitor) const
+{
+    if (segments.empty()) return false;
+
+    double minX = std::min(segment.p1().x(), segment.p2().x());
+    double minY = std::min(segment.p1().y(), segment.p2().y());
+    double maxX = std::max(segment.p1().x(), segment.p2().x());
+    double maxY = std::max(segment.p1().y(), segment.p2().y());
+
+    uint32_t stack[gasprjint::BVH_STACK_SIZE];
+    size_t top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        uint32_t id = stack[--top];
+        if (!gasprjint::intervalsOverlap(minX, maxX, nodeMinX[id], nodeMaxX[id]) ||
+                !gasprjint::intervalsOverlap(minY, maxY, nodeMinY[id], nodeMaxY[id]))
+            continue;
+
+        // Leaf: test its segments
+        if (nodeCount[id] > 0) {
+            for (uint32_t i = nodeFirst[id]; i < nodeFirst[id] + nodeCount[id]; ++i) {
+                if (gasprjint::intervalsOverlap(minX, maxX, segmentMinX[i], segmentMaxX[i]) &&
+                        gasprjint::intervalsOverlap(minY, maxY, segmentMinY[i], segmentMaxY[i]) &&
+                        overlapChecker(segment, segments[i]) && visitor(i))
+                    return true;
+            }
+        }
+        // Internal node: visit the children
+        else {
+            assert(top + 2 <= gasprjint::BVH_STACK_SIZE);
+            stack[top++] = nodeFirst[id];
+            stack[top++] = id + 1;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Build the sub-hierarchy of a range of segments, appending its nodes in depth-first order
+ * @param[in] input The segments
+ * @param[in,out] ids The indices of the segments, reordered so that every leaf references a contiguous range
+ * @param[in] first The first index of the range
+ * @param[in] last The index after the last one of the range
+ * @return The index of the root of the sub-hierarchy
+ */
+uint32_t SegmentBVH::buildNode(const std::vector<cg3::Segment2d> &input, std::vector<uint32_t> &ids,
+                               uint32_t first, uint32_t last)
+{
+    uint32_t id = static_cast<uint32_t>(nodeFirst.size());
+
+    // Bounding box of the segments and of their centers
+    double minX = std::numeric_limits<double>::max(), minY = minX, maxX = -minX, maxY = -minX;
+    double minCX = minX, minCY = minX, maxCX = -minX, maxCY = -minX;
+    for (uint32_t i = first; i < last; ++i) {
+        const cg3::Segment2d &segment = input[ids[i]];
+        minX = std::min(minX, std::min(segment.p1().x(), segment.p2().x()));
+        minY = std::min(minY, std::min(segment.p1().y(), segment.p2().y()));
+        maxX = std::max(maxX, std::max(segment.p1().x(), segment.p2().x()));
+        maxY = std::max(maxY, std::max(segment.p1().y(), segment.p2().y()));
+        double cX = segment.p1().x() + segment.p2().x(), cY = segment.p1().y() + segment.p2().y();
+        minCX = std::min(minCX, cX); maxCX = std::max(maxCX, cX);
+        minCY = std::min(minCY, cY); maxCY = std::max(maxCY, cY);
+    }
+    nodeMinX.push_back(minX); nodeMinY.push_back(minY); nodeMaxX.push_back(maxX); nodeMaxY.push_back(maxY);
+
+    // Leaf
+    if (last - first <= LEAF_SIZE) {
+        nodeFirst.push_back(first);
+        nodeCount.push_back(last - first);
+        return id;
+    }
+
+    // Internal node: split at the median center along the largest extent
+    nodeFirst.push_back(0);
+    nodeCount.push_back(0);
+    uint32_t mid = first + (last - first)/2;
+    if (maxCX - minCX >= maxCY - minCY) {
+        std::nth_element(ids.begin() + first, ids.begin() + mid, ids.begin() + last, [&input](uint32_t a, uint32_t b) {
+            return input[a].p1().x() + input[a].p2().x() < input[b].p1().x() + input[b].p2().x();
+        });
+    }
+    else {
+        std::nth_element(ids.begin() + first, ids.begin() + mid, ids.begin() + last, [&input](uint32_t a, uint32_t b) {
+            return input[a].p1().y() + input[a].p2().y() < input[b].p1().y() + input[b].p2().y();
+        });
+    }
+    buildNode(input, ids, first, mid);
+    uint32_t idRight = buildNode(input, ids, mid, last);
+    nodeFirst[id] = idRight;
+
+    return id;
+}
+
+} // End namespace gasprj
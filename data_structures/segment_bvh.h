@@ -0,0 +1,75 @@
+#ifndef SEGMENT_BVH_H
+#define SEGMENT_BVH_H
+
+#include <cstdint>
+#include <vector>
+
+#include <cg3/geometry/segment2.h>
+
+namespace gasprj {
+
+/**
+ * @brief The flat bounding volume hierarchy of a set of segments
+ *
+ * This class defines a static BVH of 2D segments, stored in contiguous arrays: the nodes are laid out in depth-first
+ * order (the left child of an internal node follows it, the right one is referenced), and the bounding boxes of the
+ * nodes and of the segments are stored as separate arrays of coordinates (structure of arrays). The hierarchy is built
+ * in one pass, splitting the segments at the median of their centers along the largest extent, and it is visited by
+ * the queries with an explicit stack.
+ *
+ * Two bounding boxes overlap if they do within a tolerance of EPS on both sides, as in the cg3 AABB tree.
+ */
+class SegmentBVH
+{
+public:
+    /**
+     * @brief Exact overlap test between two segments, called on the segments with overlapping bounding boxes
+     */
+    using SegmentOverlapChecker = bool (*)(const cg3::Segment2d &segment1, const cg3::Segment2d &segment2);
+
+    /**
+     * @brief Tolerance of the overlap test between bounding boxes
+     */
+    static constexpr double EPS = 1e-4;
+
+    /**
+     * @brief Maximum number of segments in a leaf
+     */
+    static constexpr uint32_t LEAF_SIZE = 4;
+
+    /* Constructors */
+    SegmentBVH();
+
+    /* Public methods */
+    void build(const std::vector<cg3::Segment2d> &segments);
+    const std::vector<cg3::Segment2d> &getSegments() const;
+    size_t size() const;
+    bool empty() const;
+
+    bool checkOverlap(const cg3::Segment2d &segment, SegmentOverlapChecker overlapChecker) const;
+    size_t countOverlaps(const cg3::Segment2d &segment, SegmentOverlapChecker overlapChecker) const;
+    void findOverlaps(const cg3::Segment2d &segment, SegmentOverlapChecker overlapChecker,
+                      std::vector<size_t> &ids) const;
+
+    void clear();
+
+private:
+    /* Internal methods declaration */
+    template<class Visitor>
+    bool visitOverlaps(const cg3::Segment2d &segment, SegmentOverlapChecker overlapChecker, Visitor &visitor) const;
+    uint32_t buildNode(const std::vector<cg3::Segment2d> &input, std::vector<uint32_t> &ids,
+                       uint32_t first, uint32_t last);
+
+    /* Attributes */
+    // Nodes: bounding box, first segment and number of segments (leaf) or right child and 0 (internal node)
+    std::vector<double> nodeMinX, nodeMinY, nodeMaxX, nodeMaxY;
+    std::vector<uint32_t> nodeFirst, nodeCount;
+    // Segments, in the order of the leaves, their indices in the input and their bounding boxes
+    std::vector<cg3::Segment2d> segments;
+    std::vector<uint32_t> segmentIds;
+    std::vector<double> segmentMinX, segmentMinY, segmentMaxX, segmentMaxY;
+};
+
+} // End namespace gasprj
+
+#endif // SEGMENT_BVH_H
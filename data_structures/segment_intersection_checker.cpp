@@ -3,39 +3,67 @@
 #include <cg3/geometry/intersections2.h>
 
 SegmentIntersectionChecker::SegmentIntersectionChecker()
-    : aabbTree(&aabbValueExtractor),
-      keyOverlapChecker(&checkSegmentIntersection)
 {
 
 }
 
 void SegmentIntersectionChecker::insert(const cg3::Segment2d& seg) {
-    aabbTree.insert(seg);
+    insert(std::vector<cg3::Segment2d>(1, seg));
+}
+
+/*
+ * The segments are stored in a logarithmic number of flat BVHs, which cannot be updated: the new segments are merged
+ * with the ones of the smallest levels, until they fit a level, whose BVH is rebuilt. Every segment is moved to a
+ * bigger level at most a logarithmic number of times.
+ */
+void SegmentIntersectionChecker::insert(const std::vector<cg3::Segment2d>& segVec) {
+    if (segVec.empty())
+        return;
+
+    std::vector<cg3::Segment2d> carry = segVec;
+    for (size_t k = 0; ; k++) {
+        if (k == bvhLevels.size())
+            bvhLevels.push_back(gasprj::SegmentBVH());
+
+        const std::vector<cg3::Segment2d>& levelSegments = bvhLevels[k].getSegments();
+        carry.insert(carry.end(), levelSegments.begin(), levelSegments.end());
+        bvhLevels[k].clear();
+
+        if (carry.size() <= (size_t(1) << k)) {
+            bvhLevels[k].build(carry);
+            return;
+        }
+    }
 }
 
 size_t SegmentIntersectionChecker::countIntersections(const cg3::Segment2d& seg) {
-    std::vector<cg3::AABBTree<2, cg3::Segment2d>::iterator> out;
-    aabbTree.aabbOverlapQuery(seg, std::back_inserter(out), this->keyOverlapChecker);
-    return out.size();
+    size_t result = 0;
+    for (const gasprj::SegmentBVH& bvh : bvhLevels) {
+        result += bvh.countOverlaps(seg, &checkSegmentIntersection);
+    }
+    return result;
 }
 
 bool SegmentIntersectionChecker::checkIntersections(const cg3::Segment2d& seg) {
-    return aabbTree.aabbOverlapCheck(seg, this->keyOverlapChecker);
+    for (const gasprj::SegmentBVH& bvh : bvhLevels) {
+        if (bvh.checkOverlap(seg, &checkSegmentIntersection)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 size_t SegmentIntersectionChecker::countIntersection(const std::vector<cg3::Segment2d>& segVec) {
     size_t result = 0;
     for (const cg3::Segment2d& seg : segVec) {
-        std::vector<cg3::AABBTree<2, cg3::Segment2d>::iterator> out;
-        aabbTree.aabbOverlapQuery(seg, std::back_inserter(out), this->keyOverlapChecker);
-        result += out.size();
+        result += countIntersections(seg);
     }
     return result;
 }
 
 bool SegmentIntersectionChecker::checkIntersections(const std::vector<cg3::Segment2d>& segVec) {
     for (const cg3::Segment2d& seg : segVec) {
-        if (aabbTree.aabbOverlapCheck(seg, this->keyOverlapChecker)) {
+        if (checkIntersections(seg)) {
             return true;
         }
     }
@@ -74,5 +102,5 @@ bool SegmentIntersectionChecker::checkSegmentIntersection(const cg3::Segment2d&
 
 void SegmentIntersectionChecker::clear()
 {
-    aabbTree.clear();
+    bvhLevels.clear();
 }
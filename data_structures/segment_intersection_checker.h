@@ -1,20 +1,22 @@
 #ifndef SEGMENTINTERSECTIONCHECKER_H
 #define SEGMENTINTERSECTIONCHECKER_H
 
+#include <vector>
+
 #include <cg3/data_structures/trees/aabbtree.h>
 #include <cg3/geometry/segment2.h>
 
+#include "data_structures/segment_bvh.h"
+
 
 class SegmentIntersectionChecker {
 
 public:
 
-    typedef cg3::AABBTree<2, cg3::Segment2d> AABBTree;
-    typedef AABBTree::KeyOverlapChecker KeyOverlapChecker;
-
     SegmentIntersectionChecker();
 
     void insert(const cg3::Segment2d& seg);
+    void insert(const std::vector<cg3::Segment2d>& segVec);
 
     size_t countIntersections(const cg3::Segment2d& seg);
     bool checkIntersections(const cg3::Segment2d& seg);
@@ -35,8 +37,8 @@ public:
 
 private:
 
-    AABBTree aabbTree;
-    KeyOverlapChecker keyOverlapChecker;
+    //Static BVHs of the segments: the k-th one is empty or stores at most 2^k segments
+    std::vector<gasprj::SegmentBVH> bvhLevels;
 
 };
 
@@ -1,6 +1,7 @@
 #ifndef TRAPEZOID_H
 #define TRAPEZOID_H
 
+#include <cstdint>
 #include <limits>
 #include <vector>
 
@@ -13,8 +14,13 @@ namespace gasprj {
  * Every trapezoid is uniquely identified by its left and right points and its top and bottom segments.
  * Every trapezoid has a maximum of 4 adjacient trapezoids (top-left, top-right, bottom-left, bottom-right) and stores
  * a reference to the DAG leaf which represent it.
+ *
+ * The references are stored as unsigned integers of type Index, and converted from and to size_t IDs by the getters and
+ * setters. The fields read by the queries (the segments and the points) come first, followed by the ones only needed
+ * by the construction and the walks (the adjacencies and the DAG leaf).
  */
-class Trapezoid
+template<class Index>
+class BasicTrapezoid
 {
 public:
     /**
@@ -22,10 +28,15 @@ public:
      */
     static constexpr size_t NO_ID = std::numeric_limits<size_t>::max();
 
+    /**
+     * @brief Maximum ID that can be stored (the maximum value of the index is reserved to NO_ID)
+     */
+    static constexpr size_t MAX_ID = static_cast<size_t>(std::numeric_limits<Index>::max()) - 1;
+
     /* Constructors */
-    Trapezoid();
-    Trapezoid(size_t idSegmentT, size_t idSegmentB, size_t idPointL, size_t idPointR,
-              size_t idTrapezoidTL, size_t idTrapezoidTR, size_t idTrapezoidBL, size_t idTrapezoidBR, size_t idDagLeaf);
+    BasicTrapezoid();
+    BasicTrapezoid(size_t idSegmentT, size_t idSegmentB, size_t idPointL, size_t idPointR,
+                   size_t idTrapezoidTL, size_t idTrapezoidTR, size_t idTrapezoidBL, size_t idTrapezoidBR, size_t idDagLeaf);
 
     /* Getters and setters */
     size_t getIdSegmentT() const;
@@ -50,12 +61,27 @@ public:
     void setIdDagLeaf(size_t id);
 
 protected:
+    /* Internal methods declaration */
+    static size_t toId(Index index);
+    static Index toIndex(size_t id);
+
+    /**
+     * @brief Stored value of NO_ID
+     */
+    static constexpr Index NO_INDEX = std::numeric_limits<Index>::max();
+
     /* Attributes */
-    size_t idSegmentT, idSegmentB, idPointL, idPointR;
-    size_t idAdjacentTrapezoidTL, idAdjacentTrapezoidTR, idAdjacentTrapezoidBL, idAdjacentTrapezoidBR;
-    size_t idDagLeaf;
+    Index idSegmentT, idSegmentB, idPointL, idPointR;
+    Index idAdjacentTrapezoidTL, idAdjacentTrapezoidTR, idAdjacentTrapezoidBL, idAdjacentTrapezoidBR;
+    Index idDagLeaf;
 };
 
+/**
+ * @brief The trapezoid of the trapezoidal maps, with 32-bit references (up to 4G points, segments, trapezoids and
+ * DAG nodes)
+ */
+typedef BasicTrapezoid<uint32_t> Trapezoid;
+
 } // End namespace gasprj
 
 #include "trapezoid.tpp"
@@ -1,16 +1,27 @@
 #include "trapezoid.h"
 
+#include <cassert>
+#include <stdexcept>
+
 namespace gasprj {
 
+template<class Index>
+constexpr size_t BasicTrapezoid<Index>::NO_ID;
+template<class Index>
+constexpr size_t BasicTrapezoid<Index>::MAX_ID;
+template<class Index>
+constexpr Index BasicTrapezoid<Index>::NO_INDEX;
+
 /**
  * @brief Default constructor of a trapezoid
  *
  * Initialize a trapezoid with no references to any point, segment, trapezoid or DAG leaf.
  */
-inline Trapezoid::Trapezoid() :
-    idSegmentT(NO_ID), idSegmentB(NO_ID), idPointL(NO_ID), idPointR(NO_ID),
-    idAdjacentTrapezoidTL(NO_ID), idAdjacentTrapezoidTR(NO_ID),
-    idAdjacentTrapezoidBL(NO_ID), idAdjacentTrapezoidBR(NO_ID),
+template<class Index>
+inline BasicTrapezoid<Index>::BasicTrapezoid() :
+    idSegmentT(NO_INDEX), idSegmentB(NO_INDEX), idPointL(NO_INDEX), idPointR(NO_INDEX),
+    idAdjacentTrapezoidTL(NO_INDEX), idAdjacentTrapezoidTR(NO_INDEX),
+    idAdjacentTrapezoidBL(NO_INDEX), idAdjacentTrapezoidBR(NO_INDEX),
     idDagLeaf(0)
 {
 }
@@ -29,12 +40,15 @@ inline Trapezoid::Trapezoid() :
  *
  * Initialize a trapezoid specifying all its data references.
  */
-inline Trapezoid::Trapezoid(size_t idSegmentT, size_t idSegmentB, size_t idPointL, size_t idPointR,
-                     size_t idTrapezoidTL, size_t idTrapezoidTR, size_t idTrapezoidBL, size_t idTrapezoidBR, size_t idDagLeaf) :
-    idSegmentT(idSegmentT), idSegmentB(idSegmentB), idPointL(idPointL), idPointR(idPointR),
-    idAdjacentTrapezoidTL(idTrapezoidTL), idAdjacentTrapezoidTR(idTrapezoidTR),
-    idAdjacentTrapezoidBL(idTrapezoidBL), idAdjacentTrapezoidBR(idTrapezoidBR),
-    idDagLeaf(idDagLeaf)
+template<class Index>
+inline BasicTrapezoid<Index>::BasicTrapezoid(size_t idSegmentT, size_t idSegmentB, size_t idPointL, size_t idPointR,
+                                             size_t idTrapezoidTL, size_t idTrapezoidTR, size_t idTrapezoidBL,
+                                             size_t idTrapezoidBR, size_t idDagLeaf) :
+    idSegmentT(toIndex(idSegmentT)), idSegmentB(toIndex(idSegmentB)),
+    idPointL(toIndex(idPointL)), idPointR(toIndex(idPointR)),
+    idAdjacentTrapezoidTL(toIndex(idTrapezoidTL)), idAdjacentTrapezoidTR(toIndex(idTrapezoidTR)),
+    idAdjacentTrapezoidBL(toIndex(idTrapezoidBL)), idAdjacentTrapezoidBR(toIndex(idTrapezoidBR)),
+    idDagLeaf(toIndex(idDagLeaf))
 {
 }
 
@@ -42,162 +56,206 @@ inline Trapezoid::Trapezoid(size_t idSegmentT, size_t idSegmentB, size_t idPoint
  * @brief Get the ID of the top segment
  * @return The ID of the top segment
  */
-inline size_t Trapezoid::getIdSegmentT() const
+template<class Index>
+inline size_t BasicTrapezoid<Index>::getIdSegmentT() const
 {
-    return idSegmentT;
+    return toId(idSegmentT);
 }
 
 /**
  * @brief Set the ID of the top segment
  * @param[in] id The new ID of the top segment
  */
-inline void Trapezoid::setIdSegmentT(size_t id)
+template<class Index>
+inline void BasicTrapezoid<Index>::setIdSegmentT(size_t id)
 {
-    idSegmentT = id;
+    idSegmentT = toIndex(id);
 }
 
 /**
  * @brief Get the ID of the bottom segment
  * @return The ID of the bottom segment
  */
-inline size_t Trapezoid::getIdSegmentB() const
+template<class Index>
+inline size_t BasicTrapezoid<Index>::getIdSegmentB() const
 {
-    return idSegmentB;
+    return toId(idSegmentB);
 }
 
 /**
  * @brief Set the ID of the bottom segment
  * @param[in] id The new ID of the bottom segment
  */
-inline void Trapezoid::setIdSegmentB(size_t id)
+template<class Index>
+inline void BasicTrapezoid<Index>::setIdSegmentB(size_t id)
 {
-    idSegmentB = id;
+    idSegmentB = toIndex(id);
 }
 
 /**
  * @brief Get the ID of the left point
  * @return The ID of the left point
  */
-inline size_t Trapezoid::getIdPointL() const
+template<class Index>
+inline size_t BasicTrapezoid<Index>::getIdPointL() const
 {
-    return idPointL;
+    return toId(idPointL);
 }
 
 /**
  * @brief Set the ID of the left point
  * @param[in] id The new ID of the left point
  */
-inline void Trapezoid::setIdPointL(size_t id)
+template<class Index>
+inline void BasicTrapezoid<Index>::setIdPointL(size_t id)
 {
-    idPointL = id;
+    idPointL = toIndex(id);
 }
 
 /**
  * @brief Get the ID of the right point
  * @return The ID of the right point
  */
-inline size_t Trapezoid::getIdPointR() const
+template<class Index>
+inline size_t BasicTrapezoid<Index>::getIdPointR() const
 {
-    return idPointR;
+    return toId(idPointR);
 }
 
 /**
  * @brief Set the ID of the right point
  * @param[in] id The new ID of the right point
  */
-inline void Trapezoid::setIdPointR(size_t id)
+template<class Index>
+inline void BasicTrapezoid<Index>::setIdPointR(size_t id)
 {
-    idPointR = id;
+    idPointR = toIndex(id);
 }
 
 /**
  * @brief Get the ID of the adjacent top-left trapezoid
  * @return The ID of the adjacent top-left trapezoid
  */
-inline size_t Trapezoid::getIdAdjacencyTL() const
+template<class Index>
+inline size_t BasicTrapezoid<Index>::getIdAdjacencyTL() const
 {
-    return idAdjacentTrapezoidTL;
+    return toId(idAdjacentTrapezoidTL);
 }
 
 /**
  * @brief Set the ID of the adjacent top-left trapezoid
  * @param[in] id The new ID of the adjacent top-left trapezoid
  */
-inline void Trapezoid::setIdAdjacencyTL(size_t id)
+template<class Index>
+inline void BasicTrapezoid<Index>::setIdAdjacencyTL(size_t id)
 {
-    idAdjacentTrapezoidTL = id;
+    idAdjacentTrapezoidTL = toIndex(id);
 }
 
 /**
  * @brief Get the ID of the adjacent top-right trapezoid
  * @return The ID of the adjacent top-right trapezoid
  */
-inline size_t Trapezoid::getIdAdjacencyTR() const
+template<class Index>
+inline size_t BasicTrapezoid<Index>::getIdAdjacencyTR() const
 {
-    return idAdjacentTrapezoidTR;
+    return toId(idAdjacentTrapezoidTR);
 }
 
 /**
  * @brief Set the ID of the adjacent top-right trapezoid
  * @param[in] id The new ID of the adjacent top-right trapezoid
  */
-inline void Trapezoid::setIdAdjacencyTR(size_t id)
+template<class Index>
+inline void BasicTrapezoid<Index>::setIdAdjacencyTR(size_t id)
 {
-    idAdjacentTrapezoidTR = id;
+    idAdjacentTrapezoidTR = toIndex(id);
 }
 
 /**
  * @brief Get the ID of the adjacent bottom-left trapezoid
  * @return The ID of the adjacent bottom-left trapezoid
  */
-inline size_t Trapezoid::getIdAdjacencyBL() const
+template<class Index>
+inline size_t BasicTrapezoid<Index>::getIdAdjacencyBL() const
 {
-    return idAdjacentTrapezoidBL;
+    return toId(idAdjacentTrapezoidBL);
 }
 
 /**
  * @brief Set the ID of the adjacent bottom-left trapezoid
  * @param[in] id The new ID of the adjacent bottom-left trapezoid
  */
-inline void Trapezoid::setIdAdjacencyBL(size_t id)
+template<class Index>
+inline void BasicTrapezoid<Index>::setIdAdjacencyBL(size_t id)
 {
-    idAdjacentTrapezoidBL = id;
+    idAdjacentTrapezoidBL = toIndex(id);
 }
 
 /**
  * @brief Get the ID of the adjacent bottom-right trapezoid
  * @return The ID of the adjacent bottom-right trapezoid
  */
-inline size_t Trapezoid::getIdAdjacencyBR() const
+template<class Index>
+inline size_t BasicTrapezoid<Index>::getIdAdjacencyBR() const
 {
-    return idAdjacentTrapezoidBR;
+    return toId(idAdjacentTrapezoidBR);
 }
 
 /**
  * @brief Set the ID of the adjacent bottom-right trapezoid
  * @param[in] id The new ID of the adjacent bottom-right trapezoid
  */
-inline void Trapezoid::setIdAdjacencyBR(size_t id)
+template<class Index>
+inline void BasicTrapezoid<Index>::setIdAdjacencyBR(size_t id)
 {
-    idAdjacentTrapezoidBR = id;
+    idAdjacentTrapezoidBR = toIndex(id);
 }
 
 /**
  * @brief Get the ID of the DAG leaf related to this trapezoid
  * @return The ID of the DAG leaf related to this trapezoid
  */
-inline size_t Trapezoid::getIdDagLeaf() const
+template<class Index>
+inline size_t BasicTrapezoid<Index>::getIdDagLeaf() const
 {
-    return idDagLeaf;
+    return toId(idDagLeaf);
 }
 
 /**
  * @brief Set the ID of the DAG leaf related to this trapezoid
  * @param[in] id The new ID of the DAG leaf related to this trapezoid
  */
-inline void Trapezoid::setIdDagLeaf(size_t id)
+template<class Index>
+inline void BasicTrapezoid<Index>::setIdDagLeaf(size_t id)
+{
+    idDagLeaf = toIndex(id);
+}
+
+/**
+ * @brief Convert a stored index to an ID
+ * @param[in] index The stored index
+ * @return The ID, NO_ID if the index is NO_INDEX
+ */
+template<class Index>
+inline size_t BasicTrapezoid<Index>::toId(Index index)
+{
+    return index == NO_INDEX ? NO_ID : static_cast<size_t>(index);
+}
+
+/**
+ * @brief Convert an ID to a stored index
+ * @param[in] id The ID, at most MAX_ID or NO_ID
+ * @return The index, NO_INDEX if the ID is NO_ID (the narrowing conversion maps NO_ID to NO_INDEX)
+ *
+ * Throws std::overflow_error if the ID does not fit in the index, instead of silently truncating it.
+ */
+template<class Index>
+inline Index BasicTrapezoid<Index>::toIndex(size_t id)
 {
-    idDagLeaf = id;
+    if (id > MAX_ID && id != NO_ID)
+        throw std::overflow_error("The ID does not fit in the index type of the trapezoid");
+    return static_cast<Index>(id);
 }
 
 } // End namespace gasprj
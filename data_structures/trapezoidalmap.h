@@ -15,27 +15,39 @@ namespace gasprj {
  *
  * This class defines the trapezoidal map data structures, storing all the trapezoids defined by a set of segments in
  * general position. Stores a reference to the dataset of points and segments.
+ *
+ * The methods are not virtual, so the accesses of the construction and of the queries are inlined. The additions,
+ * the overwrites and the deletions of the trapezoids are notified to an optional observer (e.g. the drawable version
+ * of the map), which keeps its own data in sync.
  */
 class TrapezoidalMap
 {
 public:
+    /* Classes */
+    class Observer;
+
     /* Constructors */
     TrapezoidalMap(TrapezoidalMapDataset *const trapezoidalMapDataset,
                    const cg3::Point2d &boundingBoxCornerBL, const cg3::Point2d &boundingBoxCornerTR);
 
 
     /* Public methods */
-    virtual Trapezoid &getTrapezoid(size_t id);
-    virtual const Trapezoid &getTrapezoid(size_t id) const;
-    virtual size_t size() const;
+    Trapezoid &getTrapezoid(size_t id);
+    const Trapezoid &getTrapezoid(size_t id) const;
+    size_t size() const;
 
-    virtual void addTrapezoid(const Trapezoid &trapezoid);
-    virtual void overwriteTrapezoid(const Trapezoid &trapezoid, size_t id);
+    void reserve(size_t n);
+    void addTrapezoid(const Trapezoid &trapezoid);
+    void overwriteTrapezoid(const Trapezoid &trapezoid, size_t id);
+    void removeLastTrapezoid();
 
     TrapezoidalMapDataset *getRefTrapezoidalMapDataset();
     const TrapezoidalMapDataset *getRefTrapezoidalMapDataset() const;
     const cg3::BoundingBox2 &getBoundingBox() const;
 
+    Observer *getObserver() const;
+    void setObserver(Observer *observer);
+
     void clear();
 
 protected:
@@ -43,6 +55,27 @@ protected:
     std::vector<Trapezoid> trapezoids;
     TrapezoidalMapDataset *const refTrapezoidalMapDataset;
     cg3::BoundingBox2 boundingBox;
+    Observer *observer;
+};
+
+/**
+ * @brief The observer of the changes of a trapezoidal map
+ *
+ * The notifications follow the changes. Only the additions, the overwrites and the removals of whole trapezoids are
+ * notified: the construction changes in place only the adjacencies and the DAG leaves, which do not change the shape
+ * of a trapezoid.
+ */
+class TrapezoidalMap::Observer
+{
+public:
+    /* Destructor */
+    virtual ~Observer() = default;
+
+    /* Notifications */
+    virtual void trapezoidAdded(const TrapezoidalMap &trapMap, size_t id) = 0;
+    virtual void trapezoidOverwritten(const TrapezoidalMap &trapMap, size_t id) = 0;
+    virtual void trapezoidRemoved(const TrapezoidalMap &trapMap, size_t id) = 0;
+    virtual void trapezoidsCleared(const TrapezoidalMap &trapMap) = 0;
 };
 
 } // End namespace gasprj
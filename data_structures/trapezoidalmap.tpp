@@ -1,5 +1,8 @@
 #include "trapezoidalmap.h"
 
+#include <cassert>
+#include <stdexcept>
+
 namespace gasprj {
 
 /**
@@ -11,7 +14,8 @@ namespace gasprj {
 inline TrapezoidalMap::TrapezoidalMap(TrapezoidalMapDataset *const refTrapezoidalMapDataset,
                                const cg3::Point2d &boundingBoxCornerBL, const cg3::Point2d &boundingBoxCornerTR) :
     refTrapezoidalMapDataset(refTrapezoidalMapDataset),
-    boundingBox(cg3::Point2d(boundingBoxCornerBL),cg3::Point2d(boundingBoxCornerTR))
+    boundingBox(cg3::Point2d(boundingBoxCornerBL),cg3::Point2d(boundingBoxCornerTR)),
+    observer(nullptr)
 {
 }
 
@@ -46,13 +50,27 @@ inline size_t TrapezoidalMap::size() const
     return trapezoids.size();
 }
 
+/**
+ * @brief Reserve space for the trapezoids of the trapezoidal map
+ * @param[in] n The total number of trapezoids the trapezoidal map should be able to store without reallocating
+ */
+inline void TrapezoidalMap::reserve(size_t n)
+{
+    trapezoids.reserve(n);
+}
+
 /**
  * @brief Add a new trapezoid to the trapezoidal map
  * @param[in] trapezoid The new trapezoid
+ *
+ * Throws std::overflow_error if the ID of the new trapezoid would not fit in the references of the trapezoids.
  */
 inline void TrapezoidalMap::addTrapezoid(const Trapezoid &trapezoid)
 {
+    if (trapezoids.size() > Trapezoid::MAX_ID)
+        throw std::overflow_error("Too many trapezoids for the index type of the trapezoids");
     trapezoids.push_back(trapezoid);
+    if (observer != nullptr) observer->trapezoidAdded(*this, trapezoids.size()-1);
 }
 
 /**
@@ -64,6 +82,20 @@ inline void TrapezoidalMap::overwriteTrapezoid(const Trapezoid &trapezoid, size_
 {
     assert(id < trapezoids.size());
     trapezoids[id] = trapezoid;
+    if (observer != nullptr) observer->trapezoidOverwritten(*this, id);
+}
+
+/**
+ * @brief Remove the last trapezoid of the trapezoidal map
+ *
+ * The IDs of the trapezoids are their positions, so only the last one can be removed: to remove another trapezoid,
+ * overwrite it with the last one first (updating the references to the moved trapezoid).
+ */
+inline void TrapezoidalMap::removeLastTrapezoid()
+{
+    assert(!trapezoids.empty());
+    trapezoids.pop_back();
+    if (observer != nullptr) observer->trapezoidRemoved(*this, trapezoids.size());
 }
 
 /**
@@ -93,12 +125,31 @@ inline const cg3::BoundingBox2 &TrapezoidalMap::getBoundingBox() const
     return boundingBox;
 }
 
+/**
+ * @brief Get the observer of the changes of the trapezoidal map
+ * @return The observer, nullptr if none
+ */
+inline TrapezoidalMap::Observer *TrapezoidalMap::getObserver() const
+{
+    return observer;
+}
+
+/**
+ * @brief Set the observer of the changes of the trapezoidal map
+ * @param[in] observer The new observer (nullptr to remove the current one)
+ */
+inline void TrapezoidalMap::setObserver(Observer *observer)
+{
+    this->observer = observer;
+}
+
 /**
  * @brief Delete all the trapezoids stored in the trapezoidal map
  */
 inline void TrapezoidalMap::clear()
 {
     trapezoids.clear();
+    if (observer != nullptr) observer->trapezoidsCleared(*this);
 }
 
 } // End namespace gasprj
@@ -1,5 +1,17 @@
 #include "trapezoidalmap_dataset.h"
 
+#include <algorithm>
+#include <thread>
+
+#include "data_structures/segment_bvh.h"
+
+namespace {
+
+//Minimum number of segments checked by a thread
+const size_t MIN_SEGMENTS_PER_THREAD = 1024;
+
+}
+
 TrapezoidalMapDataset::TrapezoidalMapDataset() :
     boundingBox(cg3::Point2d(0,0),cg3::Point2d(0,0))
 {
@@ -150,6 +162,138 @@ size_t TrapezoidalMapDataset::addIndexedSegment(const IndexedSegment2d& indexedS
     return id;
 }
 
+/*
+ * Add a set of segments, with the same result of adding them one at a time with addSegment.
+ * The intersections of every new segment with the segments already in the dataset, and the pairs of intersecting new
+ * segments (querying a flat BVH built over the new segments, which prunes the candidates on both axes), are computed
+ * in parallel. Then the segments are accepted or rejected in order, a segment being rejected if it intersects an
+ * already accepted one.
+ */
+std::vector<TrapezoidalMapDataset::SegmentInsertion> TrapezoidalMapDataset::addSegments(
+        const std::vector<cg3::Segment2d>& segments, unsigned int nThreads)
+{
+    size_t n = segments.size();
+
+    std::vector<cg3::Segment2d> orderedSegments;
+    orderedSegments.reserve(n);
+    for (const cg3::Segment2d& segment : segments) {
+        if (segment.p2() < segment.p1())
+            orderedSegments.push_back(cg3::Segment2d(segment.p2(), segment.p1()));
+        else
+            orderedSegments.push_back(segment);
+    }
+
+    //Hierarchy of the new segments, to find the intersecting pairs
+    gasprj::SegmentBVH batchBvh;
+    batchBvh.build(orderedSegments);
+
+    if (nThreads == 0)
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    nThreads = static_cast<unsigned int>(
+                std::min<size_t>(nThreads, std::max<size_t>(1, n / MIN_SEGMENTS_PER_THREAD)));
+
+    //Intersections with the segments in the dataset, and pairs (next, previous) of intersecting new segments
+    std::vector<char> intersectingDataset(n, false);
+    std::vector<std::vector<std::pair<size_t, size_t>>> intersectingPairs(nThreads);
+
+    auto checkIntersectionsRange = [&](unsigned int t) {
+        std::vector<size_t> overlappingIds;
+        for (size_t id1 = n * t / nThreads; id1 < n * (t+1) / nThreads; id1++) {
+            intersectingDataset[id1] = intersectionChecker.checkIntersections(orderedSegments[id1]);
+
+            //Every pair is found from both its segments, and kept from the next one
+            overlappingIds.clear();
+            batchBvh.findOverlaps(orderedSegments[id1], &SegmentIntersectionChecker::checkSegmentIntersection,
+                                  overlappingIds);
+            for (size_t id2 : overlappingIds) {
+                if (id2 < id1)
+                    intersectingPairs[t].push_back(std::make_pair(id1, id2));
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < nThreads; t++)
+        threads.push_back(std::thread(checkIntersectionsRange, t));
+    checkIntersectionsRange(0);
+    for (std::thread& thread : threads)
+        thread.join();
+
+    std::vector<std::vector<size_t>> intersectingNew(n);
+    for (const std::vector<std::pair<size_t, size_t>>& pairs : intersectingPairs) {
+        for (const std::pair<size_t, size_t>& pair : pairs)
+            intersectingNew[pair.first].push_back(pair.second);
+    }
+
+    //Accept or reject the segments in order
+    std::vector<SegmentInsertion> results(n);
+    std::vector<cg3::Segment2d> insertedSegments;
+
+    for (size_t i = 0; i < n; i++) {
+        const cg3::Segment2d& orderedSegment = orderedSegments[i];
+
+        bool found;
+        findSegment(orderedSegment, found);
+
+        if (orderedSegment.p1() == orderedSegment.p2()) {
+            results[i] = SegmentInsertion::Degenerate;
+            continue;
+        }
+        if (found) {
+            results[i] = SegmentInsertion::Duplicate;
+            continue;
+        }
+
+        bool foundPoint1;
+        size_t id1 = findPoint(orderedSegment.p1(), foundPoint1);
+        bool foundPoint2;
+        size_t id2 = findPoint(orderedSegment.p2(), foundPoint2);
+
+        if ((!foundPoint1 && xCoordSet.find(orderedSegment.p1().x()) != xCoordSet.end()) ||
+                (!foundPoint2 && xCoordSet.find(orderedSegment.p2().x()) != xCoordSet.end())) {
+            results[i] = SegmentInsertion::NotGeneralPosition;
+            continue;
+        }
+
+        bool intersecting = intersectingDataset[i];
+        for (size_t j : intersectingNew[i])
+            intersecting |= results[j] == SegmentInsertion::Inserted;
+        if (intersecting) {
+            results[i] = SegmentInsertion::Intersecting;
+            continue;
+        }
+
+        results[i] = SegmentInsertion::Inserted;
+
+        if (!foundPoint1) {
+            bool insertedPoint1;
+            id1 = addPoint(orderedSegment.p1(), insertedPoint1);
+            assert(insertedPoint1);
+        }
+
+        if (!foundPoint2) {
+            bool insertedPoint2;
+            id2 = addPoint(orderedSegment.p2(), insertedPoint2);
+            assert(insertedPoint2);
+        }
+        assert(id1 != id2 && id1 < points.size() && id2 < points.size());
+
+        IndexedSegment2d indexedSegment(id1, id2);
+        if (indexedSegment.second < indexedSegment.first) {
+            std::swap(indexedSegment.first, indexedSegment.second);
+        }
+
+        segmentMap.insert(std::make_pair(indexedSegment, indexedSegments.size()));
+        indexedSegments.push_back(indexedSegment);
+
+        insertedSegments.push_back(orderedSegment);
+    }
+
+    intersectionChecker.insert(insertedSegments);
+
+    return results;
+}
+
 size_t TrapezoidalMapDataset::findPoint(const cg3::Point2d &point, bool &found)
 {
     std::unordered_map<cg3::Point2d, size_t>::iterator it = pointMap.find(point);
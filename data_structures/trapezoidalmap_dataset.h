@@ -22,11 +22,15 @@ public:
 
     typedef std::pair<size_t, size_t> IndexedSegment2d;
 
+    //Outcome of the insertion of a segment
+    enum class SegmentInsertion { Inserted, Degenerate, Duplicate, NotGeneralPosition, Intersecting };
+
     TrapezoidalMapDataset();
 
     size_t addPoint(const cg3::Point2d& point, bool& pointInserted);
     size_t addSegment(const cg3::Segment2d& segment, bool& segmentInserted);
     size_t addIndexedSegment(const IndexedSegment2d& segment, bool& segmentInserted);
+    std::vector<SegmentInsertion> addSegments(const std::vector<cg3::Segment2d>& segments, unsigned int nThreads = 0);
 
     size_t findPoint(const cg3::Point2d& point, bool& found);
     size_t findSegment(const cg3::Segment2d& segment, bool& found);
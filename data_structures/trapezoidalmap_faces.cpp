@@ -0,0 +1,250 @@
+#include "trapezoidalmap_faces.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include <cg3/geometry/segment2.h>
+
+namespace gasprj {
+
+constexpr size_t TrapezoidalMapFaces::NO_ID;
+constexpr size_t TrapezoidalMapFaces::NO_LABEL;
+constexpr size_t TrapezoidalMapFaces::OUTER_FACE;
+
+/**
+ * @brief Default constructor of the faces, with no faces
+ */
+TrapezoidalMapFaces::TrapezoidalMapFaces()
+{
+}
+
+/**
+ * @brief Constructor of the faces of a trapezoidal map, with no labels
+ * @param[in] trapMap The trapezoidal map data structure
+ */
+TrapezoidalMapFaces::TrapezoidalMapFaces(const TrapezoidalMap &trapMap)
+{
+    build(trapMap);
+}
+
+/**
+ * @brief Get the face containing a trapezoid
+ * @param[in] idTrapezoid The ID of the trapezoid
+ * @return The ID of the face
+ */
+size_t TrapezoidalMapFaces::getFace(size_t idTrapezoid) const
+{
+    assert(idTrapezoid < trapezoidFaces.size());
+    return trapezoidFaces[idTrapezoid];
+}
+
+/**
+ * @brief Get the face above a segment
+ * @param[in] idSegment The ID of the segment in the trapezoidal map dataset
+ * @return The ID of the face, NO_ID if the segment is not in the trapezoidal map
+ */
+size_t TrapezoidalMapFaces::getFaceAbove(size_t idSegment) const
+{
+    return segmentSideFace(2*idSegment);
+}
+
+/**
+ * @brief Get the face below a segment
+ * @param[in] idSegment The ID of the segment in the trapezoidal map dataset
+ * @return The ID of the face, NO_ID if the segment is not in the trapezoidal map
+ */
+size_t TrapezoidalMapFaces::getFaceBelow(size_t idSegment) const
+{
+    return segmentSideFace(2*idSegment + 1);
+}
+
+/**
+ * @brief Get the label of a face
+ * @param[in] idFace The ID of the face
+ * @return The label of the face, NO_LABEL if it has not been labelled
+ */
+size_t TrapezoidalMapFaces::getLabel(size_t idFace) const
+{
+    assert(idFace < faceLabels.size());
+    return faceLabels[idFace];
+}
+
+/**
+ * @brief Get the label of the face containing a trapezoid
+ * @param[in] idTrapezoid The ID of the trapezoid
+ * @return The label of the face, NO_LABEL if it has not been labelled
+ */
+size_t TrapezoidalMapFaces::getTrapezoidLabel(size_t idTrapezoid) const
+{
+    return faceLabels[getFace(idTrapezoid)];
+}
+
+/**
+ * @brief Get the number of faces
+ * @return The number of faces, 0 if they have not been built
+ */
+size_t TrapezoidalMapFaces::size() const
+{
+    return faceLabels.size();
+}
+
+/**
+ * @brief Set the label of a face
+ * @param[in] idFace The ID of the face
+ * @param[in] label The new label of the face (NO_LABEL to remove it)
+ */
+void TrapezoidalMapFaces::setLabel(size_t idFace, size_t label)
+{
+    assert(idFace < faceLabels.size());
+    faceLabels[idFace] = label;
+}
+
+/**
+ * @brief Set the label of the face inside a polygon, whose edges are segments of the trapezoidal map
+ * @param[in] polygon The vertices of the polygon, in clockwise or counterclockwise order
+ * @param[in] label The new label of the face
+ * @param[in] trapMapData The trapezoidal map dataset (could be const, but the 'find' method is not declared const)
+ * @return The ID of the labelled face, NO_ID if no edge of the polygon is a segment of the trapezoidal map
+ *
+ * The face inside the polygon is the one on the inner side of its edges, i.e. on the left of the edges if the
+ * vertices are in counterclockwise order: the first edge found in the trapezoidal map identifies it.
+ */
+size_t TrapezoidalMapFaces::labelPolygon(const std::vector<cg3::Point2d> &polygon, size_t label,
+                                         TrapezoidalMapDataset &trapMapData)
+{
+    // Twice the signed area of the polygon, positive if the vertices are in counterclockwise order
+    double area = 0;
+    for (size_t i = 0; i < polygon.size(); ++i) {
+        const cg3::Point2d &p = polygon[i], &q = polygon[(i+1) % polygon.size()];
+        area += p.x()*q.y() - q.x()*p.y();
+    }
+
+    for (size_t i = 0; i < polygon.size(); ++i) {
+        const cg3::Point2d &p = polygon[i], &q = polygon[(i+1) % polygon.size()];
+        bool found;
+        size_t idSegment = trapMapData.findSegment(cg3::Segment2d(p, q), found);
+        if (!found) continue;
+
+        // The left side of an edge directed rightwards is above it
+        size_t idFace = (q.x() > p.x()) == (area > 0) ? getFaceAbove(idSegment) : getFaceBelow(idSegment);
+        if (idFace != NO_ID) {
+            faceLabels[idFace] = label;
+            return idFace;
+        }
+    }
+    return NO_ID;
+}
+
+/**
+ * @brief Find the faces of a trapezoidal map, keeping the labels of the faces found before
+ * @param[in] trapMap The trapezoidal map data structure
+ *
+ * The flood fill visits every trapezoid and every adjacency once, then the faces are sorted by the sides of the
+ * segments identifying them, so the build takes O(n log n) time in the number of trapezoids. A label is moved to the
+ * face now identified by the same side of the same segment, and dropped if the segment is no longer in the map.
+ */
+void TrapezoidalMapFaces::build(const TrapezoidalMap &trapMap)
+{
+    // Labels of the faces found before, by the segment sides identifying them
+    std::vector<std::pair<size_t, size_t>> keyLabels;
+    for (size_t idFace = 0; idFace < faceLabels.size(); ++idFace)
+        if (faceLabels[idFace] != NO_LABEL)
+            keyLabels.push_back(std::make_pair(faceKeys[idFace], faceLabels[idFace]));
+
+    // Flood fill the adjacency graph, starting from a trapezoid touching the bounding box, so that the outer face is
+    // the first component
+    size_t nTrapezoids = trapMap.size(), idStart = 0;
+    while (idStart < nTrapezoids && trapMap.getTrapezoid(idStart).getIdSegmentT() != Trapezoid::NO_ID)
+        ++idStart;
+    if (idStart == nTrapezoids) idStart = 0;
+
+    std::vector<size_t> components(nTrapezoids, NO_ID), componentKeys, stack;
+    for (size_t i = 0; i < nTrapezoids; ++i) {
+        size_t idTrapezoid = (idStart + i) % nTrapezoids;
+        if (components[idTrapezoid] != NO_ID) continue;
+
+        size_t idComponent = componentKeys.size(), key = NO_ID;
+        components[idTrapezoid] = idComponent;
+        stack.push_back(idTrapezoid);
+        while (!stack.empty()) {
+            const Trapezoid &trap = trapMap.getTrapezoid(stack.back());
+            stack.pop_back();
+
+            // The trapezoid lies above its bottom segment and below its top segment
+            if (trap.getIdSegmentB() != Trapezoid::NO_ID) key = std::min(key, 2*trap.getIdSegmentB());
+            if (trap.getIdSegmentT() != Trapezoid::NO_ID) key = std::min(key, 2*trap.getIdSegmentT() + 1);
+
+            for (size_t idAdjacent : {trap.getIdAdjacencyTL(), trap.getIdAdjacencyTR(),
+                                      trap.getIdAdjacencyBL(), trap.getIdAdjacencyBR()}) {
+                if (idAdjacent != Trapezoid::NO_ID && components[idAdjacent] == NO_ID) {
+                    components[idAdjacent] = idComponent;
+                    stack.push_back(idAdjacent);
+                }
+            }
+        }
+        componentKeys.push_back(idComponent == OUTER_FACE ? NO_ID : key);
+    }
+
+    // Number the faces by their keys, the outer face first
+    std::vector<size_t> order(componentKeys.size());
+    for (size_t idComponent = 0; idComponent < order.size(); ++idComponent)
+        order[idComponent] = idComponent;
+    if (!order.empty())
+        std::sort(order.begin()+1, order.end(), [&componentKeys](size_t a, size_t b) {
+            return componentKeys[a] < componentKeys[b];
+        });
+
+    std::vector<size_t> componentFaces(order.size());
+    faceKeys.resize(order.size());
+    for (size_t idFace = 0; idFace < order.size(); ++idFace) {
+        componentFaces[order[idFace]] = idFace;
+        faceKeys[idFace] = componentKeys[order[idFace]];
+    }
+
+    // Faces of the trapezoids and of the sides of the segments
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+    trapezoidFaces.resize(nTrapezoids);
+    segmentFaces.assign(2*trapMapData.getIndexedSegments().size(), NO_ID);
+    for (size_t idTrapezoid = 0; idTrapezoid < nTrapezoids; ++idTrapezoid) {
+        const Trapezoid &trap = trapMap.getTrapezoid(idTrapezoid);
+        size_t idFace = componentFaces[components[idTrapezoid]];
+        trapezoidFaces[idTrapezoid] = idFace;
+        if (trap.getIdSegmentB() != Trapezoid::NO_ID) segmentFaces[2*trap.getIdSegmentB()] = idFace;
+        if (trap.getIdSegmentT() != Trapezoid::NO_ID) segmentFaces[2*trap.getIdSegmentT() + 1] = idFace;
+    }
+
+    // Labels of the faces identified by the same segment sides
+    faceLabels.assign(order.size(), NO_LABEL);
+    for (const std::pair<size_t, size_t> &keyLabel : keyLabels) {
+        size_t idFace = keyLabel.first == NO_ID ? OUTER_FACE : segmentSideFace(keyLabel.first);
+        if (idFace < faceLabels.size()) faceLabels[idFace] = keyLabel.second;
+    }
+}
+
+/**
+ * @brief Remove all the faces and their labels
+ */
+void TrapezoidalMapFaces::clear()
+{
+    trapezoidFaces.clear();
+    segmentFaces.clear();
+    faceKeys.clear();
+    faceLabels.clear();
+}
+
+
+
+/* Internal methods declaration */
+
+/**
+ * @brief Get the face on a side of a segment
+ * @param[in] key The side of the segment, twice the ID of the segment plus 1 for the side below
+ * @return The ID of the face, NO_ID if the segment is not in the trapezoidal map
+ */
+size_t TrapezoidalMapFaces::segmentSideFace(size_t key) const
+{
+    return key < segmentFaces.size() ? segmentFaces[key] : NO_ID;
+}
+
+} // End namespace gasprj
@@ -0,0 +1,79 @@
+#ifndef TRAPEZOIDALMAP_FACES_H
+#define TRAPEZOIDALMAP_FACES_H
+
+#include <limits>
+#include <vector>
+
+#include <cg3/geometry/point2.h>
+
+#include "data_structures/trapezoidalmap.h"
+#include "data_structures/trapezoidalmap_dataset.h"
+
+namespace gasprj {
+
+/**
+ * @brief The faces of the planar subdivision induced by the segments of a trapezoidal map, with their labels
+ *
+ * Two trapezoids sharing a vertical side are separated only by the vertical extension of a point, so they lie in the
+ * same face of the subdivision: the faces are the connected components of the adjacency graph of the trapezoids,
+ * found by a flood fill. Every face is above or below some segment (the faces are bounded by the segments, except the
+ * outer face, that touches the bounding box), and every side of a segment bounds exactly one face, so a face is
+ * identified by the first side of a segment bounding it. The IDs of the faces follow this order, with the outer face
+ * first: they depend only on the segments, not on the trapezoids, so they are the same for every construction of the
+ * same segments.
+ *
+ * Every face can be given a label (e.g. the ID of the zone it represents), which the point location queries return
+ * instead of the trapezoid. The faces must be built again after the trapezoidal map is modified: the labels are kept
+ * by the sides of the segments identifying their faces, so they survive the rebuilds of the map and the changes that
+ * do not involve the segment identifying the face.
+ */
+class TrapezoidalMapFaces
+{
+public:
+    /**
+     * @brief Definition of no reference to any face
+     */
+    static constexpr size_t NO_ID = std::numeric_limits<size_t>::max();
+
+    /**
+     * @brief Label of the faces that have not been labelled
+     */
+    static constexpr size_t NO_LABEL = std::numeric_limits<size_t>::max();
+
+    /**
+     * @brief ID of the outer face, the one touching the bounding box
+     */
+    static constexpr size_t OUTER_FACE = 0;
+
+    /* Constructors */
+    TrapezoidalMapFaces();
+    TrapezoidalMapFaces(const TrapezoidalMap &trapMap);
+
+    /* Public methods */
+    size_t getFace(size_t idTrapezoid) const;
+    size_t getFaceAbove(size_t idSegment) const;
+    size_t getFaceBelow(size_t idSegment) const;
+    size_t getLabel(size_t idFace) const;
+    size_t getTrapezoidLabel(size_t idTrapezoid) const;
+    size_t size() const;
+
+    void setLabel(size_t idFace, size_t label);
+    size_t labelPolygon(const std::vector<cg3::Point2d> &polygon, size_t label, TrapezoidalMapDataset &trapMapData);
+
+    void build(const TrapezoidalMap &trapMap);
+    void clear();
+
+private:
+    /* Internal methods declaration */
+    size_t segmentSideFace(size_t key) const;
+
+    /* Attributes */
+    std::vector<size_t> trapezoidFaces;   // Face of every trapezoid
+    std::vector<size_t> segmentFaces;     // Faces above (even) and below (odd) every segment, NO_ID if not in the map
+    std::vector<size_t> faceKeys;         // First segment side bounding every face (NO_ID for the outer face)
+    std::vector<size_t> faceLabels;       // Label of every face
+};
+
+} // End namespace gasprj
+
+#endif // TRAPEZOIDALMAP_FACES_H
@@ -1,53 +1,215 @@
 #include "drawable_trapezoidalmap.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <GL/glu.h>
+
 namespace gasprj {
 
+/* Private static constants */
+const float DrawableTrapezoidalMap::TRAPEZOID_TRANSPARENCY = 0.25;
+const cg3::Color DrawableTrapezoidalMap::COLOR_TRAPEZOID_SELECTED = cg3::Color(0.5*255, 0.5*255, 0.5*255, 0.75*255);
+const cg3::Color DrawableTrapezoidalMap::COLOR_VERTICAL_LINE = cg3::Color(0.1*255, 0.1*255, 0.1*255, 0.75*255);
+const float DrawableTrapezoidalMap::WIDTH_VERTICAL_LINE = 0.50;
+const cg3::Color DrawableTrapezoidalMap::COLOR_DENSITY = cg3::Color(0.1*255, 0.1*255, 0.1*255, 0.75*255);
+
+
+
+/**
+ * @brief Draw the trapezoidal map
+ *
+ * The render-side arrays are updated first. The quadtree then gives the trapezoids around the visible region, larger
+ * than the level of detail, whose vertical sides and faces are drawn with one draw call each, and the cells of the
+ * level of detail aggregating the smaller trapezoids, drawn as a density raster.
+ */
+void DrawableTrapezoidalMap::draw() const
+{
+    updateArrays();
+    if (vertices.empty()) return;
+
+    // Visible region and level of detail: the first level whose cells are smaller than the threshold on the screen
+    LooseQuadtree::Box region;
+    double pixelSize;
+    size_t lodLevel = quadtree.getDepth()+1;
+    if (visibleRegion(region, pixelSize)) {
+        lodLevel = 0;
+        while (lodLevel <= quadtree.getDepth() &&
+               std::min(quadtree.getCellWidth(lodLevel), quadtree.getCellHeight(lodLevel)) >= LOD_CELL_PIXELS*pixelSize)
+            ++lodLevel;
+    }
+    else {
+        float inf = std::numeric_limits<float>::infinity();
+        region = LooseQuadtree::Box{-inf, -inf, inf, inf};
+    }
+    quadtree.query(region, lodLevel, idsVisible, cellsVisible);
+
+    // Indices of the faces and of the left (top-left, bottom-left) and right (top-right, bottom-right) sides of the
+    // trapezoids whose bounding box intersects the region (the loose cells also give the nearby trapezoids)
+    quadIndices.clear();
+    sideIndices.clear();
+    for (uint32_t id : idsVisible) {
+        const float *v = &vertices[id*VERTEX_COORDINATES];
+        if (v[0] > region.maxX || v[2] < region.minX || std::min(v[5], v[7]) > region.maxY ||
+                std::max(v[1], v[3]) < region.minY)
+            continue;
+        uint32_t firstVertex = id*4;
+        quadIndices.insert(quadIndices.end(), {firstVertex, firstVertex+1, firstVertex+2, firstVertex+3});
+        sideIndices.insert(sideIndices.end(), {firstVertex, firstVertex+3, firstVertex+1, firstVertex+2});
+    }
+
+    if (!cellsVisible.empty()) drawDensityRaster(pixelSize);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, vertices.data());
+
+    // Draw the vertical sides
+    glLineWidth(WIDTH_VERTICAL_LINE);
+    glColor4d(COLOR_VERTICAL_LINE.redF(), COLOR_VERTICAL_LINE.greenF(),
+              COLOR_VERTICAL_LINE.blueF(), COLOR_VERTICAL_LINE.alphaF());
+    glDrawElements(GL_LINES, static_cast<GLsizei>(sideIndices.size()), GL_UNSIGNED_INT, sideIndices.data());
+
+    // Draw the trapezoids
+    glEnableClientState(GL_COLOR_ARRAY);
+    glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors.data());
+    glDrawElements(GL_QUADS, static_cast<GLsizei>(quadIndices.size()), GL_UNSIGNED_INT, quadIndices.data());
+    glDisableClientState(GL_COLOR_ARRAY);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+
+
 /* Internal methods declaration */
 
 /**
- * @brief Compute the vertices of a drawable trapezoid
- * @param[in,out] dTrap The drawable trapezoid
+ * @brief Compute the region of the plane z = 0 visible in the current viewport
+ * @param[out] region The bounding box of the visible region
+ * @param[out] pixelSize The size of a pixel in the plane (the largest between its width and height)
+ * @return True if the region is bounded, false otherwise (e.g. the horizon of a perspective view is visible)
+ *
+ * The corners of the viewport are unprojected with the current OpenGL matrices, and their rays are intersected with
+ * the plane.
+ */
+bool DrawableTrapezoidalMap::visibleRegion(LooseQuadtree::Box &region, double &pixelSize) const
+{
+    GLdouble modelview[16], projection[16];
+    GLint viewport[4];
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (viewport[2] <= 0 || viewport[3] <= 0) return false;
+
+    double minX = std::numeric_limits<double>::max(), minY = minX;
+    double maxX = std::numeric_limits<double>::lowest(), maxY = maxX;
+    for (size_t corner = 0; corner < 4; ++corner) {
+        GLdouble winX = viewport[0] + ((corner & 1) ? viewport[2] : 0);
+        GLdouble winY = viewport[1] + ((corner & 2) ? viewport[3] : 0);
+        GLdouble nearX, nearY, nearZ, farX, farY, farZ;
+        if (gluUnProject(winX, winY, 0, modelview, projection, viewport, &nearX, &nearY, &nearZ) != GL_TRUE ||
+                gluUnProject(winX, winY, 1, modelview, projection, viewport, &farX, &farY, &farZ) != GL_TRUE)
+            return false;
+
+        // Intersection of the ray with the plane z = 0, which must lie between the near and the far plane
+        if (nearZ == farZ) return false;
+        double t = nearZ / (nearZ - farZ);
+        if (!(t >= 0 && t <= 1)) return false;
+        double x = nearX + t*(farX - nearX), y = nearY + t*(farY - nearY);
+        minX = std::min(minX, x), maxX = std::max(maxX, x);
+        minY = std::min(minY, y), maxY = std::max(maxY, y);
+    }
+
+    region = LooseQuadtree::Box{static_cast<float>(minX), static_cast<float>(minY),
+                                static_cast<float>(maxX), static_cast<float>(maxY)};
+    pixelSize = std::max((maxX - minX) / viewport[2], (maxY - minY) / viewport[3]);
+    return pixelSize > 0;
+}
+
+/**
+ * @brief Draw the visible cells of the level of detail as a density raster
+ * @param[in] pixelSize The size of a pixel in the plane
+ *
+ * The opacity of a cell is the number of trapezoids it aggregates per pixel, up to the opacity of the vertical sides
+ * that would cover it if the trapezoids were drawn.
  */
-void DrawableTrapezoidalMap::setDrawableTrapezoidVertices(DrawableTrapezoid &dTrap)
+void DrawableTrapezoidalMap::drawDensityRaster(double pixelSize) const
 {
+    rasterVertices.resize(cellsVisible.size()*VERTEX_COORDINATES);
+    rasterColors.resize(cellsVisible.size()*COLOR_COMPONENTS);
+    for (size_t i = 0; i < cellsVisible.size(); ++i) {
+        const LooseQuadtree::Cell &cell = cellsVisible[i];
+        float *v = &rasterVertices[i*VERTEX_COORDINATES];
+        v[0] = cell.box.minX, v[1] = cell.box.maxY, v[2] = cell.box.maxX, v[3] = cell.box.maxY;
+        v[4] = cell.box.maxX, v[5] = cell.box.minY, v[6] = cell.box.minX, v[7] = cell.box.minY;
+
+        double pixels = (cell.box.maxX - cell.box.minX) * (cell.box.maxY - cell.box.minY) / (pixelSize*pixelSize);
+        double density = std::min(1.0, cell.count / std::max(pixels, 1.0));
+        uint8_t *c = &rasterColors[i*COLOR_COMPONENTS];
+        for (size_t j = 0; j < 4; ++j, c += 4) {
+            c[0] = static_cast<uint8_t>(COLOR_DENSITY.red()), c[1] = static_cast<uint8_t>(COLOR_DENSITY.green());
+            c[2] = static_cast<uint8_t>(COLOR_DENSITY.blue());
+            c[3] = static_cast<uint8_t>(std::lround(density*COLOR_DENSITY.alpha()));
+        }
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, rasterVertices.data());
+    glColorPointer(4, GL_UNSIGNED_BYTE, 0, rasterColors.data());
+    glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(cellsVisible.size()*4));
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+/**
+ * @brief Compute the vertices of a trapezoid, storing them in the cache and indexing its bounding box
+ * @param[in] id The ID of the trapezoid
+ */
+void DrawableTrapezoidalMap::computeTrapezoidVertices(size_t id) const
+{
+    const Trapezoid &trap = trapMap.getTrapezoid(id);
+    const TrapezoidalMapDataset &trapMapData = *trapMap.getRefTrapezoidalMapDataset();
+    const cg3::BoundingBox2 &boundingBox = trapMap.getBoundingBox();
+
     // The actual segments and points defining the trapezoid
     cg3::Segment2d segmentT, segmentB;
     cg3::Point2d pointL, pointR;
 
-    if(dTrap.getIdPointL() == Trapezoid::NO_ID || dTrap.getIdPointR() == Trapezoid::NO_ID)
-        assert(dTrap.getIdSegmentT() == Trapezoid::NO_ID && dTrap.getIdSegmentB() == Trapezoid::NO_ID);
+    if(trap.getIdPointL() == Trapezoid::NO_ID || trap.getIdPointR() == Trapezoid::NO_ID)
+        assert(trap.getIdSegmentT() == Trapezoid::NO_ID && trap.getIdSegmentB() == Trapezoid::NO_ID);
 
     /* Retrieve the points and segments from the dataset */
 
     // Retrieve the left point
-    if (dTrap.getIdPointL() != Trapezoid::NO_ID)
-        pointL = this->getRefTrapezoidalMapDataset()->getPoint(dTrap.getIdPointL());
+    if (trap.getIdPointL() != Trapezoid::NO_ID)
+        pointL = trapMapData.getPoint(trap.getIdPointL());
     else
-        pointL = cg3::Point2d(this->getBoundingBox().min().x(), this->getBoundingBox().max().y());
+        pointL = cg3::Point2d(boundingBox.min().x(), boundingBox.max().y());
 
     // Retrieve the right point
-    if (dTrap.getIdPointR() != Trapezoid::NO_ID)
-        pointR = this->getRefTrapezoidalMapDataset()->getPoint(dTrap.getIdPointR());
+    if (trap.getIdPointR() != Trapezoid::NO_ID)
+        pointR = trapMapData.getPoint(trap.getIdPointR());
     else
-        pointR = cg3::Point2d(this->getBoundingBox().max().x(), this->getBoundingBox().max().y());
+        pointR = cg3::Point2d(boundingBox.max().x(), boundingBox.max().y());
 
     // Retrieve the top segment
-    if (dTrap.getIdSegmentT() != Trapezoid::NO_ID) {
-        segmentT = this->getRefTrapezoidalMapDataset()->getSegment(dTrap.getIdSegmentT());
+    if (trap.getIdSegmentT() != Trapezoid::NO_ID) {
+        segmentT = trapMapData.getSegment(trap.getIdSegmentT());
         if (segmentT.p1().x() > segmentT.p2().x()) segmentT = cg3::Segment2d(segmentT.p2(), segmentT.p1());
     }
     else
-        segmentT = cg3::Segment2d(cg3::Point2d(this->getBoundingBox().min().x(), this->getBoundingBox().max().y()),
-                                  cg3::Point2d(this->getBoundingBox().max().x(), this->getBoundingBox().max().y()));
+        segmentT = cg3::Segment2d(cg3::Point2d(boundingBox.min().x(), boundingBox.max().y()),
+                                  cg3::Point2d(boundingBox.max().x(), boundingBox.max().y()));
 
     // Retrieve the bottom segment
-    if (dTrap.getIdSegmentB() != Trapezoid::NO_ID) {
-        segmentB = this->getRefTrapezoidalMapDataset()->getSegment(dTrap.getIdSegmentB());
+    if (trap.getIdSegmentB() != Trapezoid::NO_ID) {
+        segmentB = trapMapData.getSegment(trap.getIdSegmentB());
         if (segmentB.p1().x() > segmentB.p2().x()) segmentB = cg3::Segment2d(segmentB.p2(), segmentB.p1());
     }
     else
-        segmentB = cg3::Segment2d(cg3::Point2d(this->getBoundingBox().min().x(), this->getBoundingBox().min().y()),
-                                  cg3::Point2d(this->getBoundingBox().max().x(), this->getBoundingBox().min().y()));
+        segmentB = cg3::Segment2d(cg3::Point2d(boundingBox.min().x(), boundingBox.min().y()),
+                                  cg3::Point2d(boundingBox.max().x(), boundingBox.min().y()));
 
     /* Compute the intersections between the segments and the vertical lines passing through the points */
 
@@ -55,18 +217,13 @@ void DrawableTrapezoidalMap::setDrawableTrapezoidVertices(DrawableTrapezoid &dTr
     double mT = (segmentT.p2().y()-segmentT.p1().y()) / (segmentT.p2().x()-segmentT.p1().x());
     double mB = (segmentB.p2().y()-segmentB.p1().y()) / (segmentB.p2().x()-segmentB.p1().x());
 
-    dTrap.setVertexTL(cg3::Point2d(pointL.x(), segmentT.p1().y() + mT * (pointL.x() - segmentT.p1().x()))); // Top-left
-    dTrap.setVertexTR(cg3::Point2d(pointR.x(), segmentT.p2().y() - mT * (segmentT.p2().x() - pointR.x()))); // Top-right
-    dTrap.setVertexBR(cg3::Point2d(pointR.x(), segmentB.p2().y() - mB * (segmentB.p2().x() - pointR.x()))); // Bottom-right
-    dTrap.setVertexBL(cg3::Point2d(pointL.x(), segmentB.p1().y() + mB * (pointL.x() - segmentB.p1().x()))); // Bottom-left
-
-    /* Compute the bounding box for the drawable object */
-    dTrap.setBoundingBox(
-        cg3::Point2d(std::min(dTrap.getVertexTL().x(), dTrap.getVertexBL().x()),
-                     std::min(dTrap.getVertexBL().y(), dTrap.getVertexBR().y())),   // Bottom-left corner
-        cg3::Point2d(std::max(dTrap.getVertexTR().x(), dTrap.getVertexBR().x()),
-                     std::max(dTrap.getVertexTL().y(), dTrap.getVertexTR().y()))    // Top-right corner
-    );
+    float *v = &vertices[id*VERTEX_COORDINATES];
+    v[0] = pointL.x(), v[1] = segmentT.p1().y() + mT * (pointL.x() - segmentT.p1().x());   // Top-left
+    v[2] = pointR.x(), v[3] = segmentT.p2().y() - mT * (segmentT.p2().x() - pointR.x());   // Top-right
+    v[4] = pointR.x(), v[5] = segmentB.p2().y() - mB * (segmentB.p2().x() - pointR.x());   // Bottom-right
+    v[6] = pointL.x(), v[7] = segmentB.p1().y() + mB * (pointL.x() - segmentB.p1().x());   // Bottom-left
+
+    quadtree.update(id, LooseQuadtree::Box{v[0], std::min(v[5], v[7]), v[2], std::max(v[1], v[3])});
 }
 
 } // End namespace gasprj
@@ -1,25 +1,45 @@
 #ifndef DRAWABLE_TRAPEZOIDALMAP_H
 #define DRAWABLE_TRAPEZOIDALMAP_H
 
+#include <cstdint>
+#include <vector>
+
 #include <cg3/viewer/interfaces/drawable_object.h>
+#include <cg3/utilities/color.h>
 
+#include "data_structures/loose_quadtree.h"
 #include "data_structures/trapezoidalmap.h"
-#include "drawables/drawable_trapezoid.h"
 
 namespace gasprj {
 
 /**
  * @brief The drawable version of the trapezoidal map data structure
  *
- * This class defines the drawable version of trapezoidal map, storing the ID of a selected trapezoid and redefining
- * the methods to add and overwrite a trapezoid, so that they create drawable trapezoids.
+ * This class draws a trapezoidal map, storing the ID of a selected trapezoid. It observes the map, while the map
+ * itself stays a plain (non-virtual) data structure.
+ *
+ * The render-side data are packed arrays with the 4 vertices of every trapezoid (as single-precision coordinates),
+ * their colors and the indices of the vertical sides. The notifications of the map only mark the overwritten
+ * trapezoids as outdated (and drop the removed ones), and the arrays are updated for the new and outdated trapezoids
+ * when a frame is drawn, so the construction costs the same as without the drawable map. The color of a trapezoid is
+ * derived from its ID.
+ *
+ * The arrays are drawn as OpenGL client-side vertex arrays, with a constant number of draw calls whatever the size of
+ * the map (OpenGL 1.1, available also on the software rasterizers).
+ *
+ * The bounding boxes of the trapezoids are indexed by a loose quadtree, so only the trapezoids around the visible region
+ * of the canvas are drawn. The trapezoids smaller than a few pixels are not drawn one by one: they are aggregated in the
+ * cells of the quadtree as large as a few pixels, drawn as a raster whose opacity is the density of the trapezoids.
+ * The cost of a frame depends on what is visible on the screen, and not on the size of the map.
  */
-class DrawableTrapezoidalMap : public TrapezoidalMap, public cg3::DrawableObject
+class DrawableTrapezoidalMap : public cg3::DrawableObject, public TrapezoidalMap::Observer
 {
 public:
-    /* Constructors */
-    DrawableTrapezoidalMap(TrapezoidalMapDataset *const trapezoidalMapDataset,
-                           const cg3::Point2d &boundingBoxCornerBL, const cg3::Point2d &boundingBoxCornerTR);
+    /* Constructors/destructor */
+    DrawableTrapezoidalMap(TrapezoidalMap &trapMap);
+    DrawableTrapezoidalMap(const DrawableTrapezoidalMap &) = delete;
+    DrawableTrapezoidalMap &operator=(const DrawableTrapezoidalMap &) = delete;
+    ~DrawableTrapezoidalMap();
 
     /* Drawable */
     void draw() const;
@@ -28,23 +48,59 @@ public:
     size_t getIdHighlightedTrapezoid() const;
     void setIdHighlightedTrapezoid(size_t id);
 
-    /* Public methods */
-    virtual Trapezoid &getTrapezoid(size_t id);
-    virtual const Trapezoid &getTrapezoid(size_t id) const;
-    virtual size_t size() const;
+    /* Observer */
+    void trapezoidAdded(const TrapezoidalMap &trapMap, size_t id);
+    void trapezoidOverwritten(const TrapezoidalMap &trapMap, size_t id);
+    void trapezoidRemoved(const TrapezoidalMap &trapMap, size_t id);
+    void trapezoidsCleared(const TrapezoidalMap &trapMap);
 
-    virtual void addTrapezoid(const Trapezoid &trapezoid);
-    virtual void overwriteTrapezoid(const Trapezoid &trapezoid, size_t id);
+private:
+    /* Private static constants */
+    static const float TRAPEZOID_TRANSPARENCY;
+    static const cg3::Color COLOR_TRAPEZOID_SELECTED;
+    static const cg3::Color COLOR_VERTICAL_LINE;
+    static const float WIDTH_VERTICAL_LINE;
+    static const cg3::Color COLOR_DENSITY;
 
-    void clear();
+    /**
+     * @brief Size (in pixels) of the cells aggregating the trapezoids: the smaller trapezoids are drawn as a raster
+     */
+    static constexpr double LOD_CELL_PIXELS = 4;
+
+    /**
+     * @brief Number of coordinates stored for every trapezoid (top-left, top-right, bottom-right, bottom-left vertex)
+     */
+    static constexpr size_t VERTEX_COORDINATES = 8;
+
+    /**
+     * @brief Number of color components stored for every trapezoid (RGBA of each vertex)
+     */
+    static constexpr size_t COLOR_COMPONENTS = 16;
 
-private:
     /* Internal methods declaration */
-    void setDrawableTrapezoidVertices(DrawableTrapezoid &dTrap);
-    void setDrawableTrapezoidColor(DrawableTrapezoid &dTrap);
+    void updateArrays() const;
+    bool visibleRegion(LooseQuadtree::Box &region, double &pixelSize) const;
+    void drawDensityRaster(double pixelSize) const;
+    void computeTrapezoidVertices(size_t id) const;
+    void setTrapezoidColor(size_t id, bool highlighted) const;
+    static cg3::Color trapezoidColor(size_t id);
 
     /* Attributes */
-    std::vector<DrawableTrapezoid> trapezoids;
+    TrapezoidalMap &trapMap;
+    // Render-side arrays of the first trapezoids of the map, and the trapezoids overwritten since their update
+    mutable std::vector<float> vertices;
+    mutable std::vector<uint8_t> colors;
+    mutable std::vector<bool> outdated;
+    mutable std::vector<size_t> idsOutdated;
+    mutable size_t idColoredHighlight;
+    // Spatial index of the cached trapezoids, and the visible trapezoids and density cells of the last frame
+    mutable LooseQuadtree quadtree;
+    mutable std::vector<uint32_t> idsVisible;
+    mutable std::vector<LooseQuadtree::Cell> cellsVisible;
+    mutable std::vector<uint32_t> quadIndices;
+    mutable std::vector<uint32_t> sideIndices;
+    mutable std::vector<float> rasterVertices;
+    mutable std::vector<uint8_t> rasterColors;
     size_t idHighlightedTrapezoid;
 };
 
@@ -1,5 +1,9 @@
 #include "drawable_trapezoidalmap.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
 #include <GL/gl.h>
 
 #include <cg3/viewer/opengl_objects/opengl_objects2.h>
@@ -8,25 +12,23 @@ namespace gasprj {
 
 /**
  * @brief The constructor of the drawable trapezoidal map
- * @param[in] refTrapezoidalMapDataset The reference to the trapezoidal map dataset
- * @param[in] boundingBoxCornerBL The bottom-left corner of the bounding box
- * @param[in] boundingBoxCornerTR The top-right corner of the bounding box
+ * @param[in] trapMap The trapezoidal map to draw, observed until the destruction of the drawable trapezoidal map
  */
-inline DrawableTrapezoidalMap::DrawableTrapezoidalMap(TrapezoidalMapDataset *const trapezoidalMapDataset,
-                                               const cg3::Point2d &boundingBoxCornerBL, const cg3::Point2d &boundingBoxCornerTR) :
-    TrapezoidalMap(trapezoidalMapDataset, boundingBoxCornerBL, boundingBoxCornerTR),
+inline DrawableTrapezoidalMap::DrawableTrapezoidalMap(TrapezoidalMap &trapMap) :
+    trapMap(trapMap),
+    idColoredHighlight(Trapezoid::NO_ID),
+    quadtree(trapMap.getBoundingBox()),
     idHighlightedTrapezoid(Trapezoid::NO_ID)
 {
+    trapMap.setObserver(this);
 }
 
 /**
- * @brief Draw the trapezoidal map
+ * @brief The destructor of the drawable trapezoidal map, which stops observing the trapezoidal map
  */
-inline void DrawableTrapezoidalMap::draw() const
+inline DrawableTrapezoidalMap::~DrawableTrapezoidalMap()
 {
-    // Cycle over all the drawable trapezoids
-    for (const DrawableTrapezoid &drawableTrapezoid : trapezoids)
-        drawableTrapezoid.draw();
+    if (trapMap.getObserver() == this) trapMap.setObserver(nullptr);
 }
 
 /**
@@ -35,7 +37,7 @@ inline void DrawableTrapezoidalMap::draw() const
  */
 inline cg3::Point3d DrawableTrapezoidalMap::sceneCenter() const
 {
-    return cg3::Point3d(this->boundingBox.center().x(), this->boundingBox.center().y(), 0);
+    return cg3::Point3d(trapMap.getBoundingBox().center().x(), trapMap.getBoundingBox().center().y(), 0);
 }
 
 /**
@@ -44,7 +46,7 @@ inline cg3::Point3d DrawableTrapezoidalMap::sceneCenter() const
  */
 inline double DrawableTrapezoidalMap::sceneRadius() const
 {
-    return this->boundingBox.diag();
+    return trapMap.getBoundingBox().diag();
 }
 
 /**
@@ -62,98 +64,141 @@ inline size_t DrawableTrapezoidalMap::getIdHighlightedTrapezoid() const
  */
 inline void DrawableTrapezoidalMap::setIdHighlightedTrapezoid(size_t id)
 {
-    assert(id != Trapezoid::NO_ID ? id < trapezoids.size() : true);
-    // Un-select the previous highlighted trapezoid
-    if (idHighlightedTrapezoid != Trapezoid::NO_ID) trapezoids[idHighlightedTrapezoid].setHighlighted(false);
-    // Highlights the new trapezoid
+    assert(id != Trapezoid::NO_ID ? id < trapMap.size() : true);
     idHighlightedTrapezoid = id;
-    if (idHighlightedTrapezoid != Trapezoid::NO_ID) trapezoids[idHighlightedTrapezoid].setHighlighted(true);
 }
 
 /**
- * @brief Get a reference to the specified drawable trapezoid from the drawable trapezoidal map
- * @param[in] id The ID of the drawable trapezoid
- * @return A reference to the specified drawable trapezoid
+ * @brief Take note of a trapezoid added to the trapezoidal map
+ * @param[in] trapMap The observed trapezoidal map
+ * @param[in] id The ID of the new trapezoid
+ *
+ * The trapezoids beyond the cached ones are computed at the next frame, so nothing has to be done.
  */
-inline Trapezoid &DrawableTrapezoidalMap::getTrapezoid(size_t id)
+inline void DrawableTrapezoidalMap::trapezoidAdded(const TrapezoidalMap &trapMap, size_t id)
 {
-    assert(id < trapezoids.size());
-    return trapezoids[id];
+    (void) trapMap;
+    (void) id;
 }
 
 /**
- * @brief Get a non-modifiable reference to the specified drawable trapezoid from the drawable trapezoidal map
- * @param[in] id The ID of the drawable trapezoid
- * @return A costant reference to the specified drawable trapezoid
+ * @brief Mark a trapezoid overwritten in the trapezoidal map as outdated
+ * @param[in] trapMap The observed trapezoidal map
+ * @param[in] id The ID of the overwritten trapezoid
  */
-inline const Trapezoid &DrawableTrapezoidalMap::getTrapezoid(size_t id) const
+inline void DrawableTrapezoidalMap::trapezoidOverwritten(const TrapezoidalMap &trapMap, size_t id)
 {
-    assert(id < trapezoids.size());
-    return trapezoids[id];
+    (void) trapMap;
+    if (id < outdated.size() && !outdated[id]) {
+        outdated[id] = true;
+        idsOutdated.push_back(id);
+    }
 }
 
 /**
- * @brief Get the number of drawable trapezoids in the drawable trapezoidal map
- * @return The number of drawable trapezoids in the drawable trapezoidal map
+ * @brief Delete the render-side data of the trapezoid removed from the end of the trapezoidal map
+ * @param[in] trapMap The observed trapezoidal map
+ * @param[in] id The ID of the removed trapezoid
  */
-inline size_t DrawableTrapezoidalMap::size() const
+inline void DrawableTrapezoidalMap::trapezoidRemoved(const TrapezoidalMap &trapMap, size_t id)
 {
-    return trapezoids.size();
+    (void) trapMap;
+    if (id < outdated.size()) {
+        if (outdated[id]) idsOutdated.erase(std::find(idsOutdated.begin(), idsOutdated.end(), id));
+        vertices.resize(id*VERTEX_COORDINATES);
+        colors.resize(id*COLOR_COMPONENTS);
+        outdated.resize(id);
+        quadtree.remove(id);
+    }
+    if (idColoredHighlight == id) idColoredHighlight = Trapezoid::NO_ID;
+    if (idHighlightedTrapezoid == id) idHighlightedTrapezoid = Trapezoid::NO_ID;
 }
 
 /**
- * @brief Add a new drawable trapezoid to the drawable trapezoidal map
- * @param[in] trapezoid The new trapezoid, converted to its drawable version
+ * @brief Delete the render-side arrays, after the trapezoidal map has been cleared
+ * @param[in] trapMap The observed trapezoidal map
  */
-inline void DrawableTrapezoidalMap::addTrapezoid(const Trapezoid &trapezoid)
+inline void DrawableTrapezoidalMap::trapezoidsCleared(const TrapezoidalMap &trapMap)
 {
-    DrawableTrapezoid drawableTrapezoid = DrawableTrapezoid(trapezoid);
-    setDrawableTrapezoidVertices(drawableTrapezoid);
-    setDrawableTrapezoidColor(drawableTrapezoid);
-
-    trapezoids.push_back(drawableTrapezoid);
+    (void) trapMap;
+    vertices.clear();
+    colors.clear();
+    outdated.clear();
+    idsOutdated.clear();
+    idColoredHighlight = Trapezoid::NO_ID;
+    quadtree.reset(trapMap.getBoundingBox());
+    idHighlightedTrapezoid = Trapezoid::NO_ID;
 }
 
+
+
+/* Internal methods declaration */
+
 /**
- * @brief Overwrite the specified drawable trapezoid in the drawable trapezoidal map
- * @param[in] trapezoid The new trapezoid, converted to its drawable version
- * @param[in] id The ID of the drawable trapezoid to overwrite
+ * @brief Bring the render-side arrays up to date with the trapezoidal map
+ *
+ * Compute the vertices of the outdated trapezoids and the vertices and colors of the trapezoids added since the last
+ * update (indexing their bounding boxes), then move the highlight color to the highlighted trapezoid.
  */
-inline void DrawableTrapezoidalMap::overwriteTrapezoid(const Trapezoid &trapezoid, size_t id)
+inline void DrawableTrapezoidalMap::updateArrays() const
 {
-    assert(id < trapezoids.size());
-    DrawableTrapezoid drawableTrapezoid = DrawableTrapezoid(trapezoid);
-    setDrawableTrapezoidVertices(drawableTrapezoid);
-    setDrawableTrapezoidColor(drawableTrapezoid);
-
-    trapezoids[id] = drawableTrapezoid;
+    // Outdated trapezoids
+    for (size_t id : idsOutdated) {
+        computeTrapezoidVertices(id);
+        outdated[id] = false;
+    }
+    idsOutdated.clear();
+
+    // New trapezoids
+    size_t nCached = outdated.size();
+    if (nCached < trapMap.size()) {
+        vertices.resize(trapMap.size()*VERTEX_COORDINATES);
+        colors.resize(trapMap.size()*COLOR_COMPONENTS);
+        outdated.resize(trapMap.size(), false);
+        for (size_t id = nCached; id < trapMap.size(); ++id) {
+            computeTrapezoidVertices(id);
+            setTrapezoidColor(id, id == idColoredHighlight);
+        }
+    }
+
+    // Highlighted trapezoid
+    if (idColoredHighlight != idHighlightedTrapezoid) {
+        if (idColoredHighlight != Trapezoid::NO_ID) setTrapezoidColor(idColoredHighlight, false);
+        if (idHighlightedTrapezoid != Trapezoid::NO_ID) setTrapezoidColor(idHighlightedTrapezoid, true);
+        idColoredHighlight = idHighlightedTrapezoid;
+    }
 }
 
 /**
- * @brief Delete all the trapezoids stored in the drawable trapezoidal map
+ * @brief Set the color of the vertices of a trapezoid in the render-side arrays
+ * @param[in] id The ID of the trapezoid
+ * @param[in] highlighted True to use the color of the highlighted trapezoid
  */
-inline void DrawableTrapezoidalMap::clear() {
-    trapezoids.clear();
-    idHighlightedTrapezoid = Trapezoid::NO_ID;
+inline void DrawableTrapezoidalMap::setTrapezoidColor(size_t id, bool highlighted) const
+{
+    cg3::Color color = highlighted ? COLOR_TRAPEZOID_SELECTED : trapezoidColor(id);
+    float alpha = highlighted ? COLOR_TRAPEZOID_SELECTED.alphaF() : TRAPEZOID_TRANSPARENCY;
+    uint8_t *c = &colors[id*COLOR_COMPONENTS];
+    for (size_t i = 0; i < 4; ++i, c += 4) {
+        c[0] = static_cast<uint8_t>(color.red()), c[1] = static_cast<uint8_t>(color.green());
+        c[2] = static_cast<uint8_t>(color.blue()), c[3] = static_cast<uint8_t>(alpha*255);
+    }
 }
 
-
-
-/* Internal methods declaration */
-
 /**
- * @brief Set a random color to the drawable trapezoid
- * @param[in,out] dTrap The drawable trapezoid
+ * @brief Get the color of a trapezoid
+ * @param[in] id The ID of the trapezoid
+ * @return The color of the trapezoid
  *
- * Set the drawable trapezoid color with random:
- *  - hue in the interval [0,359]
- *  - saturation in the interval [192,255]
- *  - value in the interval [192,255]
- * Avoid the use of gray/black color, used instead for vertical lines and higlighted trapezoids
+ * The hue is a hash of the ID, the saturation and the value are in the interval [128,191]. Avoid the use of
+ * gray/black color, used instead for vertical lines and higlighted trapezoids.
  */
-inline void DrawableTrapezoidalMap::setDrawableTrapezoidColor(DrawableTrapezoid &dTrap)
+inline cg3::Color DrawableTrapezoidalMap::trapezoidColor(size_t id)
 {
-    dTrap.setColor(rand() % 359, 128 + rand() % 64, 128 + rand() % 64);
+    uint32_t hash = static_cast<uint32_t>(id) * 2654435761u;
+    cg3::Color color;
+    color.setHsv(hash >> 24, 128 + ((hash >> 16) & 63), 128 + ((hash >> 8) & 63));
+    return color;
 }
 
 } // End namespace gasprj
@@ -1,6 +1,6 @@
 #include "drawable_trapezoidalmap_dataset.h"
 
-#include <cg3/viewer/opengl_objects/opengl_objects2.h>
+#include <GL/gl.h>
 
 DrawableTrapezoidalMapDataset::DrawableTrapezoidalMapDataset() :
     pointColor(80, 180, 80),
@@ -13,11 +13,48 @@ DrawableTrapezoidalMapDataset::DrawableTrapezoidalMapDataset() :
 
 void DrawableTrapezoidalMapDataset::draw() const
 {
-    for (const cg3::Point2d& p : getPoints()) {
-        cg3::opengl::drawPoint2(p, pointColor, static_cast<int>(pointSize));
+    updateArrays();
+    if (pointCoordinates.empty()) return;
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, pointCoordinates.data());
+
+    glEnable(GL_POINT_SMOOTH);
+    glPointSize(pointSize);
+    glColor3f(pointColor.redF(), pointColor.greenF(), pointColor.blueF());
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(pointCoordinates.size()/2));
+
+    glLineWidth(segmentSize);
+    glColor3f(segmentColor.redF(), segmentColor.greenF(), segmentColor.blueF());
+    glDrawElements(GL_LINES, static_cast<GLsizei>(segmentIndices.size()), GL_UNSIGNED_INT, segmentIndices.data());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void DrawableTrapezoidalMapDataset::clear()
+{
+    TrapezoidalMapDataset::clear();
+    pointCoordinates.clear();
+    segmentIndices.clear();
+}
+
+//Copy the points and segments added since the previous frame (the dataset only grows, until it is cleared)
+void DrawableTrapezoidalMapDataset::updateArrays() const
+{
+    const std::vector<cg3::Point2d>& points = getPoints();
+    const std::vector<IndexedSegment2d>& segments = getIndexedSegments();
+    if (pointCoordinates.size() > points.size()*2 || segmentIndices.size() > segments.size()*2) {
+        pointCoordinates.clear();
+        segmentIndices.clear();
+    }
+
+    for (size_t i = pointCoordinates.size()/2; i < points.size(); i++) {
+        pointCoordinates.push_back(static_cast<float>(points[i].x()));
+        pointCoordinates.push_back(static_cast<float>(points[i].y()));
     }
-    for (const cg3::Segment2d& seg : getSegments()) {
-        cg3::opengl::drawLine2(seg.p1(), seg.p2(), segmentColor, static_cast<int>(segmentSize));
+    for (size_t i = segmentIndices.size()/2; i < segments.size(); i++) {
+        segmentIndices.push_back(static_cast<uint32_t>(segments[i].first));
+        segmentIndices.push_back(static_cast<uint32_t>(segments[i].second));
     }
 }
 
@@ -1,6 +1,9 @@
 #ifndef DRAWABLE_TRAPEZOIDALMAP_DATASET_H
 #define DRAWABLE_TRAPEZOIDALMAP_DATASET_H
 
+#include <cstdint>
+#include <vector>
+
 #include "data_structures/trapezoidalmap_dataset.h"
 
 #include <cg3/viewer/interfaces/drawable_object.h>
@@ -9,6 +12,9 @@
 
 /**
  * @brief Class to draw the segment container.
+ *
+ * The coordinates of the points and the endpoint indices of the segments are copied to render-side arrays when a frame
+ * is drawn (only the ones added since the previous frame), then drawn with one draw call each.
  */
 class DrawableTrapezoidalMapDataset : public TrapezoidalMapDataset, public cg3::DrawableObject
 {
@@ -33,14 +39,21 @@ public:
     unsigned int getSegmentSize() const;
     void setSegmentSize(unsigned int value);
 
+    void clear();
+
 private:
 
+    void updateArrays() const;
+
     cg3::Color pointColor;
     cg3::Color segmentColor;
 
     unsigned int pointSize;
     unsigned int segmentSize;
 
+    mutable std::vector<float> pointCoordinates;
+    mutable std::vector<uint32_t> segmentIndices;
+
 };
 
 #endif // DRAWABLE_TRAPEZOIDALMAP_DATASET_H
@@ -6,6 +6,7 @@
 #include <QInputDialog>
 
 #include <ctime>
+#include <random>
 #include <cg3/data_structures/arrays/arrays.h>
 #include <cg3/utilities/timer.h>
 
@@ -22,6 +23,9 @@
 //                         You have to write your code in the area below.
 //----------------------------------------------------------------------------------------------
 
+//Maximum depth of the DAG, as a multiple of log2(n+1), before the trapezoidal map is rebuilt
+#define MAX_DAG_DEPTH_FACTOR 4.0
+
 
 
 /* ----- Constructors/Destructors ----- */
@@ -37,11 +41,12 @@ TrapezoidalMapManager::TrapezoidalMapManager(QWidget *parent) :
     firstPointSelectedColor(220, 80, 80),
     firstPointSelectedSize(5),
     isFirstPointSelected(false),
-    drawableTrapezoidalMap(&drawableTrapezoidalMapDataset,
-                           cg3::Point2d(-BOUNDINGBOX, -BOUNDINGBOX), cg3::Point2d(BOUNDINGBOX, BOUNDINGBOX))
+    trapezoidalMap(&drawableTrapezoidalMapDataset,
+                   cg3::Point2d(-BOUNDINGBOX, -BOUNDINGBOX), cg3::Point2d(BOUNDINGBOX, BOUNDINGBOX)),
+    drawableTrapezoidalMap(trapezoidalMap)
 {
     // Initialize the trapezoidal map data structures
-    gasprj::initTrapezoidalMap(drawableTrapezoidalMap, dag);
+    gasprj::initTrapezoidalMap(trapezoidalMap, dag);
 
     // Enable openGL transparency (https://learnopengl.com/Advanced-OpenGL/Blending)
     glEnable(GL_BLEND);
@@ -213,7 +218,14 @@ void TrapezoidalMapManager::addSegmentToTrapezoidalMap(const cg3::Segment2d& seg
     //it more efficient in memory. However, depending on how you implement your algorithms and data 
     //structures, you could save directly the point (Point2d) in each trapezoid (it is fine).
     drawableTrapezoidalMap.setIdHighlightedTrapezoid(gasprj::Trapezoid::NO_ID);
-    gasprj::addSegmentToTrapezoidalMap(segment, drawableTrapezoidalMap, dag);
+    gasprj::addSegmentToTrapezoidalMap(segment, trapezoidalMap, dag);
+
+    // Check the depth of the DAG every time the number of segments doubles, rebuilding the map if it has degraded
+    size_t nSegments = drawableTrapezoidalMapDataset.getIndexedSegments().size();
+    if ((nSegments & (nSegments-1)) == 0 &&
+            gasprj::rebuildDegradedTrapezoidalMap(trapezoidalMap, dag, MAX_DAG_DEPTH_FACTOR,
+                                                  std::random_device()()))
+        std::cout << "DAG rebuilt, depth: " << dag.depth() << std::endl;
 
 
 
@@ -257,7 +269,7 @@ void TrapezoidalMapManager::queryTrapezoidalMap(const cg3::Point2d& queryPoint)
     //in the structure). This is a bit more complicated, but a better structure, because, in this case
     //TrapezoidalMap and DAG are two separate general purpose data structures that an algorithm uses.
     //THINK ABOUT YOUR STRUCTURE BEFORE WRITING CODE!
-    size_t id = gasprj::queryTrapezoidalMap(queryPoint, drawableTrapezoidalMap, dag);
+    size_t id = gasprj::queryTrapezoidalMap(queryPoint, trapezoidalMap, dag);
 
 
 
@@ -289,9 +301,9 @@ void TrapezoidalMapManager::clearTrapezoidalMap()
 {
     //---------------------------------------------------------------------
     //Clear here your trapezoidal map data structure.
-    drawableTrapezoidalMap.clear();
+    trapezoidalMap.clear();
     dag.clear();
-    gasprj::initTrapezoidalMap(drawableTrapezoidalMap, dag);
+    gasprj::initTrapezoidalMap(trapezoidalMap, dag);
 
 
 
@@ -304,6 +316,32 @@ void TrapezoidalMapManager::clearTrapezoidalMap()
 //---------------------------------------------------------------------
 //Define your private methods here if you need some
 
+/**
+ * @brief Launch the randomized construction of the trapezoidal map for a set of segments, on all the hardware threads
+ * @param[in] segments Segments
+ *
+ * Only the segments accepted by the dataset are inserted, once each: the slabs of the construction are split at their
+ * endpoints.
+ */
+void TrapezoidalMapManager::buildTrapezoidalMap(const std::vector<cg3::Segment2d>& segments)
+{
+    std::vector<cg3::Segment2d> insertedSegments;
+    std::vector<bool> isInserted(drawableTrapezoidalMapDataset.segmentNumber(), false);
+    for (const cg3::Segment2d& segment : segments) {
+        bool found;
+        size_t id = drawableTrapezoidalMapDataset.findSegment(segment, found);
+        if (found && !isInserted[id]) {
+            isInserted[id] = true;
+            insertedSegments.push_back(segment);
+        }
+    }
+
+    drawableTrapezoidalMap.setIdHighlightedTrapezoid(gasprj::Trapezoid::NO_ID);
+    size_t depth = gasprj::buildTrapezoidalMapParallel(insertedSegments, trapezoidalMap, dag, std::random_device()());
+    dag.optimizeLayout(trapezoidalMap);
+    std::cout << "DAG depth: " << depth << std::endl;
+}
+
 
 
 
@@ -333,10 +371,8 @@ void TrapezoidalMapManager::loadSegmentsTrapezoidalMapAndMeasureTime(const std::
     //Timer for evaluating the efficiency of the algorithm
     cg3::Timer t("Trapezoidal map construction");
 
-    //Launch incremental step for each segment
-    for (const cg3::Segment2d& segment : segments) {
-        addSegmentToTrapezoidalMap(segment);
-    }
+    //Launch incremental step for each segment, in a random order
+    buildTrapezoidalMap(segments);
 
     //Timer stop and visualization (both on console and UI)
     t.stopAndPrint();
@@ -549,9 +585,11 @@ void TrapezoidalMapManager::on_loadSegmentsButton_clicked() //Do not write code
 
         //Add to the dataset
         bool allSegmentInserted = true;
-        for (const cg3::Segment2d& segment : segments) {
-            bool insertedSegment;
-            drawableTrapezoidalMapDataset.addSegment(segment, insertedSegment);
+        std::vector<TrapezoidalMapDataset::SegmentInsertion> insertions =
+                drawableTrapezoidalMapDataset.addSegments(segments);
+        for (size_t i = 0; i < segments.size(); i++) {
+            const cg3::Segment2d& segment = segments[i];
+            bool insertedSegment = insertions[i] == TrapezoidalMapDataset::SegmentInsertion::Inserted;
 
             allSegmentInserted &= insertedSegment;
             if (!insertedSegment) {
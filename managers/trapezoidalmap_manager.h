@@ -58,6 +58,7 @@ private:
 
     //---------------------------------------------------------------------
     //Declare your attributes here
+    gasprj::TrapezoidalMap trapezoidalMap;
     gasprj::DrawableTrapezoidalMap drawableTrapezoidalMap;
     gasprj::DAG dag;
 
@@ -77,6 +78,7 @@ private:
 
     //---------------------------------------------------------------------
     //Declare your private methods here if you need some
+    void buildTrapezoidalMap(const std::vector<cg3::Segment2d>& segments);
 
 
 
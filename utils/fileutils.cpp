@@ -1,8 +1,13 @@
 #include "fileutils.h"
 
+#include <algorithm>
+#include <clocale>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
-#include <random>
-#include <iomanip>
+#include <thread>
 
 #include "assert.h"
 
@@ -10,47 +15,327 @@
 
 namespace FileUtils {
 
-std::vector<cg3::Segment2d> getSegmentsFromFile(const std::string& filename) {
+namespace {
+
+//Size of the blocks read from and written to the segment files
+const size_t BLOCK_SIZE = 1 << 22;
+
+//Minimum number of bytes decoded by a thread
+const size_t MIN_BYTES_PER_THREAD = 1 << 18;
+
+//Minimum number of bytes of a segment in a file ("0 0 0 0\n"), used to bound the reserved space
+const size_t MIN_BYTES_PER_SEGMENT = 8;
+
+//Maximum length of a number
+const size_t MAX_NUMBER_LENGTH = 64;
+
+//Powers of ten exactly representable as doubles
+const double EXACT_POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief Parse a number, without leading or trailing whitespaces
+ * @param[in] first The first character of the number
+ * @param[in] last The character after the last one of the number
+ * @param[in] decimalPoint The decimal point of the current locale, used by strtod
+ * @param[out] value The parsed number
+ * @return True if the number is valid, false otherwise
+ *
+ * Decimal numbers whose significand and power of ten are both exactly representable as doubles (up to 15 significant
+ * digits, as the ones of the files saved with a fixed precision) are parsed without depending on the locale, with a
+ * single multiplication or division, which is correctly rounded. The other numbers are parsed by strtod.
+ */
+bool parseNumber(const char *first, const char *last, char decimalPoint, double &value)
+{
+    const char *p = first;
+    bool negative = false;
+    if (p != last && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    //Significand and decimal exponent
+    uint64_t significand = 0;
+    int nDigits = 0, exponent = 0;
+    bool anyDigit = false, truncated = false;
+    for (; p != last && *p >= '0' && *p <= '9'; ++p) {
+        anyDigit = true;
+        if (nDigits < 19) {
+            significand = significand*10 + static_cast<uint64_t>(*p - '0');
+            if (significand != 0) ++nDigits;
+        }
+        else {
+            truncated = true;
+            ++exponent;
+        }
+    }
+    if (p != last && *p == '.') {
+        for (++p; p != last && *p >= '0' && *p <= '9'; ++p) {
+            anyDigit = true;
+            if (nDigits < 19) {
+                significand = significand*10 + static_cast<uint64_t>(*p - '0');
+                if (significand != 0) ++nDigits;
+                --exponent;
+            }
+            else {
+                truncated = true;
+            }
+        }
+    }
+    if (anyDigit && p != last && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        bool negativeExponent = false;
+        if (q != last && (*q == '-' || *q == '+')) {
+            negativeExponent = *q == '-';
+            ++q;
+        }
+        int explicitExponent = 0;
+        bool anyExponentDigit = false;
+        for (; q != last && *q >= '0' && *q <= '9'; ++q) {
+            anyExponentDigit = true;
+            if (explicitExponent < 10000) explicitExponent = explicitExponent*10 + (*q - '0');
+        }
+        if (anyExponentDigit) {
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            p = q;
+        }
+    }
+
+    //Fast path
+    if (anyDigit && p == last && !truncated && significand <= (uint64_t(1) << 53) &&
+            exponent >= -22 && exponent <= 22) {
+        value = static_cast<double>(significand);
+        if (exponent < 0) value /= EXACT_POWERS_OF_TEN[-exponent];
+        else value *= EXACT_POWERS_OF_TEN[exponent];
+        if (negative) value = -value;
+        return true;
+    }
+
+    //Slow path, replacing the decimal point with the one of the current locale
+    size_t length = static_cast<size_t>(last - first);
+    if (length >= MAX_NUMBER_LENGTH) return false;
+    char number[MAX_NUMBER_LENGTH];
+    std::memcpy(number, first, length);
+    number[length] = '\0';
+    if (decimalPoint != '.') std::replace(number, number + length, '.', decimalPoint);
+    char *end;
+    value = std::strtod(number, &end);
+    return end == number + length;
+}
+
+/**
+ * @brief Parse all the numbers separated by whitespaces in a range of characters
+ * @param[in] first The first character of the range
+ * @param[in] last The character after the last one of the range
+ * @param[in] decimalPoint The decimal point of the current locale
+ * @param[out] numbers The vector to which the parsed numbers are appended
+ * @return True if all the numbers are valid, false otherwise (the numbers before the invalid one are appended)
+ */
+bool parseNumbers(const char *first, const char *last, char decimalPoint, std::vector<double> &numbers)
+{
+    const char *p = first;
+    while (true) {
+        while (p != last && isSpace(*p)) ++p;
+        if (p == last) return true;
+
+        const char *numberEnd = p;
+        while (numberEnd != last && !isSpace(*numberEnd)) ++numberEnd;
+
+        double value;
+        if (!parseNumber(p, numberEnd, decimalPoint, value)) return false;
+        numbers.push_back(value);
+        p = numberEnd;
+    }
+}
+
+/**
+ * @brief Parse all the numbers separated by whitespaces in a range of characters, using multiple threads
+ * @param[in] first The first character of the range
+ * @param[in] last The character after the last one of the range
+ * @param[in] decimalPoint The decimal point of the current locale
+ * @param[in] nThreads The maximum number of threads to use
+ * @param[out] numbers The vector to which the parsed numbers are appended, in order
+ * @return True if all the numbers are valid, false otherwise
+ *
+ * The range is split in contiguous chunks at whitespaces, parsed in parallel and then concatenated.
+ */
+bool parseNumbers(const char *first, const char *last, char decimalPoint, unsigned int nThreads,
+                  std::vector<double> &numbers)
+{
+    size_t nBytes = static_cast<size_t>(last - first);
+    nThreads = static_cast<unsigned int>(std::min<size_t>(nThreads, std::max<size_t>(1, nBytes/MIN_BYTES_PER_THREAD)));
+    if (nThreads <= 1) return parseNumbers(first, last, decimalPoint, numbers);
+
+    //Split the range at whitespaces
+    std::vector<const char *> bounds(nThreads + 1);
+    bounds[0] = first;
+    bounds[nThreads] = last;
+    for (unsigned int i = 1; i < nThreads; i++) {
+        const char *bound = std::max(bounds[i-1], first + nBytes*i/nThreads);
+        while (bound != last && !isSpace(*bound)) ++bound;
+        bounds[i] = bound;
+    }
+
+    //Parse the chunks
+    std::vector<std::vector<double>> chunkNumbers(nThreads);
+    std::vector<char> chunkValid(nThreads);
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (unsigned int i = 1; i < nThreads; i++) {
+        threads.push_back(std::thread([&bounds, &chunkNumbers, &chunkValid, decimalPoint, i]() {
+            chunkValid[i] = parseNumbers(bounds[i], bounds[i+1], decimalPoint, chunkNumbers[i]);
+        }));
+    }
+    chunkValid[0] = parseNumbers(bounds[0], bounds[1], decimalPoint, chunkNumbers[0]);
+    for (std::thread &thread : threads)
+        thread.join();
+
+    //Concatenate the numbers, up to the first invalid one
+    for (unsigned int i = 0; i < nThreads; i++) {
+        numbers.insert(numbers.end(), chunkNumbers[i].begin(), chunkNumbers[i].end());
+        if (!chunkValid[i]) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Append a number to a string, with the shortest representation (up to 17 digits) parsed back to the same value
+ * @param[in] value The number
+ * @param[in] decimalPoint The decimal point of the current locale, replaced with '.'
+ * @param[in,out] buffer The string
+ */
+void appendNumber(double value, char decimalPoint, std::string &buffer)
+{
+    char number[MAX_NUMBER_LENGTH];
+    int length = std::snprintf(number, sizeof(number), "%.15g", value);
+    if (std::strtod(number, nullptr) != value)
+        length = std::snprintf(number, sizeof(number), "%.17g", value);
+    if (decimalPoint != '.') std::replace(number, number + length, decimalPoint, '.');
+    buffer.append(number, static_cast<size_t>(length));
+}
+
+}
+
+/**
+ * @brief Load the segments from a file
+ * @param[in] filename The path of the file
+ * @param[in] nThreads The maximum number of threads decoding the numbers (0 to use all the available hardware threads)
+ * @return The segments in the file
+ *
+ * The file is read in large blocks, each one decoded (in parallel, if more threads are used) before reading the next.
+ * The space for the segments is reserved from the count in the header of the file.
+ */
+std::vector<cg3::Segment2d> getSegmentsFromFile(const std::string& filename, unsigned int nThreads) {
     std::vector<cg3::Segment2d> segments;
-	
-	std::ifstream infile;
-    infile.open(filename);
-
-    int n;
-    infile >> n;
-
-    for (int i = 0; i < n; i++) {
-        double x = 0.0;
-        double y = 0.0;
-		
-        infile >> x >> y;
-        cg3::Point2d p1(x,y);
-		
-        infile >> x >> y;
-        cg3::Point2d p2(x,y);
-		
-        segments.push_back(cg3::Segment2d(p1, p2));
-    }
-	
+
+    std::ifstream infile(filename, std::ios::binary);
+    if (!infile)
+        return segments;
+
+    infile.seekg(0, std::ios::end);
+    size_t fileSize = static_cast<size_t>(infile.tellg());
+    infile.seekg(0, std::ios::beg);
+
+    if (nThreads == 0)
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    char decimalPoint = *std::localeconv()->decimal_point;
+
+    std::vector<char> buffer(BLOCK_SIZE);
+    std::vector<double> numbers;
+    size_t carried = 0;
+
+    bool headerRead = false;
+    size_t n = 0;
+    double coords[4];
+    size_t nCoords = 0;
+
+    while (true) {
+        //Read a block after the characters carried from the previous one
+        if (buffer.size() < carried + BLOCK_SIZE)
+            buffer.resize(carried + BLOCK_SIZE);
+        infile.read(buffer.data() + carried, BLOCK_SIZE);
+        size_t end = carried + static_cast<size_t>(infile.gcount());
+        bool lastBlock = !infile;
+
+        //Decode up to the last whitespace, carrying the truncated number to the next block
+        size_t cut = end;
+        if (!lastBlock)
+            while (cut > 0 && !isSpace(buffer[cut-1])) --cut;
+
+        numbers.clear();
+        bool valid = parseNumbers(buffer.data(), buffer.data() + cut, decimalPoint, nThreads, numbers);
+
+        for (double number : numbers) {
+            if (!headerRead) {
+                headerRead = true;
+                n = number > 0 ? static_cast<size_t>(number) : 0;
+                segments.reserve(std::min(n, fileSize/MIN_BYTES_PER_SEGMENT));
+            }
+            else {
+                coords[nCoords++] = number;
+                if (nCoords == 4) {
+                    nCoords = 0;
+                    segments.push_back(cg3::Segment2d(cg3::Point2d(coords[0], coords[1]),
+                                                      cg3::Point2d(coords[2], coords[3])));
+                }
+            }
+            if (headerRead && segments.size() == n)
+                return segments;
+        }
+
+        if (!valid || lastBlock)
+            break;
+
+        carried = end - cut;
+        std::memmove(buffer.data(), buffer.data() + cut, carried);
+    }
+
     return segments;
 }
 
+/**
+ * @brief Save the segments in a file
+ * @param[in] filename The path of the file
+ * @param[in] segments The segments
+ * @return The saved segments
+ *
+ * Every coordinate is written with the shortest representation that is parsed back to the same double.
+ */
 std::vector<cg3::Segment2d> saveSegmentsInFile(const std::string& filename, const std::vector<cg3::Segment2d>& segments) {
-    std::ofstream outfile;
-    outfile.open(filename);
+    std::ofstream outfile(filename, std::ios::binary);
+
+    char decimalPoint = *std::localeconv()->decimal_point;
 
-    outfile << segments.size() << std::endl;
+    std::string buffer = std::to_string(segments.size()) + '\n';
+    buffer.reserve(BLOCK_SIZE + 4*MAX_NUMBER_LENGTH);
 
     for (const cg3::Segment2d& segment : segments) {
         const cg3::Point2d& p1 = segment.p1();
         const cg3::Point2d& p2 = segment.p2();
 
-        outfile << std::fixed;
-        outfile << std::setprecision(4) << p1.x() << " " << std::setprecision(4) << p1.y() << " ";
-        outfile << std::setprecision(4) << p2.x() << " " << std::setprecision(4) << p2.y();
-        outfile << std::endl;
+        appendNumber(p1.x(), decimalPoint, buffer);
+        buffer += ' ';
+        appendNumber(p1.y(), decimalPoint, buffer);
+        buffer += ' ';
+        appendNumber(p2.x(), decimalPoint, buffer);
+        buffer += ' ';
+        appendNumber(p2.y(), decimalPoint, buffer);
+        buffer += '\n';
+
+        if (buffer.size() >= BLOCK_SIZE) {
+            outfile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
     }
 
+    outfile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
     outfile.close();
 
     return segments;